@@ -12,4 +12,15 @@ const uint8_t raspberry_bitmap [] =
     0x00, 0x00, 0x01, 0x02, 0x02, 0x07, 0x08, 0x09, 0x09, 0x08, 0x07, 0x02, 0x02, 0x01, 0x00, 0x00
 };
 
-const bitmap raspberry = {(uint8_t *) raspberry_bitmap, raspberry_width, raspberry_height};
\ No newline at end of file
+const bitmap raspberry = {(uint8_t *) raspberry_bitmap, raspberry_width, raspberry_height};
+
+// Pixels covered by the raspberry, for drawing it over other graphics with blit_masked()
+const uint8_t raspberry_mask_bitmap [] = 
+{
+    // 'raspberry' mask, 16x20px
+    0x00, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xfc, 0xfc, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xfe, 0x00,
+    0x1c, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1c,
+    0x00, 0x00, 0x01, 0x03, 0x03, 0x07, 0x0f, 0x0f, 0x0f, 0x0f, 0x07, 0x03, 0x03, 0x01, 0x00, 0x00
+};
+
+const masked_bitmap raspberry_masked = {raspberry_bitmap, raspberry_mask_bitmap, raspberry_width, raspberry_height};
\ No newline at end of file
@@ -0,0 +1,28 @@
+/**
+ *  raspberry_packed.h
+ *  Generated by oled-pack.py from raspberry.h
+ */
+#include "pico/stdlib.h"
+#include "../../oled-packed.hpp"
+
+
+const uint8_t raspberry_packed_data [] =
+{
+    // 'raspberry_bitmap', 16x20px, 48 bytes packed to 48 (RAW)
+    0x00, 0x0e, 0x91, 0x61, 0x25, 0xe9, 0x32, 0x1c, 0x1c, 0x32, 0xe9, 0x25, 0x61, 0x91, 0x0e, 0x00,
+    0x1c, 0xe2, 0x13, 0x1e, 0x21, 0xe0, 0x91, 0x0f, 0x0f, 0x91, 0xe0, 0x21, 0x1e, 0x13, 0xe2, 0x1c,
+    0x00, 0x00, 0x01, 0x02, 0x02, 0x07, 0x08, 0x09, 0x09, 0x08, 0x07, 0x02, 0x02, 0x01, 0x00, 0x00,
+};
+
+const packed_bitmap raspberry_packed = {raspberry_packed_data, sizeof(raspberry_packed_data), 16, 20, OLED_PACK_RAW};
+
+
+const uint8_t raspberry_mask_packed_data [] =
+{
+    // 'raspberry_mask_bitmap', 16x20px, 48 bytes packed to 35 (RLE)
+    0x01, 0x00, 0xfe, 0x82, 0xff, 0x03, 0xfe, 0xfc, 0xfc, 0xfe, 0x82, 0xff, 0x02, 0xfe, 0x00, 0x1c,
+    0x8c, 0xff, 0x06, 0x1c, 0x00, 0x00, 0x01, 0x03, 0x03, 0x07, 0x82, 0x0f, 0x05, 0x07, 0x03, 0x03,
+    0x01, 0x00, 0x00,
+};
+
+const packed_bitmap raspberry_mask_packed = {raspberry_mask_packed_data, sizeof(raspberry_mask_packed_data), 16, 20, OLED_PACK_RLE};
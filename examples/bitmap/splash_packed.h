@@ -0,0 +1,36 @@
+/**
+ *  splash_packed.h
+ *  Generated by oled-pack.py from splash.h
+ */
+#include "pico/stdlib.h"
+#include "../../oled-packed.hpp"
+
+
+const uint8_t splash_packed_data [] =
+{
+    // 'splash_bitmap', 128x64px, 1024 bytes packed to 348 (LZ)
+    0x02, 0xff, 0x01, 0xfd, 0x7f, 0x05, 0x77, 0x05, 0x05, 0xfd, 0x01, 0xff, 0xff, 0x00, 0xff, 0x63,
+    0x00, 0x41, 0x70, 0x74, 0x00, 0x0d, 0x1c, 0x22, 0xc2, 0x4a, 0xd2, 0x64, 0x38, 0x38, 0x64, 0xd2,
+    0x4a, 0xc2, 0x22, 0x1c, 0x4c, 0x00, 0x01, 0xff, 0x00, 0x80, 0x0b, 0x00, 0x56, 0x00, 0x41, 0xfe,
+    0x09, 0x3c, 0x1c, 0x1e, 0x06, 0x06, 0x0e, 0xfc, 0xfc, 0xf8, 0x00, 0x41, 0xfe, 0x04, 0x00, 0xf8,
+    0xfc, 0xfc, 0x0e, 0x42, 0x06, 0x03, 0x0e, 0x1c, 0x1c, 0x18, 0x81, 0x3e, 0x00, 0x42, 0x06, 0x81,
+    0x36, 0x00, 0x58, 0x00, 0x0f, 0x38, 0xc4, 0x27, 0x3c, 0x42, 0xc1, 0x22, 0x1e, 0x1e, 0x22, 0xc1,
+    0x42, 0x3c, 0x27, 0xc4, 0x38, 0x4b, 0x00, 0x01, 0xff, 0x00, 0x80, 0x0b, 0x00, 0x56, 0x00, 0x41,
+    0xff, 0x43, 0x0c, 0x04, 0x0e, 0x07, 0x07, 0x03, 0x00, 0x41, 0x0f, 0x04, 0x00, 0x03, 0x07, 0x07,
+    0x0e, 0x42, 0x0c, 0x81, 0x74, 0x00, 0x80, 0x7d, 0x00, 0x42, 0x0c, 0x81, 0x74, 0x00, 0x59, 0x00,
+    0x0d, 0x01, 0x02, 0x04, 0x04, 0x0f, 0x11, 0x12, 0x12, 0x11, 0x0f, 0x04, 0x04, 0x02, 0x01, 0x4c,
+    0x00, 0x01, 0xff, 0x00, 0x80, 0x0b, 0x00, 0x55, 0x00, 0x01, 0x38, 0x7c, 0x41, 0x44, 0x0c, 0x7c,
+    0x38, 0x00, 0x00, 0x40, 0x41, 0x7f, 0x7f, 0x40, 0x40, 0x00, 0x38, 0x7c, 0x41, 0x54, 0x04, 0x5c,
+    0x18, 0x00, 0x38, 0x7c, 0x41, 0x44, 0x40, 0x7f, 0x5f, 0x00, 0x03, 0x06, 0x78, 0x80, 0x00, 0x80,
+    0xcb, 0x00, 0x80, 0xcb, 0x00, 0x80, 0xcb, 0x00, 0x80, 0xcb, 0x00, 0x80, 0xcb, 0x00, 0x80, 0xcb,
+    0x00, 0x80, 0xcb, 0x00, 0x41, 0x00, 0x01, 0xff, 0x00, 0x80, 0x0b, 0x00, 0x41, 0x00, 0x7f, 0x30,
+    0x53, 0x30, 0x00, 0x31, 0x41, 0x30, 0x00, 0x31, 0x41, 0x30, 0x00, 0x31, 0x41, 0x30, 0x00, 0x31,
+    0x41, 0x30, 0x00, 0x31, 0x41, 0x30, 0x00, 0x31, 0x41, 0x30, 0x00, 0x31, 0x41, 0x30, 0x01, 0x31,
+    0x30, 0x41, 0x00, 0x01, 0xff, 0x00, 0x80, 0x0b, 0x00, 0x41, 0x00, 0x04, 0x10, 0xa8, 0xa8, 0x40,
+    0x00, 0x81, 0x1c, 0x01, 0x18, 0xf8, 0x88, 0x88, 0x70, 0x00, 0xf8, 0x00, 0xa8, 0xa8, 0xf8, 0x00,
+    0xf8, 0x88, 0xf8, 0x00, 0xf8, 0xa8, 0xe8, 0x00, 0x00, 0x80, 0x60, 0x10, 0x00, 0x00, 0x81, 0x1c,
+    0x01, 0x81, 0x1c, 0x01, 0x8b, 0x25, 0x01, 0x02, 0xb8, 0xa8, 0xf8, 0x76, 0x00, 0x05, 0xff, 0x00,
+    0xff, 0xff, 0x80, 0xbf, 0x7f, 0xa0, 0x77, 0xa0, 0x02, 0xbf, 0x80, 0xff,
+};
+
+const packed_bitmap splash_packed = {splash_packed_data, sizeof(splash_packed_data), 128, 64, OLED_PACK_LZ};
@@ -10,6 +10,7 @@
 #include "bitmap/raspberry.h"
 #include "bitmap/thermometer_empty.h"
 #include "bitmap/thermometer_full.h"
+#include "bitmap/splash_packed.h"
 
 #define DISPLAY_I2C_ADDR _u(0x3C) //_u(0x3C)
 #define DISPLAY_WIDTH _u(128)
@@ -42,6 +43,12 @@ int main()
 
     analog_gauge gauge(&display);
 
+    // Start up screen, packed to a third of its size by oled-pack.py
+    display.fill(0);
+    display.draw_packed(splash_packed, 0, 0);
+    display.render();
+    sleep_ms(2000);
+
     display.fill(0);    // Clear display    
     display.set_cursor(0,0);             
 
@@ -0,0 +1,218 @@
+/**
+ *  Retron2000_packed.h
+ *  Generated by oled-pack.py from Retron2000.h
+ */
+#include "pico/stdlib.h"
+#include "../gfx_font.h"
+#include "../oled-packed.hpp"
+
+
+ const uint8_t Retron2000_packed_data[] =
+ {
+	// 'Retron2000', 3000 bytes of bitmap table packed to 1464 (LZ)
+	0x41, 0x00, 0x41, 0xff, 0x41, 0xcf, 0x41, 0x1f, 0x40, 0x00, 0x40, 0x1f, 0x41, 0x60, 0x40, 0xff,
+	0x40, 0x60, 0x40, 0xff, 0x41, 0x60, 0x41, 0x0e, 0x40, 0xff, 0x40, 0x0e, 0x40, 0xff, 0x41, 0x0e,
+	0x23, 0xe0, 0xf0, 0xf8, 0x1c, 0x1c, 0xff, 0xff, 0x1c, 0x1c, 0x78, 0x70, 0x60, 0xc1, 0xc3, 0xc7,
+	0x87, 0x06, 0xff, 0xff, 0x06, 0x8e, 0xfc, 0xf8, 0xf8, 0x00, 0x01, 0x01, 0x03, 0x03, 0x0f, 0x0f,
+	0x03, 0x03, 0x01, 0x01, 0x00, 0x17, 0x0e, 0x1f, 0x1b, 0x1f, 0x0e, 0x80, 0xc0, 0xe0, 0xf0, 0x3f,
+	0x3f, 0x1f, 0xf0, 0xf8, 0xfc, 0x0e, 0x0f, 0x07, 0x01, 0x71, 0xf0, 0x90, 0xf0, 0x70, 0x03, 0x78,
+	0xfc, 0xfe, 0xc7, 0x41, 0x87, 0x40, 0x07, 0x07, 0x1e, 0x1c, 0x18, 0x00, 0x3e, 0x7e, 0x7f, 0xe3,
+	0x41, 0xc1, 0x05, 0xe0, 0xf0, 0x7e, 0x3e, 0x0e, 0x0e, 0x41, 0x1f, 0x0d, 0xe0, 0xf0, 0xf8, 0x3c,
+	0x1e, 0x0f, 0x07, 0x0f, 0x0f, 0x1f, 0x78, 0x70, 0xf0, 0xc0, 0x40, 0x07, 0x0b, 0x0f, 0x3c, 0x38,
+	0xf8, 0xe0, 0xc0, 0xe0, 0xf0, 0x78, 0x3c, 0x1f, 0x0f, 0x08, 0x67, 0x77, 0x7f, 0x3c, 0x18, 0x18,
+	0x3e, 0x7f, 0x77, 0x43, 0x30, 0x40, 0xff, 0x43, 0x30, 0x43, 0x00, 0x40, 0x07, 0x43, 0x00, 0x04,
+	0x30, 0x38, 0x3f, 0x1f, 0x0f, 0x47, 0x03, 0x41, 0x03, 0x43, 0x00, 0x8a, 0x4b, 0x00, 0x00, 0x01,
+	0x42, 0x00, 0x17, 0xf8, 0xfc, 0xfe, 0x07, 0x07, 0x87, 0xc7, 0xe7, 0xf7, 0xfe, 0xfc, 0xf8, 0x3f,
+	0x7f, 0x7f, 0xee, 0xcf, 0xc7, 0xc1, 0xc1, 0xe0, 0x7f, 0x7f, 0x3f, 0x06, 0x18, 0x1c, 0x1e, 0x07,
+	0x07, 0xff, 0xff, 0x43, 0x00, 0x43, 0xc0, 0x40, 0xff, 0x43, 0xc0, 0x02, 0x18, 0x1c, 0x1e, 0x43,
+	0x87, 0x07, 0xc7, 0xfe, 0xfc, 0x78, 0xfe, 0xfe, 0xff, 0xc3, 0x43, 0xc1, 0x02, 0xf1, 0xf0, 0xf0,
+	0x81, 0xdc, 0x00, 0x41, 0x87, 0x80, 0xf2, 0x00, 0x04, 0x30, 0x70, 0x70, 0xe0, 0xc0, 0x41, 0xc1,
+	0x03, 0xe3, 0x7f, 0x7e, 0x3e, 0x08, 0x80, 0xc0, 0xc0, 0xf0, 0x78, 0x38, 0x1e, 0x8f, 0x87, 0x41,
+	0x00, 0x41, 0x0f, 0x42, 0x0e, 0x40, 0xff, 0x41, 0x0e, 0x41, 0xff, 0x44, 0x87, 0x41, 0x07, 0x03,
+	0x31, 0x71, 0x71, 0xe1, 0x42, 0xc1, 0x80, 0x11, 0x01, 0x02, 0xf8, 0xfc, 0xfe, 0x44, 0x87, 0x06,
+	0x1e, 0x1c, 0x18, 0x3f, 0x7f, 0x7f, 0xe1, 0x42, 0xc1, 0x80, 0x11, 0x01, 0x41, 0x1f, 0x42, 0x07,
+	0x04, 0x87, 0xc7, 0xff, 0xff, 0x7f, 0x43, 0x00, 0x06, 0xfe, 0xff, 0x07, 0x03, 0x01, 0x00, 0x00,
+	0x80, 0x5f, 0x00, 0x42, 0x87, 0x80, 0xf2, 0x00, 0x80, 0x6c, 0x00, 0x42, 0xc1, 0x80, 0x11, 0x01,
+	0x80, 0x5f, 0x00, 0x43, 0x87, 0x06, 0xfe, 0xfc, 0xf8, 0x30, 0x70, 0x71, 0xe1, 0x42, 0xc1, 0x03,
+	0xe1, 0x7f, 0x7f, 0x3f, 0x41, 0x03, 0x41, 0x06, 0x40, 0x00, 0x41, 0x03, 0x04, 0x60, 0x70, 0x7e,
+	0x3e, 0x1e, 0x83, 0x16, 0x01, 0x0a, 0x0f, 0x07, 0x01, 0x03, 0x07, 0x0e, 0x1e, 0x3c, 0x70, 0xf0,
+	0xe0, 0x4a, 0x73, 0x40, 0x07, 0x04, 0x0f, 0x3c, 0x38, 0x78, 0xe0, 0x41, 0xc0, 0x80, 0x93, 0x00,
+	0x03, 0x1e, 0x0f, 0x07, 0x03, 0x81, 0xdc, 0x00, 0x80, 0xc6, 0x00, 0x02, 0xfe, 0xfc, 0x78, 0x43,
+	0x00, 0x01, 0xce, 0xcf, 0x81, 0x5b, 0x01, 0x81, 0xc3, 0x00, 0x11, 0xc7, 0xe7, 0x67, 0x67, 0xe7,
+	0xe7, 0xc7, 0x00, 0x00, 0x3f, 0x7f, 0x7f, 0xc0, 0xc0, 0xc7, 0xcf, 0xce, 0xce, 0x41, 0xcf, 0x01,
+	0x7e, 0x3e, 0x02, 0xf8, 0xfc, 0xfe, 0x44, 0x87, 0x02, 0xfe, 0xfc, 0xf8, 0x41, 0xff, 0x44, 0x01,
+	0x41, 0xff, 0x41, 0xff, 0x43, 0x87, 0x80, 0xf2, 0x00, 0x41, 0xff, 0x43, 0xc1, 0x80, 0x11, 0x01,
+	0x81, 0xc3, 0x00, 0x42, 0x07, 0x82, 0x40, 0x01, 0x00, 0xe0, 0x42, 0xc0, 0x03, 0xe0, 0x70, 0x70,
+	0x30, 0x41, 0xff, 0x44, 0x07, 0x02, 0xfe, 0xfc, 0xf8, 0x41, 0xff, 0x43, 0xc0, 0x80, 0xd7, 0x00,
+	0x02, 0xf8, 0xfc, 0xfe, 0x44, 0x87, 0x41, 0x07, 0x80, 0x43, 0x01, 0x43, 0xc1, 0x41, 0xc0, 0x02,
+	0xf8, 0xfc, 0xfe, 0x44, 0x87, 0x41, 0x07, 0x41, 0xff, 0x44, 0x01, 0x41, 0x00, 0x81, 0xc3, 0x00,
+	0x40, 0x07, 0x40, 0x87, 0x06, 0x9e, 0x9c, 0x98, 0x3f, 0x7f, 0x7f, 0xe0, 0x41, 0xc0, 0x00, 0xc1,
+	0x80, 0x80, 0x01, 0x41, 0xff, 0x44, 0x80, 0x44, 0xff, 0x44, 0x01, 0x41, 0xff, 0x43, 0x07, 0x40,
+	0xff, 0x43, 0x07, 0x43, 0xc0, 0x40, 0xff, 0x43, 0xc0, 0x41, 0x00, 0x44, 0x07, 0x41, 0xff, 0x81,
+	0x09, 0x01, 0x41, 0xc0, 0x80, 0xd7, 0x00, 0x41, 0xff, 0x40, 0xc0, 0x04, 0xe0, 0x78, 0x38, 0x3c,
+	0x0f, 0x80, 0xdf, 0x00, 0x09, 0xff, 0x03, 0x07, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xe0, 0xc0, 0x41,
+	0xff, 0x47, 0x00, 0x41, 0xff, 0x47, 0xc0, 0x41, 0xff, 0x05, 0x3c, 0x38, 0x78, 0x78, 0x38, 0x3c,
+	0x44, 0xff, 0x44, 0x00, 0x41, 0xff, 0x41, 0xff, 0x80, 0xa7, 0x01, 0x40, 0xc0, 0x44, 0xff, 0x41,
+	0x00, 0x40, 0x01, 0x00, 0x03, 0x41, 0xff, 0x81, 0xc3, 0x00, 0x42, 0x07, 0x82, 0xcc, 0x00, 0x00,
+	0xe0, 0x42, 0xc0, 0x80, 0xd7, 0x00, 0x41, 0xff, 0x43, 0x87, 0x80, 0xf2, 0x00, 0x41, 0xff, 0x45,
+	0x01, 0x40, 0x00, 0x81, 0xc3, 0x00, 0x42, 0x07, 0x82, 0xcc, 0x00, 0x08, 0xe0, 0xc0, 0xce, 0xde,
+	0x7c, 0x78, 0xff, 0xef, 0xcf, 0x41, 0xff, 0x43, 0x87, 0x80, 0xf2, 0x00, 0x41, 0xff, 0x08, 0x03,
+	0x07, 0x0f, 0x1f, 0x3d, 0x79, 0xf1, 0xe0, 0xc0, 0x80, 0x5f, 0x00, 0x43, 0x87, 0x02, 0x1e, 0x1c,
+	0x18, 0x80, 0x79, 0x01, 0x42, 0xc1, 0x80, 0x11, 0x01, 0x43, 0x07, 0x40, 0xff, 0x43, 0x07, 0x43,
+	0x00, 0x40, 0xff, 0x43, 0x00, 0x41, 0xff, 0x44, 0x00, 0x41, 0xff, 0x80, 0x48, 0x02, 0x42, 0xc0,
+	0x80, 0xd7, 0x00, 0x17, 0x7f, 0xff, 0xff, 0xc0, 0x80, 0x00, 0x00, 0x80, 0xc0, 0xff, 0xff, 0x7f,
+	0x00, 0x00, 0x01, 0x0f, 0x1f, 0xfc, 0xfc, 0x1f, 0x0f, 0x01, 0x00, 0x00, 0x41, 0xff, 0x44, 0x00,
+	0x44, 0xff, 0x05, 0x78, 0x3c, 0x1e, 0x1e, 0x3c, 0x78, 0x41, 0xff, 0x40, 0x07, 0x01, 0x0f, 0xfc,
+	0x42, 0xf8, 0x07, 0xfc, 0x0f, 0x07, 0x07, 0xfe, 0xfe, 0xff, 0x03, 0x42, 0x01, 0x03, 0x03, 0xff,
+	0xfe, 0xfe, 0x05, 0x1f, 0x3f, 0x3f, 0xf0, 0xe0, 0xc0, 0x82, 0x4c, 0x00, 0x42, 0x00, 0x03, 0x01,
+	0xff, 0xff, 0x01, 0x42, 0x00, 0x43, 0x07, 0x80, 0xc8, 0x00, 0x82, 0x4f, 0x00, 0x00, 0xce, 0x80,
+	0xd3, 0x00, 0x42, 0xc0, 0x41, 0xff, 0x42, 0x07, 0x41, 0xff, 0x42, 0xc0, 0x82, 0x63, 0x03, 0x00,
+	0x80, 0x47, 0x00, 0x40, 0x01, 0x05, 0x07, 0x0f, 0x0e, 0xfc, 0xf8, 0xf0, 0x43, 0x07, 0x40, 0xff,
+	0x43, 0xc0, 0x40, 0xff, 0x05, 0x60, 0x70, 0x78, 0x3c, 0x1e, 0x0f, 0x80, 0x88, 0x02, 0x01, 0x70,
+	0x60, 0x4a, 0x03, 0x40, 0x07, 0x02, 0x0f, 0x1c, 0x18, 0x02, 0x80, 0xc0, 0xe0, 0x43, 0x73, 0x07,
+	0x77, 0xfe, 0xfe, 0xfc, 0x01, 0x03, 0x03, 0x07, 0x43, 0x06, 0x41, 0x07, 0x41, 0xff, 0x43, 0x60,
+	0x03, 0xe0, 0xc0, 0xc0, 0x80, 0x41, 0xff, 0x80, 0x86, 0x00, 0x00, 0xc0, 0x80, 0xd7, 0x00, 0x03,
+	0xfc, 0xfe, 0xfe, 0x07, 0x42, 0x03, 0x03, 0x07, 0x8e, 0x8e, 0x8c, 0x80, 0xc4, 0x03, 0x42, 0x06,
+	0x03, 0x07, 0x03, 0x03, 0x01, 0x08, 0x80, 0xc0, 0xc0, 0xe0, 0x60, 0x60, 0xe0, 0xc0, 0xc0, 0x41,
+	0xff, 0x80, 0x48, 0x02, 0x40, 0xc0, 0x40, 0xc1, 0x00, 0xc3, 0x41, 0xff, 0x03, 0xfc, 0xfe, 0xfe,
+	0x77, 0x42, 0x73, 0x03, 0x77, 0x7e, 0x7e, 0x7c, 0x80, 0xc4, 0x03, 0x46, 0x06, 0x02, 0xf8, 0xfc,
+	0xfe, 0x41, 0x87, 0x02, 0x8f, 0x9e, 0x9c, 0x41, 0xff, 0x44, 0x01, 0x80, 0xe0, 0x03, 0x40, 0x03,
+	0x40, 0x83, 0x00, 0xc3, 0x41, 0xff, 0x0b, 0x61, 0x63, 0x63, 0x67, 0x66, 0x66, 0x67, 0x63, 0x73,
+	0x7f, 0x3f, 0x1f, 0x41, 0xff, 0x84, 0xf7, 0x03, 0x00, 0x80, 0x41, 0xff, 0x80, 0x41, 0x00, 0x40,
+	0x00, 0x41, 0xff, 0x41, 0xe7, 0x41, 0xff, 0x47, 0x00, 0x41, 0xe7, 0x41, 0xc0, 0x00, 0x80, 0x42,
+	0x00, 0x00, 0x80, 0x41, 0xff, 0x81, 0x39, 0x00, 0x42, 0x03, 0x40, 0x01, 0x00, 0x00, 0x41, 0xff,
+	0x80, 0x29, 0x03, 0x40, 0xe0, 0x41, 0xff, 0x05, 0x0e, 0x1f, 0x3f, 0x71, 0xf1, 0xe0, 0x41, 0xff,
+	0x42, 0x00, 0x80, 0x48, 0x02, 0x41, 0xc0, 0x41, 0xff, 0x08, 0x07, 0x0f, 0x7e, 0x7e, 0x0f, 0x07,
+	0xfe, 0xfe, 0xfc, 0x41, 0x07, 0x44, 0x00, 0x41, 0x07, 0x41, 0xff, 0x04, 0x1e, 0x0e, 0x0f, 0x03,
+	0x03, 0x80, 0x8f, 0x04, 0x41, 0x07, 0x44, 0x00, 0x41, 0x07, 0x80, 0xe0, 0x03, 0x42, 0x03, 0x80,
+	0x8f, 0x04, 0x80, 0xc4, 0x03, 0x42, 0x06, 0x80, 0xf1, 0x03, 0x41, 0xff, 0x81, 0x9c, 0x04, 0x80,
+	0x8f, 0x04, 0x41, 0x7f, 0x43, 0x06, 0x80, 0xf1, 0x03, 0x80, 0xe0, 0x03, 0x40, 0x03, 0x40, 0x83,
+	0x00, 0xc3, 0x41, 0xff, 0x80, 0xc4, 0x03, 0x40, 0x06, 0x02, 0x07, 0x03, 0x03, 0x41, 0x7f, 0x41,
+	0xff, 0x81, 0x9c, 0x04, 0x03, 0x07, 0x0e, 0x0e, 0x0c, 0x41, 0x07, 0x47, 0x00, 0x03, 0x0c, 0x1e,
+	0x3e, 0x77, 0x43, 0x73, 0x02, 0xe3, 0xc3, 0x83, 0x46, 0x06, 0x80, 0xf1, 0x03, 0x41, 0xff, 0x44,
+	0x60, 0x80, 0x48, 0x02, 0x40, 0xc0, 0x02, 0xf0, 0x7e, 0x7e, 0x41, 0xff, 0x41, 0x00, 0x40, 0x80,
+	0x00, 0xc0, 0x41, 0xff, 0x80, 0xc4, 0x03, 0x40, 0x06, 0x02, 0x07, 0x03, 0x03, 0x41, 0x07, 0x40,
+	0x7f, 0x01, 0xff, 0xc0, 0x42, 0x80, 0x03, 0xc0, 0xff, 0x7f, 0x7f, 0x41, 0x00, 0x40, 0x03, 0x40,
+	0x07, 0x40, 0x03, 0x41, 0x00, 0x41, 0xff, 0x05, 0x00, 0x80, 0xf0, 0xf0, 0x80, 0x00, 0x41, 0xff,
+	0x80, 0xc4, 0x03, 0x03, 0x07, 0x03, 0x03, 0x07, 0x80, 0xf1, 0x03, 0x0d, 0x03, 0x07, 0x8f, 0xde,
+	0xfc, 0xf8, 0xf8, 0xfc, 0xde, 0x8f, 0x07, 0x03, 0x06, 0x07, 0x81, 0x5b, 0x01, 0x04, 0x01, 0x03,
+	0x07, 0x07, 0x06, 0x40, 0x7f, 0x01, 0xff, 0xc0, 0x43, 0x80, 0x41, 0xff, 0x41, 0x00, 0x43, 0x61,
+	0x03, 0x71, 0x7f, 0x3f, 0x1f, 0x40, 0x03, 0x07, 0x83, 0xc3, 0xe3, 0xf3, 0x7b, 0x3f, 0x1f, 0x0f,
+	0x80, 0x56, 0x05, 0x41, 0x07, 0x45, 0x06, 0x40, 0x80, 0x0b, 0xc0, 0xfc, 0x7e, 0x0f, 0x07, 0x01,
+	0x01, 0x03, 0x7e, 0x7e, 0xf0, 0xc0, 0x44, 0xff, 0x41, 0x0f, 0x40, 0x07, 0x03, 0x0f, 0xfc, 0xf8,
+	0xc0, 0x80, 0x4b, 0x00, 0x03, 0x7e, 0x3f, 0x03, 0x01, 0x02, 0x0c, 0x0e, 0x0f, 0x80, 0x44, 0x05,
+	0x06, 0x0f, 0x0e, 0x0c, 0x0e, 0x0f, 0x07, 0x03,
+ };
+
+ const uint16_t Retron2000_packed_offsets[] =
+ {
+	    0,     2,     6,    12,    32,    69,    94,   121,   123,   138,   153,   163,
+	  175,   181,   183,   185,   194,   219,   235,   256,   277,   297,   313,   332,
+	  352,   368,   388,   392,   402,   417,   419,   437,   455,   482,   498,   512,
+	  529,   544,   559,   573,   595,   605,   617,   631,   655,   663,   678,   695,
+	  710,   723,   741,   760,   777,   789,   803,   828,   843,   866,   885,   900,
+	  908,   924,   932,   945,   947,   953,   972,   991,  1013,  1036,  1053,  1067,
+	 1091,  1107,  1111,  1134,  1150,  1159,  1177,  1194,  1210,  1225,  1247,  1261,
+	 1277,  1290,  1311,  1333,  1355,  1379,  1397,  1415,  1430,  1434,  1449,
+ };
+
+ const gfx_char Retron2000_packed_chars[] =
+ {
+	{ 997, 3, 1, 6, -1, 25},		//  32: ' '
+	{ 676, 3, 16, 4, 1, 6},		//  33: '!'
+	{ 944, 7, 5, 9, 1, 6},		//  34: '"'
+	{  90, 12, 16, 13, 1, 6},		//  35: '#'
+	{   0, 12, 20, 13, 1, 4},		//  36: '$'
+	{ 102, 12, 16, 13, 1, 6},		//  37: '%'
+	{  41, 13, 16, 15, 1, 6},		//  38: '&'
+	{ 956, 3, 5, 4, 1, 6},		//  39: '''
+	{ 634, 7, 16, 9, 1, 6},		//  40: '('
+	{ 627, 7, 16, 9, 1, 6},		//  41: ')'
+	{ 930, 9, 7, 11, 1, 6},		//  42: '*'
+	{ 747, 12, 11, 13, 1, 9},		//  43: '+'
+	{ 939, 5, 6, 4, -1, 20},		//  44: ','
+	{ 985, 9, 2, 11, 1, 13},		//  45: '-'
+	{ 994, 3, 2, 4, 1, 20},		//  46: '.'
+	{ 210, 12, 16, 13, 1, 6},		//  47: '/'
+	{ 126, 12, 16, 13, 1, 6},		//  48: '0'
+	{ 234, 12, 16, 13, 1, 6},		//  49: '1'
+	{ 246, 12, 16, 13, 1, 6},		//  50: '2'
+	{ 258, 12, 16, 13, 1, 6},		//  51: '3'
+	{ 270, 12, 16, 13, 1, 6},		//  52: '4'
+	{ 282, 12, 16, 13, 1, 6},		//  53: '5'
+	{  54, 12, 16, 13, 1, 6},		//  54: '6'
+	{ 306, 12, 16, 13, 1, 6},		//  55: '7'
+	{ 318, 12, 16, 13, 1, 6},		//  56: '8'
+	{ 330, 12, 16, 13, 1, 6},		//  57: '9'
+	{ 903, 3, 11, 4, 1, 11},		//  58: ':'
+	{ 730, 5, 15, 4, -1, 11},		//  59: ';'
+	{ 618, 9, 16, 11, 1, 6},		//  60: '<'
+	{ 918, 12, 7, 13, 1, 11},		//  61: '='
+	{ 600, 9, 16, 11, 1, 6},		//  62: '>'
+	{ 378, 12, 16, 13, 1, 6},		//  63: '?'
+	{  27, 14, 16, 16, 1, 6},		//  64: '@'
+	{ 390, 12, 16, 13, 1, 6},		//  65: 'A'
+	{ 402, 12, 16, 13, 1, 6},		//  66: 'B'
+	{ 414, 12, 16, 13, 1, 6},		//  67: 'C'
+	{ 426, 12, 16, 13, 1, 6},		//  68: 'D'
+	{ 438, 12, 16, 13, 1, 6},		//  69: 'E'
+	{ 450, 12, 16, 13, 1, 6},		//  70: 'F'
+	{ 462, 12, 16, 13, 1, 6},		//  71: 'G'
+	{ 474, 12, 16, 13, 1, 6},		//  72: 'H'
+	{ 486, 12, 16, 13, 1, 6},		//  73: 'I'
+	{ 498, 12, 16, 13, 1, 6},		//  74: 'J'
+	{ 510, 12, 16, 13, 1, 6},		//  75: 'K'
+	{ 522, 12, 16, 13, 1, 6},		//  76: 'L'
+	{ 534, 12, 16, 13, 1, 6},		//  77: 'M'
+	{ 546, 12, 16, 13, 1, 6},		//  78: 'N'
+	{ 162, 12, 16, 13, 1, 6},		//  79: 'O'
+	{ 366, 12, 16, 13, 1, 6},		//  80: 'P'
+	{ 342, 12, 16, 13, 1, 6},		//  81: 'Q'
+	{ 294, 12, 16, 13, 1, 6},		//  82: 'R'
+	{ 198, 12, 16, 13, 1, 6},		//  83: 'S'
+	{ 186, 12, 16, 13, 1, 6},		//  84: 'T'
+	{ 174, 12, 16, 13, 1, 6},		//  85: 'U'
+	{ 150, 12, 16, 13, 1, 6},		//  86: 'V'
+	{ 114, 12, 16, 13, 1, 6},		//  87: 'W'
+	{  78, 12, 16, 13, 1, 6},		//  88: 'X'
+	{ 558, 12, 16, 13, 1, 6},		//  89: 'Y'
+	{ 570, 12, 16, 13, 1, 6},		//  90: 'Z'
+	{ 641, 7, 16, 9, 1, 6},		//  91: '['
+	{  66, 12, 16, 13, 1, 6},		//  92: '\'
+	{ 648, 7, 16, 9, 1, 6},		//  93: ']'
+	{ 906, 12, 7, 13, 1, 6},		//  94: '^'
+	{ 973, 12, 2, 13, 1, 20},		//  95: '_'
+	{ 951, 5, 5, 7, 1, 6},		//  96: '`'
+	{ 843, 12, 11, 13, 1, 11},		//  97: 'a'
+	{ 138, 12, 16, 13, 1, 6},		//  98: 'b'
+	{ 783, 12, 11, 13, 1, 11},		//  99: 'c'
+	{ 222, 12, 16, 13, 1, 6},		// 100: 'd'
+	{ 735, 12, 11, 13, 1, 11},		// 101: 'e'
+	{ 591, 9, 16, 11, 1, 6},		// 102: 'f'
+	{ 682, 12, 15, 13, 1, 11},		// 103: 'g'
+	{ 354, 12, 16, 13, 1, 6},		// 104: 'h'
+	{ 679, 3, 16, 4, 1, 6},		// 105: 'i'
+	{  15, 12, 18, 13, 1, 6},		// 106: 'j'
+	{ 582, 9, 16, 11, 1, 6},		// 107: 'k'
+	{ 655, 7, 16, 9, 1, 6},		// 108: 'l'
+	{ 867, 12, 11, 13, 1, 11},		// 109: 'm'
+	{ 879, 12, 11, 13, 1, 11},		// 110: 'n'
+	{ 891, 12, 11, 13, 1, 11},		// 111: 'o'
+	{ 694, 12, 15, 13, 1, 11},		// 112: 'p'
+	{ 706, 12, 15, 13, 1, 11},		// 113: 'q'
+	{ 759, 12, 11, 13, 1, 11},		// 114: 'r'
+	{ 771, 12, 11, 13, 1, 11},		// 115: 's'
+	{ 609, 9, 16, 11, 1, 6},		// 116: 't'
+	{ 795, 12, 11, 13, 1, 11},		// 117: 'u'
+	{ 807, 12, 11, 13, 1, 11},		// 118: 'v'
+	{ 819, 12, 11, 13, 1, 11},		// 119: 'w'
+	{ 831, 12, 11, 13, 1, 11},		// 120: 'x'
+	{ 718, 12, 15, 13, 1, 11},		// 121: 'y'
+	{ 855, 12, 11, 13, 1, 11},		// 122: 'z'
+	{ 662, 7, 16, 9, 1, 6},		// 123: '{'
+	{  12, 3, 20, 4, 1, 6},		// 124: '|'
+	{ 669, 7, 16, 9, 1, 6},		// 125: '}'
+	{ 959, 14, 4, 16, 1, 9},		// 126: '~'
+ };
+
+ const gfx_font Retron2000_packed = {NULL, (gfx_char *)Retron2000_packed_chars, 32, 126, 24, 1000, Retron2000_packed_data, Retron2000_packed_offsets, OLED_PACK_LZ};
@@ -0,0 +1,199 @@
+#include "gfx-profile.hpp"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+#if PICO_ON_DEVICE
+    #include "hardware/structs/systick.h"
+    #define GFX_PROFILE_TICK_MASK 0x00FFFFFF    // SysTick is a 24 bit counter
+    #define GFX_PROFILE_UNIT "cycles"
+#else
+    #include <chrono>
+    #define GFX_PROFILE_TICK_MASK 0xFFFFFFFF
+    #define GFX_PROFILE_UNIT "ns"
+#endif
+
+
+static gfx_profile_entry entries[GFX_PROF_COUNT];
+
+static const char *names[GFX_PROF_COUNT] =
+{
+    "render",
+    "render_async",
+    "render_pages",
+    "render_async_and_clear",
+    "fill",
+    "blit_screen",
+    "blit_masked",
+    "draw_sprite",
+    "draw_packed",
+    "draw_char",
+    "print",
+    "print_num",
+    "draw_pixel",
+    "draw_pixel_alternating",
+    "draw_line",
+    "draw_line_dotted",
+    "draw_fast_hline",
+    "draw_fast_vline",
+    "draw_line_polar",
+    "draw_vbar",
+    "draw_hbar",
+    "draw_bmp_vbar",
+    "fill_rect",
+    "draw_box",
+    "get_str_dimensions",
+    "draw_boxed_text",
+    "analog_gauge::draw",
+    "analog_gauge::draw_maj_div_line",
+};
+
+
+#ifdef GFX_PROFILE
+    // Start the tick counter and clear the counts before main() runs
+    static struct gfx_profile_init
+    {
+        gfx_profile_init() { gfx_profile_reset(); }
+    } profile_init;
+#endif
+
+
+/// @brief Current value of the profiling tick counter, which counts up and wraps
+uint32_t gfx_profile_ticks()
+{
+#if PICO_ON_DEVICE
+    // SysTick counts down
+    return ~systick_hw->cvr & GFX_PROFILE_TICK_MASK;
+#else
+    return (uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+/// @brief Ticks since an earlier call to gfx_profile_ticks(), allowing for the counter wrapping once
+uint32_t gfx_profile_elapsed(uint32_t start_ticks)
+{
+    return (gfx_profile_ticks() - start_ticks) & GFX_PROFILE_TICK_MASK;
+}
+
+
+/// @brief Add one call to a primitive's counts
+/// @param id primitive that was called
+/// @param ticks time the call took
+void gfx_profile_record(gfx_profile_id id, uint32_t ticks)
+{
+    gfx_profile_entry *entry = &entries[id];
+
+    entry->calls++;
+    entry->total_ticks += ticks;
+
+    if (ticks < entry->min_ticks)
+        entry->min_ticks = ticks;
+
+    if (ticks > entry->max_ticks)
+        entry->max_ticks = ticks;
+
+    // Bucket by the position of the highest set bit
+    uint8_t bucket = 0;
+
+    while ((ticks >>= 1) && bucket < GFX_PROFILE_BUCKETS - 1)
+        bucket++;
+
+    entry->histogram[bucket]++;
+}
+
+
+/// @brief Counts recorded for a primitive since the last reset
+const gfx_profile_entry *gfx_profile_get(gfx_profile_id id)
+{
+    return &entries[id];
+}
+
+
+/// @brief Name of a primitive, as printed by gfx_profile_dump()
+const char *gfx_profile_name(gfx_profile_id id)
+{
+    return names[id];
+}
+
+
+/// @brief Clear all counts
+void gfx_profile_reset()
+{
+#if PICO_ON_DEVICE
+    // Count processor clock cycles over the full 24 bit range
+    systick_hw->csr = 0;
+    systick_hw->rvr = GFX_PROFILE_TICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;  // enable, processor clock
+#endif
+
+    memset(entries, 0, sizeof(entries));
+
+    for (uint8_t i = 0; i < GFX_PROF_COUNT; i++)
+        entries[i].min_ticks = UINT32_MAX;
+}
+
+
+/// @brief Print a table of every primitive that was called, most total time first,
+///        followed by the non-empty histogram buckets of each one
+void gfx_profile_dump()
+{
+#ifndef GFX_PROFILE
+    printf("gfx profile: build with GFX_PROFILE defined to record drawing times\n");
+#else
+    uint8_t order[GFX_PROF_COUNT];
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < GFX_PROF_COUNT; i++)
+    {
+        if (entries[i].calls > 0)
+            order[count++] = i;
+    }
+
+    // Insertion sort, by total time descending
+    for (uint8_t i = 1; i < count; i++)
+    {
+        uint8_t id = order[i];
+        uint8_t j = i;
+
+        while (j > 0 && entries[order[j - 1]].total_ticks < entries[id].total_ticks)
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+
+        order[j] = id;
+    }
+
+    printf("%-32s %10s %14s %10s %10s %10s  (%s)\n", "primitive", "calls", "total", "avg", "min", "max", GFX_PROFILE_UNIT);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const gfx_profile_entry *entry = &entries[order[i]];
+
+        printf("%-32s %10lu %14llu %10lu %10lu %10lu\n", names[order[i]],
+            (unsigned long) entry->calls,
+            (unsigned long long) entry->total_ticks,
+            (unsigned long) (entry->total_ticks / entry->calls),
+            (unsigned long) entry->min_ticks,
+            (unsigned long) entry->max_ticks);
+    }
+
+    printf("\nhistograms, calls taking at least 2^n %s:\n", GFX_PROFILE_UNIT);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const gfx_profile_entry *entry = &entries[order[i]];
+        printf("%-32s", names[order[i]]);
+
+        for (uint8_t bucket = 0; bucket < GFX_PROFILE_BUCKETS; bucket++)
+        {
+            if (entry->histogram[bucket] > 0)
+                printf(" %u:%lu", bucket, (unsigned long) entry->histogram[bucket]);
+        }
+
+        printf("\n");
+    }
+#endif
+}
@@ -0,0 +1,88 @@
+/**
+ *  gfx-profile.hpp
+ *  Call counts and time histograms for each drawing primitive, compiled in when GFX_PROFILE is defined.
+ *  On the RP2040 times are in CPU cycles from SysTick, which profiling takes over, on the host in nanoseconds.
+ *  Times are inclusive, e.g. print() includes the draw_char() calls it makes.
+ */
+#ifndef _GFX_PROFILE_H_
+#define _GFX_PROFILE_H_
+
+#include <stdint.h>
+
+//#define GFX_PROFILE       // or add target_compile_definitions(<target> PRIVATE GFX_PROFILE)
+
+#define GFX_PROFILE_BUCKETS 20      // Histogram bucket n counts calls taking 2^n to 2^(n+1)-1 ticks, the last one everything longer
+
+
+typedef enum
+{
+    GFX_PROF_RENDER,
+    GFX_PROF_RENDER_ASYNC,
+    GFX_PROF_RENDER_PAGES,
+    GFX_PROF_RENDER_ASYNC_AND_CLEAR,
+    GFX_PROF_FILL,
+    GFX_PROF_BLIT_SCREEN,
+    GFX_PROF_BLIT_MASKED,
+    GFX_PROF_DRAW_SPRITE,
+    GFX_PROF_DRAW_PACKED,
+    GFX_PROF_DRAW_CHAR,
+    GFX_PROF_PRINT,
+    GFX_PROF_PRINT_NUM,
+    GFX_PROF_DRAW_PIXEL,
+    GFX_PROF_DRAW_PIXEL_ALTERNATING,
+    GFX_PROF_DRAW_LINE,
+    GFX_PROF_DRAW_LINE_DOTTED,
+    GFX_PROF_DRAW_FAST_HLINE,
+    GFX_PROF_DRAW_FAST_VLINE,
+    GFX_PROF_DRAW_LINE_POLAR,
+    GFX_PROF_DRAW_VBAR,
+    GFX_PROF_DRAW_HBAR,
+    GFX_PROF_DRAW_BMP_VBAR,
+    GFX_PROF_FILL_RECT,
+    GFX_PROF_DRAW_BOX,
+    GFX_PROF_GET_STR_DIMENSIONS,
+    GFX_PROF_DRAW_BOXED_TEXT,
+    GFX_PROF_GAUGE_DRAW,
+    GFX_PROF_GAUGE_DRAW_MAJ_DIV_LINE,
+    GFX_PROF_COUNT
+} gfx_profile_id;
+
+
+struct gfx_profile_entry
+{
+    uint32_t calls;
+    uint64_t total_ticks;
+    uint32_t min_ticks;
+    uint32_t max_ticks;
+    uint32_t histogram[GFX_PROFILE_BUCKETS];
+};
+
+
+uint32_t gfx_profile_ticks();
+uint32_t gfx_profile_elapsed(uint32_t start_ticks);
+void gfx_profile_record(gfx_profile_id id, uint32_t ticks);
+const gfx_profile_entry *gfx_profile_get(gfx_profile_id id);
+const char *gfx_profile_name(gfx_profile_id id);
+void gfx_profile_reset();
+void gfx_profile_dump();
+
+
+#ifdef GFX_PROFILE
+    /// @brief Records the time from construction to destruction against a primitive
+    class gfx_profile_scope
+    {
+        private:
+            gfx_profile_id id;
+            uint32_t start;
+
+        public:
+            gfx_profile_scope(gfx_profile_id primitive) : id(primitive), start(gfx_profile_ticks()) {}
+            ~gfx_profile_scope() { gfx_profile_record(id, gfx_profile_elapsed(start)); }
+    };
+
+    #define GFX_PROFILE_SCOPE(id) gfx_profile_scope gfx_profile_scope_(id)
+#else
+    #define GFX_PROFILE_SCOPE(id)
+#endif
+
+#endif
@@ -26,6 +26,11 @@
         uint16_t last; 
         uint8_t line_height;   
         uint16_t src_width;     // Bitmap table image total width
+
+        // Packed fonts made by oled-pack.py have no bitmap table, each character is a packed bitmap instead
+        const uint8_t *packed;          // Packed data of every character, see oled-packed.hpp
+        const uint16_t *packed_offsets; // Where each character starts in the packed data, in character array order
+        uint8_t packed_format;          // OLED_pack_format
     } gfx_font;
     
 #endif
\ No newline at end of file
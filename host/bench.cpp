@@ -0,0 +1,383 @@
+/**
+ *  bench.cpp
+ *  Times the drawing primitives on the host and prints one CSV line per case:
+ *  name, iterations, ns per call, pixels lit per call and pixels per second.
+ *  Pixels are counted by drawing the case once on a blank simulated display. A second table gives the size
+ *  of each packed asset before and after packing, and how fast it unpacks. Only timings are taken here,
+ *  oled_test checks that the primitives draw the right pixels.
+ *
+ *  Usage: oled_bench [minimum milliseconds per case] [case name filter]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "pico/stdlib.h"
+
+#include "../pico-oled.hpp"
+#include "../oled-display-list.hpp"
+#include "../oled-sprite.hpp"
+#include "../oled-raster.hpp"
+#include "../oled-packed.hpp"
+#include "../gfx_font.h"
+#include "../font/press_start_2p.h"
+#include "../font/too_simple.h"
+#include "../font/Retron2000.h"
+#include "../font/Retron2000_packed.h"
+#include "oled-sim.hpp"
+#include "legacy.hpp"
+
+#include "bitmap/raspberry.h"
+#include "bitmap/thermometer_empty.h"
+#include "bitmap/thermometer_full.h"
+#include "bitmap/splash.h"
+#include "bitmap/splash_packed.h"
+#include "bitmap/raspberry_packed.h"
+
+#define DISPLAY_WIDTH LEGACY_WIDTH
+#define DISPLAY_HEIGHT LEGACY_HEIGHT
+
+#define BENCH_TEXT "Pack my box with\nfive dozen liquor\njugs 0123456789"
+
+
+static oled_sim_controller sim(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+static oled_sim_transport sim_bus(&sim);
+static pico_oled display(OLED_SSD1306, &sim_bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+static pico_oled_static<DISPLAY_WIDTH, DISPLAY_HEIGHT, OLED_SSD1306> static_display(&sim_bus);
+static pico_oled_paged paged_display(OLED_SSD1306, &sim_bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+static analog_gauge gauge(&display);
+static analog_gauge static_gauge(&static_display);
+static oled_sprite_image raspberry_sprite(raspberry.bitmap, raspberry.width, raspberry.height);
+
+static uint32_t min_time_ms = 200;
+static const char *filter = NULL;
+
+
+/// @brief Number of lit pixels after drawing a case once on a blank display
+template <typename F>
+static uint32_t count_pixels(pico_oled *target, F draw)
+{
+    target->fill(0);
+    target->invalidate();
+
+    // Cases that send their own frame aren't rendered again
+    uint32_t data_bytes = sim.get_stats().data_bytes;
+    draw();
+
+    if (sim.get_stats().data_bytes == data_bytes)
+        target->render();
+
+    uint32_t count = 0;
+
+    for (uint8_t page = 0; page < DISPLAY_HEIGHT / OLED_PAGE_HEIGHT; page++)
+    {
+        for (uint8_t column = 0; column < DISPLAY_WIDTH; column++)
+        {
+            uint8_t bits = sim.get_ram(column, page);
+
+            while (bits)
+            {
+                count += bits & 1;
+                bits >>= 1;
+            }
+        }
+    }
+
+    return count;
+}
+
+
+/// @brief Run a case, doubling the iteration count until it runs for at least the minimum time
+/// @param draw calls for one iteration
+/// @param target display cleared before each batch of iterations, or NULL
+/// @param iterations set to the iteration count of the timed batch
+/// @return ns per iteration
+template <typename F>
+static double time_case(F draw, pico_oled *target, uint64_t *iterations)
+{
+    double elapsed_ns;
+
+    for (*iterations = 16; ; *iterations *= 2)
+    {
+        if (target != NULL)
+            target->fill(0);
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < *iterations; i++)
+            draw();
+
+        auto end = std::chrono::steady_clock::now();
+        elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+        if (elapsed_ns >= min_time_ms * 1e6)
+            break;
+    }
+
+    return elapsed_ns / *iterations;
+}
+
+
+/// @brief Time a case and print its line
+/// @param name case name printed in the first column
+/// @param draw drawing calls for one iteration
+/// @param target display the calls draw on
+template <typename F>
+static void bench(const char *name, F draw, pico_oled *target=&display)
+{
+    if (filter != NULL && strstr(name, filter) == NULL)
+        return;
+
+    uint32_t pixels = count_pixels(target, draw);
+    uint64_t iterations;
+    double ns_per_op = time_case(draw, target, &iterations);
+
+    printf("%s,%llu,%.1f,%u,%.0f\n", name, (unsigned long long) iterations, ns_per_op, pixels, pixels * 1e9 / ns_per_op);
+    fflush(stdout);
+}
+
+
+/// @brief Time unpacking a packed asset into memory and print its line of the packing table
+/// @param name asset name printed in the first column
+/// @param format OLED_pack_format of the asset
+/// @param raw_bytes size of the asset before packing
+/// @param packed_bytes size of the packed data
+/// @param unpacked_bytes bytes one call of unpack decodes
+/// @param unpack decodes the asset once
+template <typename F>
+static void bench_unpack(const char *name, uint8_t format, uint32_t raw_bytes, uint32_t packed_bytes, uint32_t unpacked_bytes, F unpack)
+{
+    static const char *format_names[] = {"raw", "rle", "lz"};
+
+    if (filter != NULL && strstr(name, filter) == NULL)
+        return;
+
+    uint64_t iterations;
+    double ns_per_op = time_case(unpack, NULL, &iterations);
+
+    printf("%s,%s,%u,%u,%.2f,%.1f,%.0f\n", name, format_names[format], raw_bytes, packed_bytes, (double) raw_bytes / packed_bytes,
+        ns_per_op, unpacked_bytes * 1e9 / ns_per_op);
+    fflush(stdout);
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        min_time_ms = atoi(argv[1]);
+
+    if (argc > 2)
+        filter = argv[2];
+
+    display.oled_init();
+    static_display.oled_init();
+    paged_display.oled_init();
+
+    gauge.set_position(63, 63);
+    gauge.set_scale(/*scale_min=*/ 0, /*scale_max=*/ 100, /*scale_start_deg=*/ 220, /*scale_end_deg=*/ 320);
+    gauge.set_markers(/*scale_divisions=*/ 3, /*needle_len=*/ 45, /*marker_len=*/ 15, /*half_divisions=*/ 1);
+    gauge.set_value(70);
+
+    static_gauge.set_position(63, 63);
+    static_gauge.set_scale(/*scale_min=*/ 0, /*scale_max=*/ 100, /*scale_start_deg=*/ 220, /*scale_end_deg=*/ 320);
+    static_gauge.set_markers(/*scale_divisions=*/ 3, /*needle_len=*/ 45, /*marker_len=*/ 15, /*half_divisions=*/ 1);
+    static_gauge.set_value(70);
+
+    // The reference versions draw straight into the display's buffer
+    uint8_t *pixels = (uint8_t *) display.get_pixels();
+
+    printf("name,iterations,ns_per_op,pixels_per_op,pixels_per_s\n");
+
+    bench("fill", [] { display.fill(0); });
+    bench("fill_legacy", [pixels] { legacy_fill(pixels, 0); });
+
+    // Runtime sized display against one with its size fixed at compile time
+    bench("draw_pixel_diagonal", []
+    {
+        for (uint8_t i = 0; i < DISPLAY_HEIGHT; i++)
+            display.draw_pixel(i, i);
+    });
+
+    bench("draw_pixel_diagonal_static", []
+    {
+        for (uint8_t i = 0; i < DISPLAY_HEIGHT; i++)
+            static_display.draw_pixel(i, i);
+    }, &static_display);
+
+    bench("draw_line_shallow", [] { display.draw_line(0, 10, 127, 50); });
+    bench("draw_line_steep", [] { display.draw_line(20, 0, 60, 63); });
+    bench("draw_line_hline", [] { display.draw_line(0, 30, 127, 30); });
+    bench("draw_line_vline", [] { display.draw_line(64, 0, 64, 63); });
+    bench("draw_line_dotted", [] { display.draw_line_dotted(0, 10, 127, 50); });
+
+    bench("fill_rect_small", [] { display.fill_rect(0, 10, 10, 25, 25); });
+    bench("fill_rect_unaligned", [] { display.fill_rect(0, 3, 5, 124, 58); });
+    bench("fill_rect_full", [] { display.fill_rect(0, 0, 0, 127, 63); });
+    bench("fill_rect_small_legacy", [pixels] { legacy_fill_rect(pixels, 0, 10, 10, 25, 25); });
+    bench("fill_rect_unaligned_legacy", [pixels] { legacy_fill_rect(pixels, 0, 3, 5, 124, 58); });
+    bench("fill_rect_full_legacy", [pixels] { legacy_fill_rect(pixels, 0, 0, 0, 127, 63); });
+    bench("fill_rect_invert", [] { display.fill_rect_op(OLED_OP_INVERT, 3, 5, 124, 58); });
+    bench("draw_box", [] { display.draw_box(3, 5, 124, 58); });
+
+    // Bitmap blits at every offset within a page
+    for (uint8_t offset = 0; offset < OLED_PAGE_HEIGHT; offset++)
+    {
+        char name[32];
+
+        snprintf(name, sizeof(name), "blit_16x20_y+%u", offset);
+        bench(name, [offset] { display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 37, 8 + offset); });
+
+        snprintf(name, sizeof(name), "blit_8x20_y+%u", offset);
+        bench(name, [offset] { display.draw_bmp(thermometer_full.bitmap, thermometer_full.width, thermometer_full.height, 37, 8 + offset); });
+
+        snprintf(name, sizeof(name), "blit_16x20_y+%u_legacy", offset);
+        bench(name, [pixels, offset] { legacy_blit(pixels, raspberry.bitmap, raspberry.width, 0, 0, raspberry.width, raspberry.height, 37, 8 + offset, OLED_OP_SET); });
+    }
+
+    // Many icons per frame, at every row within a page: blitted, and as pre-shifted sprites
+    static oled_sprite sprite_memory[24];
+    static oled_sprite_list sprites(sprite_memory, 24);
+
+    for (uint8_t i = 0; i < 24; i++)
+        sprites.add(&raspberry_sprite, (i * 37) % 112, (i * 13) % 44);
+
+    bench("icons_24_blit", []
+    {
+        for (uint8_t i = 0; i < 24; i++)
+            display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, (i * 37) % 112, (i * 13) % 44);
+    });
+
+    bench("icons_24_sprite_list", [] { sprites.draw(&display); });
+
+    // An icon over a busy background: clearing under it and blitting, or one masked blit
+    bench("overlay_clear_and_blit", []
+    {
+        display.fill_rect(1, 37, 11, 52, 30);
+        display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 37, 11);
+    });
+
+    bench("overlay_masked", [] { display.draw_masked_bmp(raspberry_masked, 37, 11); });
+
+    // A full screen bitmap, and the same one packed and decoded into the screen buffer as it is drawn
+    bench("splash_draw_bmp", [] { display.draw_bmp(splash.bitmap, splash.width, splash.height, 0, 0); });
+    bench("splash_draw_packed", [] { display.draw_packed(splash_packed, 0, 0); });
+    bench("splash_draw_packed_y+3", [] { display.draw_packed(splash_packed, 0, 3); });
+    bench("splash_draw_packed_clipped", [] { display.draw_packed(splash_packed, 60, 30); });
+
+    const gfx_font *fonts[] = {&press_start_2p, &too_simple, &Retron2000, &Retron2000_packed};
+    const char *font_names[] = {"press_start_2p", "too_simple", "Retron2000", "Retron2000_packed"};
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        char name[32];
+        const gfx_font *font = fonts[i];
+        display.set_font(*font);
+
+        snprintf(name, sizeof(name), "print_%s", font_names[i]);
+        bench(name, [] { display.set_cursor(0, 0); display.print(BENCH_TEXT); });
+    }
+
+    bench("draw_vbar", [] { display.draw_vbar(50, 0, 9, 9, 63); });
+    bench("draw_hbar", [] { display.draw_hbar(50, false, 22, 9, 105, 19); });
+    bench("draw_bmp_vbar", [] { display.draw_bmp_vbar(50, thermometer_empty, thermometer_full, 12, 9); });
+    bench("analog_gauge_draw", [] { gauge.draw(); });
+
+    // Moving a needle: redrawing the whole gauge, or erasing the old needle and drawing the new one by toggling
+    bench("needle_move_redraw", [] { display.fill(0); gauge.draw(); });
+    bench("needle_move_invert", []
+    {
+        display.set_draw_mode(OLED_OP_INVERT);
+        display.draw_line(63, 63, 30, 31);
+        display.draw_line(63, 63, 32, 30);
+        display.set_draw_mode(OLED_OP_SET);
+    });
+
+    // Kernels compiled for a 128 pixel stride, on the display with its width fixed at compile time. Compare with
+    // the cases of the same name on the runtime sized display
+    static_display.set_font(Retron2000);
+
+    bench("draw_line_shallow_static", [] { static_display.draw_line(0, 10, 127, 50); }, &static_display);
+    bench("draw_line_steep_static", [] { static_display.draw_line(20, 0, 60, 63); }, &static_display);
+    bench("fill_rect_unaligned_static", [] { static_display.fill_rect(0, 3, 5, 124, 58); }, &static_display);
+    bench("blit_16x20_y+3_static", [] { static_display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 37, 11); }, &static_display);
+    bench("icons_24_sprite_list_static", [] { sprites.draw(&static_display); }, &static_display);
+    bench("splash_draw_packed_static", [] { static_display.draw_packed(splash_packed, 0, 0); }, &static_display);
+    bench("print_Retron2000_static", [] { static_display.set_cursor(0, 0); static_display.print(BENCH_TEXT); }, &static_display);
+    bench("analog_gauge_draw_static", [] { static_gauge.draw(); }, &static_display);
+
+    // Whole frame drawn and sent from a full screen buffer, and one page at a time
+    display.set_font(press_start_2p);
+    paged_display.set_font(press_start_2p);
+
+    auto draw_frame = [](oled_canvas *canvas)
+    {
+        canvas->set_cursor(0, 0);
+        canvas->print(BENCH_TEXT);
+        canvas->draw_line(0, 10, 127, 50);
+        canvas->fill_rect(0, 100, 40, 120, 60);
+    };
+
+    bench("frame_full_buffer", [draw_frame] { display.fill(0); draw_frame(&display); display.invalidate(); display.render(); });
+    bench("frame_paged", [draw_frame] { paged_display.render_pages(draw_frame); }, &paged_display);
+
+    // Taking a whole frame into a front buffer for a background transfer, as bytes (SPI, PIO) and as I2C
+    // data/command words: copying it and then clearing it, and zeroing each byte as it is copied
+    static uint8_t frame[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    static uint8_t front_bytes[sizeof(frame)];
+    static uint16_t front_words[sizeof(frame)];
+
+    bench("front_copy_then_clear", [] { oled_take_rows(front_bytes, frame, DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT / OLED_PAGE_HEIGHT, false); memset(frame, 0, sizeof(frame)); });
+    bench("front_copy_and_clear", [] { oled_take_rows(front_bytes, frame, DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT / OLED_PAGE_HEIGHT, true); });
+    bench("front_copy_then_clear_i2c", [] { oled_take_rows(front_words, frame, DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT / OLED_PAGE_HEIGHT, false); memset(frame, 0, sizeof(frame)); });
+    bench("front_copy_and_clear_i2c", [] { oled_take_rows(front_words, frame, DISPLAY_WIDTH, DISPLAY_WIDTH, DISPLAY_HEIGHT / OLED_PAGE_HEIGHT, true); });
+
+    // The same frame recorded in a display list, found to be identical and skipped
+    static uint8_t list_memory[2048];
+    static oled_display_list list(list_memory, sizeof(list_memory));
+    display.set_display_list(&list);
+
+    bench("frame_display_list_same", [draw_frame] { display.fill(0); draw_frame(&display); display.render(); });
+
+    display.set_display_list(NULL);
+
+    // Packed assets: sizes, and how fast they decode into memory
+    printf("\nasset,format,raw_bytes,packed_bytes,ratio,unpack_ns,unpack_bytes_per_s\n");
+
+    static uint8_t unpacked[sizeof(Retron2000_bitmaps)];
+    const packed_bitmap *assets[] = {&splash_packed, &raspberry_packed, &raspberry_mask_packed};
+    const char *asset_names[] = {"pack_splash", "pack_raspberry", "pack_raspberry_mask"};
+
+    for (uint8_t i = 0; i < sizeof(assets) / sizeof(assets[0]); i++)
+    {
+        const packed_bitmap *asset = assets[i];
+        uint32_t bytes = asset->width * ((asset->height + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT);
+
+        bench_unpack(asset_names[i], asset->format, bytes, asset->size, bytes, [asset, bytes]
+        {
+            oled_unpacker unpacker(asset->data, asset->format);
+            unpacker.unpack(unpacked, bytes);
+        });
+    }
+
+    // Every glyph of a packed font, each unpacked on its own
+    const gfx_font &font = Retron2000_packed;
+    uint32_t glyph_bytes = 0;
+
+    for (uint16_t c = 0; c <= font.last - font.first; c++)
+        glyph_bytes += font.character[c].width * ((font.character[c].height + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT);
+
+    bench_unpack("pack_Retron2000", font.packed_format, sizeof(Retron2000_bitmaps), sizeof(Retron2000_packed_data), glyph_bytes, [&font]
+    {
+        for (uint16_t c = 0; c <= font.last - font.first; c++)
+        {
+            const gfx_char *character = &font.character[c];
+            uint16_t bytes = character->width * ((character->height + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT);
+            oled_unpacker unpacker(font.packed, font.packed_format, font.packed_offsets[c]);
+
+            // Glyphs are unpacked over each other
+            unpacker.unpack(unpacked, bytes);
+        }
+    });
+
+    return 0;
+}
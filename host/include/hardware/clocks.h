@@ -0,0 +1,17 @@
+/**
+ *  hardware/clocks.h (host)
+ *  The system clock, fixed at its default frequency
+ */
+#ifndef _HARDWARE_HOST_CLOCKS_H_
+#define _HARDWARE_HOST_CLOCKS_H_
+
+#include "pico/stdlib.h"
+
+enum clock_index
+{
+    clk_sys = 5
+};
+
+static inline uint32_t clock_get_hz(enum clock_index clk_index) { return 125000000; }
+
+#endif
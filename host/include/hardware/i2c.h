@@ -0,0 +1,62 @@
+/**
+ *  hardware/i2c.h (host)
+ *  I2C blocks that pass each transaction to handlers registered with host_i2c_add_handler(), 
+ *  e.g. a simulated display controller
+ */
+#ifndef _HARDWARE_HOST_I2C_H_
+#define _HARDWARE_HOST_I2C_H_
+
+#include "pico/stdlib.h"
+
+#define NUM_I2CS 2
+
+#define I2C_IC_DATA_CMD_STOP_BITS _u(0x00000200)
+#define I2C_IC_DATA_CMD_RESTART_BITS _u(0x00000400)
+#define I2C_IC_RAW_INTR_STAT_STOP_DET_BITS _u(0x00000200)
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS _u(0x00000040)
+#define I2C_IC_DMA_CR_TDMAE_BITS _u(0x00000002)
+
+typedef struct
+{
+    io_rw_32 enable;
+    io_rw_32 tar;
+    io_rw_32 data_cmd;
+    io_rw_32 dma_cr;
+    io_rw_32 raw_intr_stat;
+    io_rw_32 clr_stop_det;
+    io_rw_32 clr_tx_abrt;
+} i2c_hw_t;
+
+typedef struct i2c_inst
+{
+    i2c_hw_t *hw;
+    uint index;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+#define i2c_default i2c0
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+static inline uint i2c_hw_index(i2c_inst_t *i2c) { return i2c->index; }
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) { return i2c->hw; }
+static inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) { return 32 + 2 * i2c->index + (is_tx ? 0 : 1); }
+
+/// @brief Called with every complete transaction written to an I2C block
+/// @return true if the transaction was addressed to (and acknowledged by) this handler
+typedef bool (*host_i2c_handler)(void *context, uint8_t addr, const uint8_t *src, size_t len);
+
+void host_i2c_add_handler(i2c_inst_t *i2c, host_i2c_handler handler, void *context);
+void host_i2c_remove_handler(i2c_inst_t *i2c, void *context);
+
+/// @brief Keep transactions written to the data/command register (e.g. by DMA) from seeing their stop condition until
+///        host_i2c_release() is called, as if the controller were still shifting them out
+void host_i2c_hold(i2c_inst_t *i2c, bool hold);
+void host_i2c_release(i2c_inst_t *i2c);
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ *  hardware/pio.h (host)
+ *  PIO blocks whose state machines run as soon as their TX FIFO is written, one cycle at a time until they stall.
+ *  Only the instructions the bundled programs use are decoded: OUT to pins, and MOV Y, Y (nop), with side-set
+ *  and delay. Each cycle is passed, with the levels the state machine drives, to a handler registered with
+ *  host_pio_set_handler(). The clock divider is accepted but every instruction takes one cycle plus its delay.
+ */
+#ifndef _HARDWARE_HOST_PIO_H_
+#define _HARDWARE_HOST_PIO_H_
+
+#include "pico/stdlib.h"
+
+#define NUM_PIOS 2
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+
+#define PIO_FDEBUG_TXSTALL_LSB _u(24)
+
+typedef struct
+{
+    io_rw_32 fdebug;        // TXSTALL bits are set when a state machine stalls on an empty TX FIFO
+    io_rw_32 txf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t host_pio_hw[NUM_PIOS];
+
+#define pio0 (&host_pio_hw[0])
+#define pio1 (&host_pio_hw[1])
+
+enum pio_fifo_join
+{
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX = 1,
+    PIO_FIFO_JOIN_RX = 2
+};
+
+typedef struct pio_program
+{
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+typedef struct
+{
+    uint8_t wrap_target;
+    uint8_t wrap;
+    uint8_t sideset_bit_count;      // Including the enable bit of an optional side-set
+    bool sideset_optional;
+    uint8_t sideset_base;
+    uint8_t out_base;
+    uint8_t out_count;
+    bool shift_right;
+    bool autopull;
+    uint8_t pull_threshold;         // 32 when given as 0
+    enum pio_fifo_join fifo_join;
+    float clkdiv;
+} pio_sm_config;
+
+pio_sm_config pio_get_default_sm_config();
+
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) { c->wrap_target = wrap_target; c->wrap = wrap; }
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count) { c->out_base = out_base; c->out_count = out_count; }
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base) { c->sideset_base = sideset_base; }
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) { c->fifo_join = join; }
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) { c->clkdiv = div; }
+
+static inline void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs)
+{
+    c->sideset_bit_count = bit_count;
+    c->sideset_optional = optional;
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold)
+{
+    c->shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = pull_threshold ? pull_threshold : 32;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_unclaim(PIO pio, uint sm);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+
+static inline uint pio_get_index(PIO pio) { return pio == pio1 ? 1 : 0; }
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) { return pio_get_index(pio) * 8 + sm + (is_tx ? 0 : 4); }
+
+/// @brief Called for every cycle a state machine runs, and once when it stalls
+/// @param sm state machine that ran
+/// @param pins levels the state machine drives, bit n for GPIO n
+/// @param stalled true for the cycle the state machine stalled on
+typedef void (*host_pio_handler)(void *context, uint sm, uint32_t pins, bool stalled);
+
+void host_pio_set_handler(PIO pio, host_pio_handler handler, void *context);
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ *  hardware/spi.h (host)
+ *  SPI blocks that pass written bytes, along with the level of a data/command GPIO, 
+ *  to a handler registered with host_spi_set_handler()
+ */
+#ifndef _HARDWARE_HOST_SPI_H_
+#define _HARDWARE_HOST_SPI_H_
+
+#include "pico/stdlib.h"
+
+#define SPI_SSPICR_RORIC_BITS _u(0x00000001)
+
+typedef struct
+{
+    io_rw_32 dr;
+    io_rw_32 sr;
+    io_rw_32 icr;
+} spi_hw_t;
+
+typedef struct spi_inst
+{
+    spi_hw_t *hw;
+    uint index;
+} spi_inst_t;
+
+extern spi_inst_t spi0_inst;
+extern spi_inst_t spi1_inst;
+
+#define spi0 (&spi0_inst)
+#define spi1 (&spi1_inst)
+#define spi_default spi0
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+
+static inline spi_hw_t *spi_get_hw(spi_inst_t *spi) { return spi->hw; }
+static inline uint spi_get_dreq(spi_inst_t *spi, bool is_tx) { return 16 + 2 * spi->index + (is_tx ? 0 : 1); }
+static inline bool spi_is_busy(spi_inst_t *spi) { return false; }
+static inline bool spi_is_readable(spi_inst_t *spi) { return false; }
+
+/// @brief Called with bytes written to an SPI block
+/// @param data level of the data/command GPIO given to host_spi_set_handler(), true for display data
+typedef void (*host_spi_handler)(void *context, bool data, const uint8_t *src, size_t len);
+
+void host_spi_set_handler(spi_inst_t *spi, uint dc_gpio, host_spi_handler handler, void *context);
+
+#endif
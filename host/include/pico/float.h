@@ -0,0 +1,10 @@
+/**
+ *  pico/float.h (host)
+ *  The Pico SDK's float functions (e.g. sincosf) come from the C library on a PC
+ */
+#ifndef _PICO_HOST_FLOAT_H_
+#define _PICO_HOST_FLOAT_H_
+
+#include <math.h>
+
+#endif
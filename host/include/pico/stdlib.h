@@ -0,0 +1,74 @@
+/**
+ *  pico/stdlib.h (host)
+ *  The parts of the Pico SDK used by pico-oled, implemented for building and simulating on a PC
+ */
+#ifndef _PICO_HOST_STDLIB_H_
+#define _PICO_HOST_STDLIB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+typedef volatile uint32_t io_rw_32;
+typedef const volatile uint32_t io_ro_32;
+
+#define _u(x) x ## u
+
+#define PICO_ON_DEVICE 0
+
+#define PICO_ERROR_GENERIC -1
+
+// GPIO
+#define NUM_BANK0_GPIOS 30
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+enum gpio_function
+{
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_NULL = 0x1f
+};
+
+#define PICO_DEFAULT_I2C_SDA_PIN 4
+#define PICO_DEFAULT_I2C_SCL_PIN 5
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+
+// Time, in microseconds since the program started
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time();
+uint64_t time_us_64();
+uint32_t time_us_32();
+void sleep_until(absolute_time_t target);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return get_absolute_time() + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return get_absolute_time() + (uint64_t) ms * 1000; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t) (to - from); }
+
+// Runtime. Threads run as core 0 unless they say otherwise with host_set_core_num()
+#define NUM_CORES 2
+
+[[noreturn]] void panic(const char *fmt, ...);
+static inline void tight_loop_contents() {}
+uint get_core_num();
+void host_set_core_num(uint core);
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ *  legacy.hpp
+ *  The drawing kernels as they were before the word and column kernels replaced them, drawing into the page
+ *  buffer of a 128x64 display. oled_test checks the library against them and oled_bench times them side by side.
+ */
+#ifndef _OLED_LEGACY_H_
+#define _OLED_LEGACY_H_
+
+#include "pico/stdlib.h"
+#include "../oled-raster.hpp"
+
+#define LEGACY_WIDTH _u(128)
+#define LEGACY_HEIGHT _u(64)
+
+// The library's kernels are called with coordinates only known at run time, so the references mustn't be
+// compiled into copies specialised for the constant rectangles oled_bench passes them
+#ifdef __clang__
+#define LEGACY_KERNEL __attribute__((noinline))
+#else
+#define LEGACY_KERNEL __attribute__((noipa))
+#endif
+
+
+/// @brief Byte at a time fill, the version before the word kernels, kept as a reference
+LEGACY_KERNEL static void legacy_fill(uint8_t *pixels, uint8_t fill)
+{
+    for (uint16_t i = 0; i < LEGACY_WIDTH * LEGACY_HEIGHT / OLED_PAGE_HEIGHT; i++)
+        pixels[i] = fill;
+}
+
+
+/// @brief Column at a time fill_rect, the version before the word kernels, kept as a reference
+LEGACY_KERNEL static void legacy_fill_rect(uint8_t *pixels, uint8_t blank, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    uint8_t start_page = y1 / OLED_PAGE_HEIGHT;
+    uint8_t end_page = y2 / OLED_PAGE_HEIGHT;
+
+    for (uint8_t page = start_page; page <= end_page; page++)
+    {
+        for (uint8_t column = x1; column <= x2; column++)
+        {
+            uint8_t col_mask = 0xFF;
+
+            if (page == start_page)
+                col_mask &= 0xFF << (y1 - page*OLED_PAGE_HEIGHT);
+
+            if (page == end_page)
+                col_mask &= 0xFF >> (OLED_PAGE_HEIGHT - (1 + y2 - page*OLED_PAGE_HEIGHT));
+
+            if (blank)
+                pixels[column + page*LEGACY_WIDTH] &= ~col_mask;
+            else
+                pixels[column + page*LEGACY_WIDTH] |= col_mask;
+        }
+    }
+}
+
+
+/// @brief Page walking blit, the version before the 16-bit column kernel, kept as a reference. Clipped to the screen
+LEGACY_KERNEL static void legacy_blit(uint8_t *pixels, const uint8_t *src_bitmap, uint16_t src_width, uint16_t src_x, uint8_t src_y,
+    uint8_t blit_width, uint8_t blit_height, int16_t screen_x, int16_t screen_y, OLED_raster_op op)
+{
+    int16_t left = (screen_x > 0) ? screen_x : 0;
+    int16_t top = (screen_y > 0) ? screen_y : 0;
+    int16_t right = screen_x + blit_width - 1;
+    int16_t bottom = screen_y + blit_height - 1;
+
+    if (right > (int16_t) LEGACY_WIDTH - 1)
+        right = LEGACY_WIDTH - 1;
+
+    if (bottom > (int16_t) LEGACY_HEIGHT - 1)
+        bottom = LEGACY_HEIGHT - 1;
+
+    if (blit_width == 0 || blit_height == 0 || left > right || top > bottom)
+        return;
+
+    uint16_t src_top = src_y + (top - screen_y);
+    src_x += left - screen_x;
+    blit_height = bottom - top + 1;
+
+    uint8_t src_page_offset = src_top % OLED_PAGE_HEIGHT;
+    int8_t offset_delta = top % OLED_PAGE_HEIGHT - src_page_offset;
+
+    uint16_t screen_line = top;
+    uint16_t src_line = src_top;
+    uint16_t end_line = src_top + blit_height - 1;
+    uint8_t last_src_page = 255;
+    uint8_t last_screen_page = 255;
+    int8_t mask_amt;
+
+    while (src_line <= end_line)
+    {
+        uint8_t src_page = src_line / OLED_PAGE_HEIGHT;
+        uint8_t lines_available = OLED_PAGE_HEIGHT - (src_line - src_page * OLED_PAGE_HEIGHT);
+        uint8_t screen_page = screen_line / OLED_PAGE_HEIGHT;
+        uint8_t lines_drawable = OLED_PAGE_HEIGHT - (screen_line - screen_page * OLED_PAGE_HEIGHT);
+        uint8_t u_mask = 0;
+        uint8_t l_mask = 0;
+
+        if (src_line + lines_available > end_line)
+        {
+            lines_available = end_line - src_line + 1;
+            u_mask = OLED_PAGE_HEIGHT - lines_available;
+        }
+
+        if (src_line == src_top)
+            l_mask = src_page_offset;
+
+        if (lines_drawable > lines_available)
+            lines_drawable = lines_available;
+
+        if (lines_drawable == 0)
+            lines_drawable = OLED_PAGE_HEIGHT;
+
+        uint8_t keep_mask;
+        uint8_t shift_down = 0;
+        uint8_t shift_up = 0;
+
+        if (offset_delta >= 0)
+        {
+            if (last_src_page == src_page)
+            {
+                mask_amt = u_mask - (OLED_PAGE_HEIGHT - offset_delta);
+                keep_mask = (mask_amt > 0) ? 0xFF >> mask_amt : 0xFF;
+                shift_up = OLED_PAGE_HEIGHT - offset_delta;
+            }
+            else
+            {
+                keep_mask = (0xFF << l_mask) & (0xFF >> u_mask);
+                shift_down = offset_delta;
+            }
+        }
+        else
+        {
+            if (last_screen_page == screen_page)
+            {
+                mask_amt = u_mask - (OLED_PAGE_HEIGHT + offset_delta);
+                keep_mask = (mask_amt > 0 && lines_drawable > u_mask) ? 0xFF >> mask_amt : 0xFF;
+                shift_down = OLED_PAGE_HEIGHT + offset_delta;
+            }
+            else
+            {
+                keep_mask = 0xFF << l_mask;
+
+                if (u_mask > (-1*offset_delta))
+                    keep_mask &= 0xFF >> (u_mask + offset_delta);
+
+                shift_up = -1 * offset_delta;
+            }
+        }
+
+        oled_blit_span(&pixels[left + screen_page*LEGACY_WIDTH], &src_bitmap[src_x + src_page*src_width], right - left + 1,
+            keep_mask, shift_down, shift_up, op);
+
+        screen_line += lines_drawable;
+        src_line += lines_drawable;
+        last_src_page = src_page;
+        last_screen_page = screen_page;
+    }
+}
+
+#endif
@@ -0,0 +1,76 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+// Host build copy of the header pioasm makes from ../oled-pio.pio, as the host build has no pioasm.
+// Regenerate it with "pioasm oled-pio.pio host/oled-pio.pio.h" after changing the program.
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ----------- //
+// oled_spi_tx //
+// ----------- //
+
+#define oled_spi_tx_wrap_target 0
+#define oled_spi_tx_wrap 1
+
+static const uint16_t oled_spi_tx_program_instructions[] = {
+            //     .wrap_target
+    0x6001, //  0: out    pins, 1         side 0     
+    0xb042, //  1: nop                    side 1     
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program oled_spi_tx_program = {
+    .instructions = oled_spi_tx_program_instructions,
+    .length = 2,
+    .origin = -1,
+};
+
+static inline pio_sm_config oled_spi_tx_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + oled_spi_tx_wrap_target, offset + oled_spi_tx_wrap);
+    sm_config_set_sideset(&c, 1, false, false);
+    return c;
+}
+
+#include "hardware/clocks.h"
+
+/// @brief Set up a state machine to run the oled_spi_tx program
+/// @param pio PIO block to use
+/// @param sm state machine to use
+/// @param offset where the program was loaded in instruction memory
+/// @param clk_pin GPIO connected to the display's clock (SCK/D0) pin
+/// @param data_pin GPIO connected to the display's data (MOSI/D1) pin
+/// @param clock_hz bit clock frequency
+static inline void oled_spi_tx_program_init(PIO pio, uint sm, uint offset, uint clk_pin, uint data_pin, uint32_t clock_hz)
+{
+    pio_sm_config config = oled_spi_tx_program_get_default_config(offset);
+
+    sm_config_set_out_pins(&config, data_pin, 1);
+    sm_config_set_sideset_pins(&config, clk_pin);
+
+    // Shift left so the MSB goes first, autopull after every byte.
+    // Byte writes to the FIFO are replicated across the word, so the top byte holds the data
+    sm_config_set_out_shift(&config, false, true, 8);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_TX);
+
+    // Two cycles per bit
+    sm_config_set_clkdiv(&config, (float) clock_get_hz(clk_sys) / (2.0f * clock_hz));
+
+    pio_sm_set_pins_with_mask(pio, sm, 0, (1u << clk_pin) | (1u << data_pin));
+    pio_sm_set_pindirs_with_mask(pio, sm, (1u << clk_pin) | (1u << data_pin), (1u << clk_pin) | (1u << data_pin));
+    pio_gpio_init(pio, clk_pin);
+    pio_gpio_init(pio, data_pin);
+
+    pio_sm_init(pio, sm, offset, &config);
+    pio_sm_set_enabled(pio, sm, true);
+}
+
+#endif
+
@@ -0,0 +1,666 @@
+#include "oled-sim.hpp"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+
+/// @brief Create a simulated controller in its reset state
+/// @param controller_ic controller to simulate
+/// @param screen_width width of the panel in pixels, used for saved images
+/// @param screen_height height of the panel in pixels, used for saved images
+oled_sim_controller::oled_sim_controller(OLED_type controller_ic, uint8_t screen_width, uint8_t screen_height)
+{
+    controller = controller_ic;
+    panel_width = (screen_width > OLED_SIM_COLUMNS) ? OLED_SIM_COLUMNS : screen_width;
+    panel_height = (screen_height > OLED_SIM_PAGES * OLED_PAGE_HEIGHT) ? OLED_SIM_PAGES * OLED_PAGE_HEIGHT : screen_height;
+    i2c = NULL;
+    i2c_address = 0;
+
+    reset();
+    memset(ram, 0, sizeof(ram));
+    reset_stats();
+}
+
+
+oled_sim_controller::~oled_sim_controller()
+{
+    if (i2c != NULL)
+        host_i2c_remove_handler(i2c, this);
+}
+
+
+/// @brief Put every setting back to its reset value, as the reset pin would. Display RAM is kept.
+void oled_sim_controller::reset()
+{
+    cmd_length = 0;
+    cmd_expected = 0;
+
+    addr_mode = 2;
+    col_start = 0;
+    col_end = OLED_SIM_COLUMNS - 1;
+    page_start = 0;
+    page_end = OLED_SIM_PAGES - 1;
+    page_col_start = 0;
+    col = 0;
+    page = 0;
+
+    seg_remap = 0;
+    com_reversed = 0;
+    start_line = 0;
+    display_offset = 0;
+    mux_ratio = 63;
+    contrast = 0x7F;
+    display_on = 0;
+    entire_on = 0;
+    inverted = 0;
+    scrolling = 0;
+}
+
+
+void oled_sim_controller::reset_stats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+
+/// @brief Number of argument bytes following a command byte
+uint8_t oled_sim_controller::arg_count(uint8_t cmd)
+{
+    switch (cmd)
+    {
+        case 0x20:  // memory addressing mode
+        case 0x81:  // contrast
+        case 0x8D:  // charge pump
+        case 0xA8:  // multiplex ratio
+        case 0xD3:  // display offset
+        case 0xD5:  // clock divide
+        case 0xD9:  // pre-charge period
+        case 0xDA:  // COM pin configuration
+        case 0xDB:  // VCOMH deselect level
+        case 0xFD:  // command lock
+            return 1;
+
+        case 0x21:  // column address
+        case 0x22:  // page address
+        case 0xA3:  // vertical scroll area
+            return 2;
+
+        case 0x29:  // vertical and horizontal scroll setup
+        case 0x2A:
+            return 5;
+
+        case 0x26:  // horizontal scroll setup
+        case 0x27:
+            return 6;
+
+        default:
+            return 0;
+    }
+}
+
+
+/// @brief Receive one command byte, which may be an argument of the previous command
+void oled_sim_controller::command(uint8_t cmd)
+{
+    stats.cmd_bytes++;
+    cmd_buf[cmd_length++] = cmd;
+
+    if (cmd_length == 1)
+        cmd_expected = arg_count(cmd);
+
+    if (cmd_length > cmd_expected)
+    {
+        execute(cmd_buf);
+        cmd_length = 0;
+    }
+}
+
+
+/// @brief Apply a complete command
+/// @param cmd command byte followed by its arguments
+void oled_sim_controller::execute(const uint8_t *cmd)
+{
+    uint8_t op = cmd[0];
+
+    // Page addressing column start, low and high nibble
+    if (op <= 0x0F)
+    {
+        page_col_start = (page_col_start & 0xF0) | (op & 0x0F);
+        col = page_col_start;
+        return;
+    }
+
+    if (op <= 0x1F)
+    {
+        page_col_start = (page_col_start & 0x0F) | ((op & 0x07) << 4);
+        col = page_col_start;
+        return;
+    }
+
+    if (op >= 0x40 && op <= 0x7F)
+    {
+        start_line = op & 0x3F;
+        return;
+    }
+
+    if (op >= 0xB0 && op <= 0xB7)
+    {
+        page = op & 0x07;
+        return;
+    }
+
+    switch (op)
+    {
+        case 0x20:
+            if ((cmd[1] & 0x03) != 3)
+                addr_mode = cmd[1] & 0x03;
+            break;
+
+        case 0x21:
+            col_start = cmd[1] & 0x7F;
+            col_end = cmd[2] & 0x7F;
+            col = col_start;
+            break;
+
+        case 0x22:
+            page_start = cmd[1] & 0x07;
+            page_end = cmd[2] & 0x07;
+            page = page_start;
+            break;
+
+        case 0x26:
+        case 0x27:
+        case 0x29:
+        case 0x2A:
+        case 0xA3:
+            break;
+
+        case 0x2E:
+            scrolling = 0;
+            break;
+
+        case 0x2F:
+            scrolling = 1;
+            break;
+
+        case 0x81:
+            contrast = cmd[1];
+            break;
+
+        case 0xA0:
+        case 0xA1:
+            seg_remap = op & 0x01;
+            break;
+
+        case 0xA4:
+        case 0xA5:
+            entire_on = op & 0x01;
+            break;
+
+        case 0xA6:
+        case 0xA7:
+            inverted = op & 0x01;
+            break;
+
+        case 0xA8:
+            // Ratios below 16 are invalid and ignored by the controller
+            if ((cmd[1] & 0x3F) >= 15)
+                mux_ratio = cmd[1] & 0x3F;
+            break;
+
+        case 0xAE:
+        case 0xAF:
+            display_on = op & 0x01;
+            break;
+
+        case 0xC0:
+        case 0xC8:
+            com_reversed = (op >> 3) & 0x01;
+            break;
+
+        case 0xD3:
+            display_offset = cmd[1] & 0x3F;
+            break;
+
+        case 0x8D:
+        case 0xD5:
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+        case 0xE3:
+        case 0xFD:
+            break;
+
+        default:
+            stats.unknown_cmds++;
+    }
+}
+
+
+/// @brief Receive one byte of display RAM data at the current address
+void oled_sim_controller::data(uint8_t value)
+{
+    stats.data_bytes++;
+    ram[page][col] = value;
+    advance();
+}
+
+
+/// @brief Move to the next RAM address the way the current addressing mode does
+void oled_sim_controller::advance()
+{
+    switch (addr_mode)
+    {
+        case 0:     // horizontal, across the window then down a page
+            if (++col > col_end)
+            {
+                col = col_start;
+
+                if (++page > page_end)
+                    page = page_start;
+            }
+            break;
+
+        case 1:     // vertical, down the window then across a column
+            if (++page > page_end)
+            {
+                page = page_start;
+
+                if (++col > col_end)
+                    col = col_start;
+            }
+            break;
+
+        default:    // page, the page doesn't change
+            if (++col >= OLED_SIM_COLUMNS)
+                col = page_col_start;
+    }
+}
+
+
+/// @brief Receive a list of command bytes as one transfer
+void oled_sim_controller::receive_commands(const uint8_t *cmds, size_t length)
+{
+    stats.transactions++;
+    stats.bus_bytes += length;
+
+    for (size_t i = 0; i < length; i++)
+        command(cmds[i]);
+}
+
+
+/// @brief Receive display RAM data as one transfer
+void oled_sim_controller::receive_data(const uint8_t *data_bytes, size_t length)
+{
+    stats.transactions++;
+    stats.bus_bytes += length;
+
+    for (size_t i = 0; i < length; i++)
+        data(data_bytes[i]);
+}
+
+
+/// @brief Receive an I2C write transaction. The control bytes decide whether following bytes are commands or data.
+/// @param addr address byte sent with the transaction
+/// @param bytes bytes following the address
+/// @param length number of bytes
+/// @return false if the transaction wasn't addressed to this controller
+bool oled_sim_controller::receive_i2c(uint8_t addr, const uint8_t *bytes, size_t length)
+{
+    if (addr != i2c_address)
+        return false;
+
+    stats.transactions++;
+    stats.bus_bytes += length + 1;
+
+    size_t i = 0;
+
+    while (i < length)
+    {
+        uint8_t control = bytes[i++];
+        bool is_data = control & 0x40;
+
+        // Co = 1 => one byte follows, then another control byte
+        size_t count = (control & 0x80) ? 1 : length - i;
+
+        for (size_t end = i + count; i < end && i < length; i++)
+        {
+            if (is_data)
+                data(bytes[i]);
+            else
+                command(bytes[i]);
+        }
+    }
+
+    return true;
+}
+
+
+bool oled_sim_controller::i2c_handler(void *context, uint8_t addr, const uint8_t *src, size_t len)
+{
+    return ((oled_sim_controller *) context)->receive_i2c(addr, src, len);
+}
+
+
+void oled_sim_controller::spi_handler(void *context, bool data, const uint8_t *src, size_t len)
+{
+    oled_sim_controller *sim = (oled_sim_controller *) context;
+
+    if (data)
+        sim->receive_data(src, len);
+    else
+        sim->receive_commands(src, len);
+}
+
+
+/// @brief Receive everything written to an I2C block at an address, including by oled_i2c_transport
+/// @param i2c_instance I2C block the simulated display is connected to
+/// @param address address the transport sends, with the read/write bit clear
+void oled_sim_controller::attach_i2c(i2c_inst_t *i2c_instance, uint8_t address)
+{
+    if (i2c != NULL)
+        host_i2c_remove_handler(i2c, this);
+
+    i2c = i2c_instance;
+    i2c_address = address;
+    host_i2c_add_handler(i2c, i2c_handler, this);
+}
+
+
+/// @brief Receive everything written to an SPI block, including by oled_spi_transport
+/// @param spi_instance SPI block the simulated display is connected to
+/// @param dc_pin GPIO connected to the display's D/C pin
+void oled_sim_controller::attach_spi(spi_inst_t *spi_instance, uint8_t dc_pin)
+{
+    host_spi_set_handler(spi_instance, dc_pin, spi_handler, this);
+}
+
+
+/// @brief Check whether a pixel is lit, taking the display settings into account
+/// @param x column on the panel, 0 is the left
+/// @param y row on the panel, 0 is the top
+bool oled_sim_controller::get_pixel(uint8_t x, uint8_t y)
+{
+    if (!display_on || x >= OLED_SIM_COLUMNS || y > mux_ratio)
+        return false;
+
+    if (entire_on)
+        return true;
+
+    // The panel is mounted rotated, so the remapped segment and COM order give an upright image
+    uint8_t column = seg_remap ? x : (OLED_SIM_COLUMNS - 1 - x);
+    uint8_t row = com_reversed ? y : (mux_ratio - y);
+    uint8_t line = (row + start_line + display_offset) & 0x3F;
+
+    bool lit = (ram[line / OLED_PAGE_HEIGHT][column] >> (line % OLED_PAGE_HEIGHT)) & 0x01;
+
+    return lit != (bool) inverted;
+}
+
+
+/// @brief Save the panel as a binary PBM image. Lit pixels are white.
+/// @return false if the file couldn't be written
+bool oled_sim_controller::save_pbm(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL)
+        return false;
+
+    fprintf(file, "P4\n%u %u\n", panel_width, panel_height);
+
+    for (uint8_t y = 0; y < panel_height; y++)
+    {
+        uint8_t bits = 0;
+
+        for (uint8_t x = 0; x < panel_width; x++)
+        {
+            // PBM 1 is black
+            bits = (bits << 1) | !get_pixel(x, y);
+
+            if ((x & 7) == 7)
+            {
+                fputc(bits, file);
+                bits = 0;
+            }
+        }
+
+        // Pad the last byte of the row
+        if (panel_width & 7)
+            fputc(bits << (8 - (panel_width & 7)), file);
+    }
+
+    return fclose(file) == 0;
+}
+
+
+static uint32_t png_crc(uint32_t crc, const uint8_t *bytes, size_t length)
+{
+    crc = ~crc;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= bytes[i];
+
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+
+    return ~crc;
+}
+
+
+static void png_put32(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+
+static void png_chunk(FILE *file, const char *type, const std::vector<uint8_t> &body)
+{
+    std::vector<uint8_t> chunk;
+    png_put32(chunk, body.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), body.begin(), body.end());
+
+    // The CRC covers the type and body
+    png_put32(chunk, png_crc(0, &chunk[4], chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+
+/// @brief Save the panel as a greyscale PNG image. Lit pixels are white.
+/// @param scale size of each display pixel in the image
+/// @return false if the file couldn't be written
+bool oled_sim_controller::save_png(const char *path, uint8_t scale)
+{
+    if (scale == 0)
+        scale = 1;
+
+    uint32_t width = panel_width * scale;
+    uint32_t height = panel_height * scale;
+
+    // Scanlines, each starting with filter type 0
+    std::vector<uint8_t> pixels;
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        pixels.push_back(0);
+
+        for (uint32_t x = 0; x < width; x++)
+            pixels.push_back(get_pixel(x / scale, y / scale) ? 0xFF : 0x00);
+    }
+
+    // zlib stream of uncompressed deflate blocks
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    size_t pos = 0;
+
+    do
+    {
+        size_t block = pixels.size() - pos;
+
+        if (block > 0xFFFF)
+            block = 0xFFFF;
+
+        idat.push_back(pos + block == pixels.size());   // final block flag
+        idat.push_back(block);
+        idat.push_back(block >> 8);
+        idat.push_back(~block);
+        idat.push_back(~block >> 8);
+        idat.insert(idat.end(), pixels.begin() + pos, pixels.begin() + pos + block);
+        pos += block;
+    }
+    while (pos < pixels.size());
+
+    uint32_t adler_a = 1, adler_b = 0;
+
+    for (uint8_t byte : pixels)
+    {
+        adler_a = (adler_a + byte) % 65521;
+        adler_b = (adler_b + adler_a) % 65521;
+    }
+
+    png_put32(idat, (adler_b << 16) | adler_a);
+
+    std::vector<uint8_t> ihdr;
+    png_put32(ihdr, width);
+    png_put32(ihdr, height);
+    ihdr.push_back(8);      // bit depth
+    ihdr.push_back(0);      // greyscale
+    ihdr.push_back(0);      // deflate
+    ihdr.push_back(0);      // adaptive filtering
+    ihdr.push_back(0);      // not interlaced
+
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL)
+        return false;
+
+    const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), file);
+    png_chunk(file, "IHDR", ihdr);
+    png_chunk(file, "IDAT", idat);
+    png_chunk(file, "IEND", std::vector<uint8_t>());
+
+    return fclose(file) == 0;
+}
+
+
+
+void oled_sim_transport::write_cmd(const uint8_t *cmds, uint16_t length)
+{
+    sim->receive_commands(cmds, length);
+}
+
+
+void oled_sim_transport::write_data(uint8_t *buf, uint16_t length)
+{
+    sim->receive_data(buf + 1, length);
+}
+
+
+bool oled_sim_transport::write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear)
+{
+    for (uint16_t row = 0; row < rows; row++)
+    {
+        sim->receive_data(data + row*stride, width);
+
+        if (clear)
+            memset(data + row*stride, 0, width);
+    }
+
+    return true;
+}
+
+
+/// @brief Create a recording transport
+/// @param background_transfers accept write_data_async(), otherwise it returns false like a blocking transport
+oled_record_transport::oled_record_transport(bool background_transfers)
+{
+    background = background_transfers;
+    hold = false;
+    in_flight.store(false);
+}
+
+
+void oled_record_transport::add(uint8_t kind, const uint8_t *bytes, size_t length)
+{
+    oled_record_call call;
+    call.kind = kind;
+    call.bytes.assign(bytes, bytes + length);
+    calls.push_back(call);
+}
+
+
+void oled_record_transport::write_cmd(const uint8_t *cmds, uint16_t length)
+{
+    wait();
+    add(OLED_RECORD_CMD, cmds, length);
+}
+
+
+void oled_record_transport::write_data(uint8_t *buf, uint16_t length)
+{
+    wait();
+
+    // The I2C transport puts its control byte here
+    buf[0] = 0x40;
+    add(OLED_RECORD_DATA, buf + 1, length);
+}
+
+
+bool oled_record_transport::write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear)
+{
+    if (!background)
+        return false;
+
+    wait();
+    front_buffer.clear();
+
+    for (uint16_t row = 0; row < rows; row++)
+    {
+        front_buffer.insert(front_buffer.end(), data + row*stride, data + row*stride + width);
+
+        if (clear)
+            memset(data + row*stride, 0, width);
+    }
+
+    if (!hold)
+    {
+        add(OLED_RECORD_ASYNC, front_buffer.data(), front_buffer.size());
+        return true;
+    }
+
+    in_flight.store(true);
+    return true;
+}
+
+
+bool oled_record_transport::busy()
+{
+    return in_flight.load();
+}
+
+
+void oled_record_transport::wait()
+{
+    while (in_flight.load())
+        sleep_us(10);
+}
+
+
+/// @brief Finish a held background transfer, recording its rows. Safe to call from another thread
+///        while the transport's user is waiting for it.
+void oled_record_transport::release()
+{
+    if (!in_flight.load())
+        return;
+
+    add(OLED_RECORD_ASYNC, front_buffer.data(), front_buffer.size());
+    in_flight.store(false);
+}
@@ -0,0 +1,175 @@
+/**
+ *  oled-sim.hpp
+ *  Simulated SSD1306/SSD1309 controller for host builds. Decodes the command and data bytes a display would
+ *  receive into a virtual display RAM, which can be inspected or saved as an image.
+ */
+#ifndef _OLED_SIM_H_
+#define _OLED_SIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+#include "pico-oled.hpp"
+#include "oled-transport.hpp"
+
+
+#define OLED_SIM_COLUMNS 128   // Display RAM size of both controllers
+#define OLED_SIM_PAGES 8
+
+#define OLED_RECORD_CMD 0      // write_cmd()
+#define OLED_RECORD_DATA 1     // write_data()
+#define OLED_RECORD_ASYNC 2    // Rows sent by write_data_async(), recorded when the transfer finishes
+
+
+/// @brief Bytes received by a simulated controller
+struct oled_sim_stats
+{
+    uint32_t transactions;      // I2C transactions or transport calls
+    uint32_t bus_bytes;         // Bytes on the bus, including I2C address and control bytes
+    uint32_t cmd_bytes;         // Command bytes, including arguments
+    uint32_t data_bytes;        // Bytes written to display RAM
+    uint32_t unknown_cmds;      // Commands the simulator doesn't recognise
+};
+
+
+/// @brief Simulated controller. Starts in the controller's reset state, with display RAM cleared.
+///        Images are drawn as seen on the usual modules, which are mounted so that segment re-map plus reversed
+///        COM scan (the settings oled_init() uses) puts column 0 of page 0 at the top left.
+///        Scrolling and the COM pin configuration are accepted but not simulated.
+class oled_sim_controller
+{
+    private:
+        OLED_type controller;
+        uint8_t panel_width;
+        uint8_t panel_height;
+        uint8_t i2c_address;
+        i2c_inst_t *i2c;
+
+        uint8_t ram[OLED_SIM_PAGES][OLED_SIM_COLUMNS];
+
+        // Multi-byte command being received
+        uint8_t cmd_buf[8];
+        uint8_t cmd_length;
+        uint8_t cmd_expected;
+
+        // Addressing
+        uint8_t addr_mode;      // 0 horizontal, 1 vertical, 2 page
+        uint8_t col_start, col_end, page_start, page_end;
+        uint8_t page_col_start; // Column start address for page addressing mode
+        uint8_t col, page;
+
+        // Display settings
+        uint8_t seg_remap;
+        uint8_t com_reversed;
+        uint8_t start_line;
+        uint8_t display_offset;
+        uint8_t mux_ratio;
+        uint8_t contrast;
+        uint8_t display_on;
+        uint8_t entire_on;
+        uint8_t inverted;
+        uint8_t scrolling;
+
+        oled_sim_stats stats;
+
+        uint8_t arg_count(uint8_t cmd);
+        void execute(const uint8_t *cmd);
+        void advance();
+
+        static bool i2c_handler(void *context, uint8_t addr, const uint8_t *src, size_t len);
+        static void spi_handler(void *context, bool data, const uint8_t *src, size_t len);
+
+    public:
+        oled_sim_controller(OLED_type controller_ic, uint8_t screen_width, uint8_t screen_height);
+        ~oled_sim_controller();
+
+        void reset();
+        void command(uint8_t cmd);
+        void data(uint8_t value);
+        void receive_commands(const uint8_t *cmds, size_t length);
+        void receive_data(const uint8_t *data, size_t length);
+        bool receive_i2c(uint8_t addr, const uint8_t *bytes, size_t length);
+
+        void attach_i2c(i2c_inst_t *i2c_instance, uint8_t address);
+        void attach_spi(spi_inst_t *spi_instance, uint8_t dc_pin);
+
+        /// @brief Byte of display RAM
+        uint8_t get_ram(uint8_t column, uint8_t ram_page) { return ram[ram_page][column]; }
+
+        bool get_pixel(uint8_t x, uint8_t y);
+        bool save_pbm(const char *path);
+        bool save_png(const char *path, uint8_t scale=1);
+
+        /// @brief Contrast setting, 0 to 255
+        uint8_t get_contrast() { return contrast; }
+
+        /// @brief True if the display has been turned on
+        bool is_on() { return display_on; }
+
+        /// @brief Bytes received so far
+        oled_sim_stats get_stats() { return stats; }
+
+        void reset_stats();
+};
+
+
+/// @brief Transport that hands bytes straight to a simulated controller, without bus framing.
+///        Background transfers complete before write_data_async() returns.
+class oled_sim_transport : public oled_transport
+{
+    private:
+        oled_sim_controller *sim;
+
+    public:
+        oled_sim_transport(oled_sim_controller *controller) { sim = controller; }
+        void write_cmd(const uint8_t *cmds, uint16_t length);
+        void write_data(uint8_t *buf, uint16_t length);
+        bool write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear=false);
+};
+
+
+/// @brief One call made to an oled_record_transport
+struct oled_record_call
+{
+    uint8_t kind;                   // OLED_RECORD_CMD, OLED_RECORD_DATA or OLED_RECORD_ASYNC
+    std::vector<uint8_t> bytes;     // Command or data bytes, without the header byte
+};
+
+
+/// @brief Transport that records every call it gets, to check the exact bytes pico_oled sends.
+///        Like the I2C transport it writes a control byte over the header byte lent to write_data().
+///        With background transfers turned on, write_data_async() copies the rows and, if transfers are held,
+///        stays busy until release() is called, e.g. from another thread. Every call waits for a held transfer
+///        to finish first, as the real transports do.
+class oled_record_transport : public oled_transport
+{
+    private:
+        bool background;
+        bool hold;
+        std::atomic<bool> in_flight;
+        std::vector<uint8_t> front_buffer;
+        std::vector<oled_record_call> calls;
+
+        void add(uint8_t kind, const uint8_t *bytes, size_t length);
+
+    public:
+        oled_record_transport(bool background_transfers=false);
+        void write_cmd(const uint8_t *cmds, uint16_t length);
+        void write_data(uint8_t *buf, uint16_t length);
+        bool write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear=false);
+        bool busy();
+        void wait();
+
+        /// @brief Keep background transfers busy until release() is called
+        void set_hold(bool hold_transfers) { hold = hold_transfers; }
+        void release();
+
+        /// @brief Calls recorded so far, in the order they were made
+        const std::vector<oled_record_call> &get_calls() { return calls; }
+
+        /// @brief Forget the calls recorded so far
+        void clear_calls() { calls.clear(); }
+};
+
+#endif
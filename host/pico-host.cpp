@@ -0,0 +1,620 @@
+/**
+ *  pico-host.cpp
+ *  Host implementations of the Pico SDK functions declared in host/include
+ */
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <vector>
+
+
+// GPIO, only output levels are tracked
+
+static bool gpio_level[NUM_BANK0_GPIOS];
+
+void gpio_init(uint gpio) { gpio_level[gpio] = 0; }
+void gpio_set_dir(uint gpio, bool out) {}
+void gpio_put(uint gpio, bool value) { gpio_level[gpio] = value; }
+bool gpio_get(uint gpio) { return gpio_level[gpio]; }
+void gpio_set_function(uint gpio, enum gpio_function fn) {}
+void gpio_pull_up(uint gpio) {}
+
+
+// Time
+
+static const std::chrono::steady_clock::time_point boot_time = std::chrono::steady_clock::now();
+
+uint64_t time_us_64()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot_time).count();
+}
+
+uint32_t time_us_32() { return (uint32_t) time_us_64(); }
+absolute_time_t get_absolute_time() { return time_us_64(); }
+void sleep_us(uint64_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+void sleep_ms(uint32_t ms) { sleep_us((uint64_t) ms * 1000); }
+
+void sleep_until(absolute_time_t target)
+{
+    absolute_time_t now = get_absolute_time();
+
+    if (target > now)
+        sleep_us(target - now);
+}
+
+
+static thread_local uint host_core_num = 0;
+
+uint get_core_num() { return host_core_num; }
+void host_set_core_num(uint core) { host_core_num = core; }
+
+
+void panic(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fputs("*** PANIC ***\n", stderr);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    abort();
+}
+
+
+
+// I2C, each complete transaction is passed to every handler on the bus until one acknowledges it
+
+#define HOST_I2C_HANDLERS_MAX 4
+
+struct host_i2c_bus
+{
+    host_i2c_handler handlers[HOST_I2C_HANDLERS_MAX];
+    void *contexts[HOST_I2C_HANDLERS_MAX];
+    uint8_t handler_count;
+    std::vector<uint8_t> pending;   // Bytes written to the data/command register since the last stop
+    bool hold;                      // Stop conditions wait for host_i2c_release()
+    std::atomic<bool> stop_held;    // A stop condition is waiting for host_i2c_release()
+};
+
+static i2c_hw_t i2c_hw[NUM_I2CS];
+static host_i2c_bus i2c_bus[NUM_I2CS];
+
+i2c_inst_t i2c0_inst = {&i2c_hw[0], 0};
+i2c_inst_t i2c1_inst = {&i2c_hw[1], 1};
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) { return baudrate; }
+
+
+void host_i2c_add_handler(i2c_inst_t *i2c, host_i2c_handler handler, void *context)
+{
+    host_i2c_bus *bus = &i2c_bus[i2c->index];
+
+    if (bus->handler_count >= HOST_I2C_HANDLERS_MAX)
+        panic("host_i2c_add_handler: too many devices on i2c%u", i2c->index);
+
+    bus->handlers[bus->handler_count] = handler;
+    bus->contexts[bus->handler_count] = context;
+    bus->handler_count++;
+}
+
+
+void host_i2c_remove_handler(i2c_inst_t *i2c, void *context)
+{
+    host_i2c_bus *bus = &i2c_bus[i2c->index];
+
+    for (uint8_t i = 0; i < bus->handler_count; i++)
+    {
+        if (bus->contexts[i] != context)
+            continue;
+
+        bus->handler_count--;
+        bus->handlers[i] = bus->handlers[bus->handler_count];
+        bus->contexts[i] = bus->contexts[bus->handler_count];
+        return;
+    }
+}
+
+
+void host_i2c_hold(i2c_inst_t *i2c, bool hold)
+{
+    i2c_bus[i2c->index].hold = hold;
+}
+
+
+/// @brief Let a held stop condition be detected. Safe to call from another thread while a transport waits for it.
+void host_i2c_release(i2c_inst_t *i2c)
+{
+    host_i2c_bus *bus = &i2c_bus[i2c->index];
+
+    if (bus->stop_held.exchange(false))
+        i2c_hw[i2c->index].raw_intr_stat |= I2C_IC_RAW_INTR_STAT_STOP_DET_BITS;
+}
+
+
+static bool i2c_dispatch(uint index, uint8_t addr, const uint8_t *src, size_t len)
+{
+    host_i2c_bus *bus = &i2c_bus[index];
+
+    for (uint8_t i = 0; i < bus->handler_count; i++)
+    {
+        if (bus->handlers[i](bus->contexts[i], addr, src, len))
+            return true;
+    }
+
+    return false;
+}
+
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    if (!i2c_dispatch(i2c->index, addr, src, len))
+        return PICO_ERROR_GENERIC;
+
+    return (int) len;
+}
+
+
+/// @brief A word written to an I2C data/command register, e.g. by DMA
+/// @return false if the word wasn't taken because nothing acknowledged the transaction
+static bool i2c_data_cmd_write(uint index, uint32_t value)
+{
+    host_i2c_bus *bus = &i2c_bus[index];
+    i2c_hw_t *hw = &i2c_hw[index];
+
+    // Reads of the clear registers can't be seen here, so the flags of the last transaction are cleared when the
+    // next one starts, as they are by a driver that reads clr_stop_det and clr_tx_abrt before each transfer
+    if (bus->pending.empty())
+        hw->raw_intr_stat &= ~(I2C_IC_RAW_INTR_STAT_STOP_DET_BITS | I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS);
+
+    bus->pending.push_back((uint8_t) value);
+
+    if (!(value & I2C_IC_DATA_CMD_STOP_BITS))
+        return true;
+
+    bool acknowledged = i2c_dispatch(index, (uint8_t) hw->tar, bus->pending.data(), bus->pending.size());
+    bus->pending.clear();
+
+    // A NACK aborts the transaction and the TX FIFO stops taking data, without a stop condition being detected.
+    // The transaction is only seen as a whole, so the last word is the one left waiting
+    if (!acknowledged)
+    {
+        hw->raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+        return false;
+    }
+
+    if (bus->hold)
+        bus->stop_held.store(true);
+    else
+        hw->raw_intr_stat |= I2C_IC_RAW_INTR_STAT_STOP_DET_BITS;
+
+    return true;
+}
+
+
+
+// SPI
+
+struct host_spi_bus
+{
+    host_spi_handler handler;
+    void *context;
+    uint dc_gpio;
+};
+
+static spi_hw_t spi_hw[2];
+static host_spi_bus spi_bus[2];
+
+spi_inst_t spi0_inst = {&spi_hw[0], 0};
+spi_inst_t spi1_inst = {&spi_hw[1], 1};
+
+uint spi_init(spi_inst_t *spi, uint baudrate) { return baudrate; }
+
+
+void host_spi_set_handler(spi_inst_t *spi, uint dc_gpio, host_spi_handler handler, void *context)
+{
+    spi_bus[spi->index].handler = handler;
+    spi_bus[spi->index].context = context;
+    spi_bus[spi->index].dc_gpio = dc_gpio;
+}
+
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+    host_spi_bus *bus = &spi_bus[spi->index];
+
+    if (bus->handler != NULL)
+        bus->handler(bus->context, gpio_get(bus->dc_gpio), src, len);
+
+    return (int) len;
+}
+
+
+
+// PIO, a state machine runs from each write to its TX FIFO until it stalls
+
+#define PIO_TX_FIFO_DEPTH 8         // Joined TX FIFO
+#define PIO_MAX_STEPS (1u << 24)    // A program that never stalls is a bug in the program
+
+struct host_pio_sm
+{
+    bool claimed;
+    bool enabled;
+    bool stalled;
+    pio_sm_config config;
+    uint8_t pc;
+    uint32_t osr;
+    uint8_t osr_count;          // Bits shifted out of the OSR, it is empty at the pull threshold
+    uint32_t pins;              // Levels driven by OUT and side-set
+    std::deque<uint32_t> fifo;
+};
+
+struct host_pio_block
+{
+    uint16_t instructions[PIO_INSTRUCTION_COUNT];
+    uint32_t used;              // Bit n set when instruction n is taken by a program
+    host_pio_sm sm[NUM_PIO_STATE_MACHINES];
+    host_pio_handler handler;
+    void *context;
+};
+
+pio_hw_t host_pio_hw[NUM_PIOS];
+static host_pio_block pio_block[NUM_PIOS];
+
+
+pio_sm_config pio_get_default_sm_config()
+{
+    pio_sm_config config = {};
+    config.wrap = PIO_INSTRUCTION_COUNT - 1;
+    config.out_count = 32;
+    config.shift_right = true;
+    config.pull_threshold = 32;
+    config.clkdiv = 1.0f;
+    return config;
+}
+
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+    host_pio_block *block = &pio_block[pio_get_index(pio)];
+    uint32_t mask = (program->length < 32) ? (1u << program->length) - 1 : 0xFFFFFFFF;
+
+    for (uint offset = 0; offset + program->length <= PIO_INSTRUCTION_COUNT; offset++)
+    {
+        if ((program->origin >= 0 && offset != (uint) program->origin) || (block->used & (mask << offset)))
+            continue;
+
+        for (uint i = 0; i < program->length; i++)
+        {
+            uint16_t instr = program->instructions[i];
+
+            // JMP targets are relative to the start of the program
+            if ((instr & 0xE000) == 0)
+                instr += offset;
+
+            block->instructions[offset + i] = instr;
+        }
+
+        block->used |= mask << offset;
+        return offset;
+    }
+
+    panic("No program space");
+    return 0;
+}
+
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset)
+{
+    uint32_t mask = (program->length < 32) ? (1u << program->length) - 1 : 0xFFFFFFFF;
+    pio_block[pio_get_index(pio)].used &= ~(mask << loaded_offset);
+}
+
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+    host_pio_block *block = &pio_block[pio_get_index(pio)];
+
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++)
+    {
+        if (!block->sm[sm].claimed)
+        {
+            block->sm[sm].claimed = true;
+            return sm;
+        }
+    }
+
+    if (required)
+        panic("No PIO state machines are available");
+
+    return -1;
+}
+
+
+void pio_sm_unclaim(PIO pio, uint sm) { pio_block[pio_get_index(pio)].sm[sm].claimed = false; }
+void pio_gpio_init(PIO pio, uint pin) {}
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask) {}
+
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask)
+{
+    host_pio_sm *state = &pio_block[pio_get_index(pio)].sm[sm];
+    state->pins = (state->pins & ~pin_mask) | (pin_values & pin_mask);
+}
+
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+    host_pio_sm *state = &pio_block[pio_get_index(pio)].sm[sm];
+
+    state->enabled = false;
+    state->stalled = false;
+    state->config = *config;
+    state->pc = initial_pc;
+    state->osr = 0;
+    state->osr_count = config->pull_threshold;
+    state->fifo.clear();
+}
+
+
+void host_pio_set_handler(PIO pio, host_pio_handler handler, void *context)
+{
+    pio_block[pio_get_index(pio)].handler = handler;
+    pio_block[pio_get_index(pio)].context = context;
+}
+
+
+/// @brief Run one instruction
+/// @return false if the state machine stalled on it
+static bool pio_step(uint index, uint sm)
+{
+    host_pio_block *block = &pio_block[index];
+    host_pio_sm *state = &block->sm[sm];
+    const pio_sm_config *config = &state->config;
+    uint16_t instr = block->instructions[state->pc];
+
+    // Side-set bits are the top of the delay/side-set field, with an optional side-set's enable bit above them.
+    // Side-set takes effect even if the instruction stalls
+    uint8_t field = (instr >> 8) & 0x1F;
+    uint8_t delay_bits = 5 - config->sideset_bit_count;
+    uint8_t delay = field & ((1u << delay_bits) - 1);
+    uint8_t side_bits = config->sideset_bit_count - (config->sideset_optional ? 1 : 0);
+    bool side_enable = !config->sideset_optional || (field & 0x10);
+
+    if (side_bits > 0 && side_enable)
+    {
+        uint32_t side = (field >> delay_bits) & ((1u << side_bits) - 1);
+        uint32_t mask = ((1u << side_bits) - 1) << config->sideset_base;
+        state->pins = (state->pins & ~mask) | (side << config->sideset_base);
+    }
+
+    switch (instr >> 13)
+    {
+        case 3:     // OUT
+        {
+            uint8_t dest = (instr >> 5) & 7;
+            uint8_t count = (instr & 0x1F) ? (instr & 0x1F) : 32;
+
+            if (dest != 0)
+                panic("host PIO: instruction 0x%04x isn't emulated", instr);
+
+            if (config->autopull && state->osr_count >= config->pull_threshold)
+            {
+                if (state->fifo.empty())
+                {
+                    host_pio_hw[index].fdebug |= 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+
+                    if (!state->stalled && block->handler != NULL)
+                        block->handler(block->context, sm, state->pins, true);
+
+                    state->stalled = true;
+                    return false;
+                }
+
+                state->osr = state->fifo.front();
+                state->osr_count = 0;
+                state->fifo.pop_front();
+            }
+
+            uint32_t data;
+
+            if (config->shift_right)
+            {
+                data = (count < 32) ? state->osr & ((1u << count) - 1) : state->osr;
+                state->osr = (count < 32) ? state->osr >> count : 0;
+            }
+            else
+            {
+                data = state->osr >> (32 - count);
+                state->osr = (count < 32) ? state->osr << count : 0;
+            }
+
+            state->osr_count = (state->osr_count + count < 32) ? state->osr_count + count : 32;
+
+            uint32_t mask = ((config->out_count < 32) ? (1u << config->out_count) - 1 : 0xFFFFFFFF) << config->out_base;
+            state->pins = (state->pins & ~mask) | ((data << config->out_base) & mask);
+            break;
+        }
+
+        case 5:     // MOV, only MOV Y, Y (nop)
+            if ((instr & 0xE0FF) != 0xA042)
+                panic("host PIO: instruction 0x%04x isn't emulated", instr);
+            break;
+
+        default:
+            panic("host PIO: instruction 0x%04x isn't emulated", instr);
+    }
+
+    state->stalled = false;
+    state->pc = (state->pc == config->wrap) ? config->wrap_target : state->pc + 1;
+
+    if (block->handler != NULL)
+    {
+        for (uint cycle = 0; cycle <= delay; cycle++)
+            block->handler(block->context, sm, state->pins, false);
+    }
+
+    return true;
+}
+
+
+/// @brief Run a state machine until it stalls
+static void pio_run(uint index, uint sm)
+{
+    if (!pio_block[index].sm[sm].enabled)
+        return;
+
+    for (uint32_t steps = 0; steps < PIO_MAX_STEPS; steps++)
+    {
+        if (!pio_step(index, sm))
+            return;
+    }
+
+    panic("host PIO: state machine %u never stalled", sm);
+}
+
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+    pio_block[pio_get_index(pio)].sm[sm].enabled = enabled;
+
+    if (enabled)
+        pio_run(pio_get_index(pio), sm);
+}
+
+
+/// @brief Put a word in a state machine's TX FIFO and run the state machine on it
+static void pio_fifo_push(uint index, uint sm, uint32_t data)
+{
+    host_pio_sm *state = &pio_block[index].sm[sm];
+
+    // Nothing would ever empty the FIFO of a stopped state machine
+    if (state->fifo.size() >= PIO_TX_FIFO_DEPTH)
+        panic("host PIO: TX FIFO of stopped state machine %u is full", sm);
+
+    state->fifo.push_back(data);
+    pio_run(index, sm);
+}
+
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) { pio_fifo_push(pio_get_index(pio), sm, data); }
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) { return pio_block[pio_get_index(pio)].sm[sm].fifo.empty(); }
+
+
+
+// DMA, transfers run to completion when triggered unless the destination stops taking data, which leaves the
+// channel busy until it is aborted
+
+static bool dma_claimed[NUM_DMA_CHANNELS];
+static bool dma_stalled[NUM_DMA_CHANNELS];
+
+int dma_claim_unused_channel(bool required)
+{
+    for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        if (!dma_claimed[channel])
+        {
+            dma_claimed[channel] = true;
+            return channel;
+        }
+    }
+
+    if (required)
+        panic("No DMA channels are available");
+
+    return -1;
+}
+
+
+void dma_channel_unclaim(uint channel) { dma_claimed[channel] = false; }
+void dma_channel_abort(uint channel) { dma_stalled[channel] = false; }
+bool dma_channel_is_busy(uint channel) { return dma_stalled[channel]; }
+
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    dma_channel_config config = {DMA_SIZE_32, true, false, 0x3f};
+    return config;
+}
+
+
+/// @brief Write one transfer to its destination, passing writes to peripheral data registers on to the peripheral
+/// @return false if the peripheral didn't take the data
+static bool dma_bus_write(volatile void *addr, uint32_t value, uint8_t bytes)
+{
+    for (uint index = 0; index < NUM_I2CS; index++)
+    {
+        if (addr == &i2c_hw[index].data_cmd)
+            return i2c_data_cmd_write(index, value);
+    }
+
+    for (uint index = 0; index < 2; index++)
+    {
+        if (addr == &spi_hw[index].dr)
+        {
+            uint8_t byte = (uint8_t) value;
+            spi_write_blocking(index ? spi1 : spi0, &byte, 1);
+            return true;
+        }
+    }
+
+    for (uint index = 0; index < NUM_PIOS; index++)
+    {
+        for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++)
+        {
+            if (addr == &host_pio_hw[index].txf[sm])
+            {
+                // Narrow writes to a FIFO are replicated across the word, as on the bus
+                if (bytes == 1)
+                    value = (value & 0xFF) * 0x01010101;
+                else if (bytes == 2)
+                    value = (value & 0xFFFF) * 0x00010001;
+
+                pio_fifo_push(index, sm, value);
+                return true;
+            }
+        }
+    }
+
+    memcpy((void *) addr, &value, bytes);
+    return true;
+}
+
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    if (!trigger)
+        return;
+
+    if (dma_stalled[channel])
+        panic("dma_channel_configure: channel %u is still busy", channel);
+
+    uint8_t bytes = 1 << config->size;
+    const volatile uint8_t *src = (const volatile uint8_t *) read_addr;
+    volatile uint8_t *dst = (volatile uint8_t *) write_addr;
+
+    for (uint i = 0; i < transfer_count; i++)
+    {
+        uint32_t value = 0;
+        memcpy(&value, (const void *) src, bytes);
+        if (!dma_bus_write(dst, value, bytes))
+        {
+            dma_stalled[channel] = true;
+            return;
+        }
+
+        if (config->read_increment)
+            src += bytes;
+
+        if (config->write_increment)
+            dst += bytes;
+    }
+}
@@ -0,0 +1,393 @@
+/**
+ *  sim-demo.cpp
+ *  Draws the demo screens on simulated displays, saves each frame as an image and reports the bytes sent.
+ *  One display uses the I2C transport and records frames in a display list, one is a compile-time sized display
+ *  on a direct transport in shadow update mode, one clears its buffer as it sends it and one is drawn a page at
+ *  a time. Their display RAM is compared after every frame.
+ *
+ *  Usage: oled_sim [output directory]
+ */
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+#include "../pico-oled.hpp"
+#include "../oled-sprite.hpp"
+#include "../gfx_font.h"
+#include "../font/press_start_2p.h"
+#include "../font/too_simple.h"
+#include "../font/Retron2000_packed.h"
+#include "../gfx-profile.hpp"
+#include "oled-sim.hpp"
+
+#include "bitmap/raspberry.h"
+#include "bitmap/thermometer_empty.h"
+#include "bitmap/thermometer_full.h"
+#include "bitmap/splash_packed.h"
+
+#define DISPLAY_I2C_ADDR _u(0x3C)
+#define DISPLAY_WIDTH _u(128)
+#define DISPLAY_HEIGHT _u(64)
+
+
+#define DISPLAY_COUNT 4
+
+static pico_oled *displays[DISPLAY_COUNT];
+static pico_oled *cleared_display;          // Sent with render_async_and_clear(), so it starts each frame cleared
+static pico_oled_paged *paged_display;      // Last display, drawn a page at a time
+static oled_sim_controller *sims[DISPLAY_COUNT];
+static const char *display_names[DISPLAY_COUNT] = {"i2c_list", "direct_shadow", "direct_cleared", "direct_paged"};
+static const char *output_dir;
+static uint16_t frame_count;
+static uint16_t mismatch_count;
+
+static const uint8_t min_y = 9;
+
+
+/// @brief Draw a frame on every display, send it, compare what they received and save the frame
+/// @param name frame name, used for the image file
+/// @param draw draws the frame on a canvas
+/// @param context passed to draw
+static void finish_frame(const char *name, oled_draw_fn draw, void *context=NULL)
+{
+    oled_sim_stats before[DISPLAY_COUNT];
+
+    for (uint8_t i = 0; i < DISPLAY_COUNT; i++)
+        before[i] = sims[i]->get_stats();
+
+    for (uint8_t i = 0; i < DISPLAY_COUNT - 1; i++)
+    {
+        if (displays[i] != cleared_display)
+            displays[i]->fill(0);
+
+        displays[i]->set_cursor(0, 0);
+
+        if (draw != NULL)
+            draw(displays[i], context);
+    }
+
+    // Background transfers on the I2C display, to cover the DMA path
+    displays[0]->render_async();
+    displays[0]->render_wait();
+    displays[1]->render();
+    cleared_display->render_async_and_clear();
+    cleared_display->render_wait();
+
+    paged_display->set_cursor(0, 0);
+
+    if (draw != NULL)
+        paged_display->render_pages(draw, context);
+
+    for (uint8_t i = 1; i < DISPLAY_COUNT; i++)
+    {
+        for (uint8_t page = 0; page < DISPLAY_HEIGHT / OLED_PAGE_HEIGHT; page++)
+        {
+            for (uint8_t column = 0; column < DISPLAY_WIDTH; column++)
+            {
+                if (sims[0]->get_ram(column, page) != sims[i]->get_ram(column, page))
+                {
+                    printf("# %s: %s display RAM differs at column %u page %u\n", name, display_names[i], column, page);
+                    mismatch_count++;
+                    page = DISPLAY_HEIGHT;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < DISPLAY_COUNT; i++)
+    {
+        oled_sim_stats after = sims[i]->get_stats();
+
+        printf("%s,%s,%u,%u,%u\n", name, display_names[i],
+            after.transactions - before[i].transactions,
+            after.bus_bytes - before[i].bus_bytes,
+            after.data_bytes - before[i].data_bytes);
+    }
+
+    if (output_dir != NULL)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%03u-%s.png", output_dir, frame_count, name);
+
+        if (!sims[0]->save_png(path, 4))
+            printf("# could not write %s\n", path);
+    }
+
+    frame_count++;
+}
+
+
+static void draw_text(oled_canvas *display, void *context)
+{
+    display->set_font(press_start_2p);
+    display->print("Text demo\n\n");
+    display->set_font(too_simple);
+    display->print("Font:\nToo Simple");
+    display->set_font(press_start_2p);
+    display->draw_boxed_text("Text Box\npad = 4px", 4, 0, 30, 36);
+}
+
+
+// Moving bitmap, mostly small changes. context is the animation step
+static void draw_bitmap(oled_canvas *display, void *context)
+{
+    uint8_t step = *(uint8_t *) context;
+
+    display->print("Bitmaps");
+    display->draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 10 + step*4, min_y + step*2);
+}
+
+
+static void draw_lines(oled_canvas *display, void *context)
+{
+    display->print("Lines");
+    display->draw_line(0, min_y, 70, 40);
+    display->draw_line(0, DISPLAY_HEIGHT - 1, 70, 40);
+    display->draw_line_dotted(DISPLAY_WIDTH - 1, min_y, 70, 40);
+    display->draw_box(80, 20, 120, 60);
+}
+
+
+static void draw_bars(oled_canvas *display, void *context)
+{
+    display->print("Bar Graphs");
+    display->draw_vbar(60, 0, min_y, 9, DISPLAY_HEIGHT - 1);
+    display->draw_bmp_vbar(60, thermometer_empty, thermometer_full, 12, min_y);
+    display->draw_hbar(60, false, 22, min_y, DISPLAY_WIDTH - 22, min_y + 10);
+    display->draw_hbar(60, true, 22, min_y + 12, DISPLAY_WIDTH - 22, min_y + 22);
+}
+
+
+static void draw_gauge(oled_canvas *display, void *context)
+{
+    analog_gauge gauge(display);
+    gauge.set_position(63, 63);
+    gauge.set_scale(/*scale_min=*/ 0, /*scale_max=*/ 100, /*scale_start_deg=*/ 220, /*scale_end_deg=*/ 320);
+    gauge.set_markers(/*scale_divisions=*/ 3, /*needle_len=*/ 45, /*marker_len=*/ 15, /*half_divisions=*/ 1);
+    gauge.set_value(70);
+
+    display->print("Analog Gauge\n");
+    gauge.draw();
+}
+
+
+// Draw modes: text cleared out of a filled box, an outline toggled across it, and a line toggled twice,
+// which erases it
+static void draw_modes(oled_canvas *display, void *context)
+{
+    display->print("Draw modes");
+    display->fill_rect(0, 20, 20, 107, 40);
+
+    display->set_draw_mode(OLED_OP_CLEAR);
+    display->set_cursor(32, 26);
+    display->print("Clear");
+
+    display->set_draw_mode(OLED_OP_INVERT);
+    display->draw_box(10, 15, 117, 45);
+    display->draw_line(0, 63, 127, 10);
+    display->draw_line(0, 63, 127, 10);
+    display->draw_line(0, 63, 127, 50);
+    display->draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 96, 30);
+
+    display->set_draw_mode(OLED_OP_SET);
+}
+
+
+// A list scrolled inside a clipped window, with a bitmap partly off the top left of the screen.
+// context holds the scroll position
+static void draw_scrolled(oled_canvas *display, void *context)
+{
+    int16_t scroll = *(int16_t *) context;
+
+    display->draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, -6, -9);
+    display->draw_box(20, 10, 107, 53);
+
+    display->set_clip_rect(21, 11, 106, 52);
+    display->set_origin(0, -scroll);
+
+    for (uint8_t row = 0; row < 8; row++)
+    {
+        display->set_cursor(24, 12 + row*10);
+        display->print_num("Item %u", row);
+        display->draw_line(22, 21 + row*10, 105, 21 + row*10);
+    }
+
+    display->set_origin(0, 0);
+    display->reset_clip_rect();
+}
+
+
+// Packed assets decoded as they are drawn: the start up screen scrolled partly off the top, with text toggled over it
+static void draw_packed_assets(oled_canvas *display, void *context)
+{
+    display->draw_packed(splash_packed, 0, -21);
+
+    display->set_draw_mode(OLED_OP_INVERT);
+    display->set_font(Retron2000_packed);
+    display->set_cursor(12, 34);
+    display->print("Packed");
+
+    display->set_draw_mode(OLED_OP_SET);
+    display->set_font(press_start_2p);
+}
+
+
+// Overlapping sprites: a row of icons, one toggled over them and one drawn on top of it. context holds the sprite list
+static void draw_sprites(oled_canvas *display, void *context)
+{
+    oled_sprite_list *sprites = (oled_sprite_list *) context;
+
+    display->print("Sprites");
+    sprites->draw(display);
+}
+
+
+// Masked icons over a busy background: the mask punches a hole in the stripes, so the icon's dark pixels show
+static void draw_overlay(oled_canvas *display, void *context)
+{
+    for (uint8_t y = min_y; y < DISPLAY_HEIGHT; y += 2)
+        display->draw_fast_hline(0, DISPLAY_WIDTH - 1, y);
+
+    display->draw_masked_bmp(raspberry_masked, 20, 20);
+    display->draw_masked_bmp(raspberry_masked, 56, 27);
+    display->draw_masked_bmp(raspberry_masked, 118, 50);
+}
+
+
+// Pre-rendered widgets, drawn several times per frame. context holds the label and dial canvases
+static void draw_canvases(oled_canvas *display, void *context)
+{
+    oled_canvas **widgets = (oled_canvas **) context;
+
+    display->draw_canvas(widgets[0], 0, 0);
+    display->draw_canvas(widgets[0], 40, 13);
+    display->draw_canvas(widgets[1], 10, 32);
+    display->draw_canvas(widgets[1], 70, 36);
+}
+
+
+int main(int argc, char **argv)
+{
+    output_dir = (argc > 1) ? argv[1] : NULL;
+
+    i2c_init(i2c_default, 1000 * 1000);
+
+    oled_sim_controller i2c_sim(OLED_SSD1309, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    i2c_sim.attach_i2c(i2c_default, DISPLAY_I2C_ADDR);
+
+    oled_sim_controller direct_sim(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_sim_transport direct_bus(&direct_sim);
+
+    oled_sim_controller cleared_sim(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_sim_transport cleared_bus(&cleared_sim);
+
+    oled_sim_controller paged_sim(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_sim_transport paged_bus(&paged_sim);
+
+    pico_oled i2c_display(OLED_SSD1309, DISPLAY_I2C_ADDR, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    static uint8_t list_memory[2048];
+    oled_display_list list(list_memory, sizeof(list_memory));
+    static pico_oled_static<DISPLAY_WIDTH, DISPLAY_HEIGHT, OLED_SSD1306> direct_display(&direct_bus);
+    direct_display.set_update_mode(OLED_UPDATE_SHADOW);
+
+    pico_oled cleared(OLED_SSD1306, &cleared_bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+
+    // One page strip, sending only the pages that changed
+    pico_oled_paged strip_display(OLED_SSD1306, &paged_bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    strip_display.set_update_mode(OLED_UPDATE_CHECKSUM);
+
+    displays[0] = &i2c_display;
+    displays[1] = &direct_display;
+    displays[2] = &cleared;
+    displays[3] = &strip_display;
+    cleared_display = &cleared;
+    paged_display = &strip_display;
+    sims[0] = &i2c_sim;
+    sims[1] = &direct_sim;
+    sims[2] = &cleared_sim;
+    sims[3] = &paged_sim;
+
+    printf("frame,display,transactions,bus_bytes,data_bytes\n");
+
+    for (uint8_t i = 0; i < DISPLAY_COUNT; i++)
+        displays[i]->oled_init();
+
+    i2c_display.set_display_list(&list);
+
+    finish_frame("init", NULL);
+    finish_frame("text", draw_text);
+
+    for (uint8_t step = 0; step < 8; step++)
+        finish_frame("bitmap", draw_bitmap, &step);
+
+    finish_frame("lines", draw_lines);
+    finish_frame("bars", draw_bars);
+    finish_frame("gauge", draw_gauge);
+
+    // Same frame again, which the display list doesn't draw or send
+    finish_frame("gauge", draw_gauge);
+
+    finish_frame("modes", draw_modes);
+
+    int16_t scroll = 0;
+    finish_frame("scroll", draw_scrolled, &scroll);
+
+    scroll = 17;
+    finish_frame("scroll", draw_scrolled, &scroll);
+
+    finish_frame("overlay", draw_overlay);
+    finish_frame("packed", draw_packed_assets);
+
+    static oled_sprite_image icon(raspberry.bitmap, raspberry.width, raspberry.height);
+    static oled_sprite sprite_memory[8];
+    oled_sprite_list sprites(sprite_memory, 8);
+
+    for (uint8_t i = 0; i < 6; i++)
+        sprites.add(&icon, i * 21, 12 + i * 3);
+
+    oled_sprite *top = sprites.add(&icon, 50, 40, 2);
+    oled_sprite *toggled = sprites.add(&icon, 44, 22, 1);
+    toggled->op = OLED_OP_INVERT;
+
+    finish_frame("sprites", draw_sprites, &sprites);
+
+    // Moving one sprite under another
+    toggled->x = 56;
+    sprites.set_depth(top, 0);
+    finish_frame("sprites", draw_sprites, &sprites);
+
+    static uint8_t canvas_memory[1024];
+    oled_canvas_pool pool(canvas_memory, sizeof(canvas_memory));
+    oled_canvas *widgets[2];
+    widgets[0] = pool.acquire(64, 10);
+    widgets[1] = pool.acquire(48, 24);
+
+    widgets[0]->set_font(too_simple);
+    widgets[0]->set_cursor(0, 0);
+    widgets[0]->print("Cached text");
+
+    analog_gauge dial_gauge(widgets[1]);
+    dial_gauge.set_position(23, 23);
+    dial_gauge.set_markers(/*scale_divisions=*/ 3, /*needle_len=*/ 20, /*marker_len=*/ 6, /*half_divisions=*/ 1);
+    dial_gauge.set_value(30);
+    dial_gauge.draw();
+
+    finish_frame("canvas", draw_canvases, widgets);
+
+    for (uint8_t i = 0; i < DISPLAY_COUNT; i++)
+    {
+        if (sims[i]->get_stats().unknown_cmds)
+        {
+            printf("# unknown commands were sent to %s\n", display_names[i]);
+            mismatch_count++;
+        }
+    }
+
+#ifdef GFX_PROFILE
+    gfx_profile_dump();
+#endif
+
+    return mismatch_count ? 1 : 0;
+}
@@ -0,0 +1,2145 @@
+/**
+ *  test.cpp
+ *  Checks the drawing primitives and what the library sends against reference versions on the host.
+ *  Prints a line for each check that fails, starting with '#', and returns non-zero if any did.
+ *
+ *  Usage: oled_test [check name]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pico/stdlib.h"
+
+#include "../pico-oled.hpp"
+#include "../oled-display-list.hpp"
+#include "../oled-sprite.hpp"
+#include "../oled-raster.hpp"
+#include "../oled-packed.hpp"
+#include "../oled-render-service.hpp"
+#include "../oled-frame-scheduler.hpp"
+#include "../oled-pio-transport.hpp"
+#include "../gfx-profile.hpp"
+#include "../gfx_font.h"
+#include "../font/press_start_2p.h"
+#include "../font/Retron2000.h"
+#include "../font/Retron2000_packed.h"
+#include "oled-sim.hpp"
+#include "legacy.hpp"
+
+#include "bitmap/raspberry.h"
+#include "bitmap/splash.h"
+#include "bitmap/splash_packed.h"
+#include "bitmap/raspberry_packed.h"
+
+#define DISPLAY_WIDTH LEGACY_WIDTH
+#define DISPLAY_HEIGHT LEGACY_HEIGHT
+
+#define TEST_TEXT "Pack my box with\nfive dozen liquor\njugs 0123456789"
+
+
+static oled_sim_controller sim(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+static oled_sim_transport sim_bus(&sim);
+static pico_oled display(OLED_SSD1306, &sim_bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+static analog_gauge gauge(&display);
+static oled_sprite_image raspberry_sprite(raspberry.bitmap, raspberry.width, raspberry.height);
+
+
+/// @brief Check fill_rect against the reference for every pair of rows and a spread of column ranges
+/// @return number of rectangles that came out different
+static uint32_t check_fill_rect()
+{
+    static const uint8_t columns[][2] = {{0, 127}, {3, 124}, {10, 12}, {5, 5}, {1, 8}, {120, 127}};
+    static uint8_t expected[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    uint32_t errors = 0;
+
+    for (uint8_t y1 = 0; y1 < DISPLAY_HEIGHT; y1++)
+    {
+        for (uint8_t y2 = y1; y2 < DISPLAY_HEIGHT; y2++)
+        {
+            for (uint8_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++)
+            {
+                for (uint8_t blank = 0; blank < 2; blank++)
+                {
+                    display.fill(0xA5);
+                    memcpy(expected, display.get_pixels(), sizeof(expected));
+
+                    legacy_fill_rect(expected, blank, columns[i][0], y1, columns[i][1], y2);
+                    display.fill_rect(blank, columns[i][0], y1, columns[i][1], y2);
+
+                    if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+                    {
+                        printf("# fill_rect(%u, %u, %u, %u, %u) differs from the reference\n", blank, columns[i][0], y1, columns[i][1], y2);
+                        errors++;
+                    }
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+
+/// @brief Check that drawing in OLED_OP_INVERT mode twice restores the background, and that a box outline is
+///        drawn once per pixel
+/// @return number of checks that failed
+static uint32_t check_invert_undraw()
+{
+    uint8_t expected[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    uint32_t errors = 0;
+
+    display.fill(0);
+    display.set_font(press_start_2p);
+    display.set_cursor(0, 0);
+    display.print(TEST_TEXT);
+    gauge.draw();
+    memcpy(expected, display.get_pixels(), sizeof(expected));
+
+    display.set_draw_mode(OLED_OP_INVERT);
+
+    for (uint8_t pass = 0; pass < 2; pass++)
+    {
+        display.draw_pixel(5, 60);
+        display.draw_line(0, 10, 127, 50);
+        display.draw_line(20, 0, 60, 63);
+        display.draw_line_dotted(0, 63, 127, 0);
+        display.draw_box(3, 5, 124, 58);
+        display.draw_box(40, 40, 40, 40);
+        display.draw_vbar(50, 0, 9, 9, 63);
+        display.draw_hbar(50, true, 22, 9, 105, 19);
+        display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 37, 11);
+        display.set_cursor(3, 30);
+        display.print("Invert");
+        display.fill_rect(0, 70, 3, 90, 30);
+    }
+
+    if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+    {
+        printf("# drawing twice in invert mode didn't restore the background\n");
+        errors++;
+    }
+
+    // Every corner of an outline drawn once is lit
+    display.fill(0);
+    display.draw_box(3, 5, 124, 58);
+
+    const uint8_t *pixels = display.get_pixels();
+    uint8_t corners[][2] = {{3, 5}, {124, 5}, {3, 58}, {124, 58}};
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        uint8_t x = corners[i][0], y = corners[i][1];
+
+        if (!(pixels[x + (y / OLED_PAGE_HEIGHT)*DISPLAY_WIDTH] & (1 << (y % OLED_PAGE_HEIGHT))))
+        {
+            printf("# box corner %u,%u is off after drawing in invert mode\n", x, y);
+            errors++;
+        }
+    }
+
+    display.set_draw_mode(OLED_OP_SET);
+
+    return errors;
+}
+
+
+/// @brief Light one pixel of a reference buffer if it is inside a rectangle
+static void reference_pixel(uint8_t *pixels, int32_t x, int32_t y, const int16_t *rect)
+{
+    if (x < rect[0] || x > rect[2] || y < rect[1] || y > rect[3])
+        return;
+
+    pixels[x + (y / OLED_PAGE_HEIGHT)*DISPLAY_WIDTH] |= 1 << (y % OLED_PAGE_HEIGHT);
+}
+
+
+/// @brief Unclipped Bresenham line, the version before clipping, plotting only the pixels inside a rectangle
+static void reference_line(uint8_t *pixels, int32_t x1, int32_t y1, int32_t x2, int32_t y2, bool dotted, const int16_t *rect)
+{
+    bool steep = abs(y2 - y1) > abs(x2 - x1);
+    int32_t tmp;
+
+    if (steep)
+    {
+        tmp = x1; x1 = y1; y1 = tmp;
+        tmp = x2; x2 = y2; y2 = tmp;
+    }
+
+    if (x1 > x2)
+    {
+        tmp = x1; x1 = x2; x2 = tmp;
+        tmp = y1; y1 = y2; y2 = tmp;
+    }
+
+    int32_t dx = x2 - x1;
+    int32_t dy = abs(y2 - y1);
+    int32_t y_step = (y1 < y2) ? 1 : -1;
+    int32_t p = dx / 2;
+
+    for (int32_t k = 0; x1 <= x2; x1++, k++)
+    {
+        if (!dotted || (k & 1))
+        {
+            if (steep)
+                reference_pixel(pixels, y1, x1, rect);
+            else
+                reference_pixel(pixels, x1, y1, rect);
+        }
+
+        p -= dy;
+
+        if (p < 0)
+        {
+            y1 += y_step;
+            p += dx;
+        }
+    }
+}
+
+
+/// @brief Check lines, bitmaps and rectangles that are partly off the screen or outside a clip rectangle against
+///        per-pixel references, and that the origin moves drawing
+/// @return number of checks that failed
+static uint32_t check_clipping()
+{
+    static const int16_t rects[][4] = {{0, 0, 127, 63}, {10, 7, 100, 41}, {64, 0, 64, 63}, {-20, 30, 30, 200}};
+    static const int16_t lines[][4] = {{-50, -20, 200, 90}, {20, -40, 60, 120}, {127, 70, -3, -9}, {-300, 5, 300, 60},
+                                       {5, 300, 60, -300}, {0, 10, 127, 50}, {-10, 62, 140, 61}, {200, 0, 300, 63}};
+    static const int16_t blits[][2] = {{-5, -3}, {120, 60}, {-15, 20}, {40, -19}, {100, 50}, {-16, 0}, {57, 13}};
+    uint8_t expected[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    uint32_t errors = 0;
+
+    for (uint8_t r = 0; r < sizeof(rects) / sizeof(rects[0]); r++)
+    {
+        const int16_t *rect = rects[r];
+
+        // The reference rectangle also stays on the screen
+        int16_t bounds[4] = {(int16_t) ((rect[0] > 0) ? rect[0] : 0), (int16_t) ((rect[1] > 0) ? rect[1] : 0),
+                             (int16_t) ((rect[2] < (int16_t) DISPLAY_WIDTH - 1) ? rect[2] : DISPLAY_WIDTH - 1),
+                             (int16_t) ((rect[3] < (int16_t) DISPLAY_HEIGHT - 1) ? rect[3] : DISPLAY_HEIGHT - 1)};
+
+        for (uint8_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+        {
+            for (uint8_t dotted = 0; dotted < 2; dotted++)
+            {
+                const int16_t *line = lines[i];
+
+                memset(expected, 0, sizeof(expected));
+                reference_line(expected, line[0], line[1], line[2], line[3], dotted, bounds);
+
+                display.fill(0);
+                display.set_clip_rect(rect[0], rect[1], rect[2], rect[3]);
+
+                if (dotted)
+                    display.draw_line_dotted(line[0], line[1], line[2], line[3]);
+                else
+                    display.draw_line(line[0], line[1], line[2], line[3]);
+
+                display.reset_clip_rect();
+
+                if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+                {
+                    printf("# %s %d,%d-%d,%d clipped to %d,%d-%d,%d differs from the reference\n", dotted ? "draw_line_dotted" : "draw_line",
+                           line[0], line[1], line[2], line[3], rect[0], rect[1], rect[2], rect[3]);
+                    errors++;
+                }
+            }
+        }
+
+        for (uint8_t i = 0; i < sizeof(blits) / sizeof(blits[0]); i++)
+        {
+            memset(expected, 0, sizeof(expected));
+
+            for (int16_t y = 0; y < raspberry.height; y++)
+                for (int16_t x = 0; x < raspberry.width; x++)
+                    if (raspberry.bitmap[x + (y / OLED_PAGE_HEIGHT)*raspberry.width] & (1 << (y % OLED_PAGE_HEIGHT)))
+                        reference_pixel(expected, blits[i][0] + x, blits[i][1] + y, bounds);
+
+            display.fill(0);
+            display.set_clip_rect(rect[0], rect[1], rect[2], rect[3]);
+            display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, blits[i][0], blits[i][1]);
+            display.reset_clip_rect();
+
+            if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+            {
+                printf("# draw_bmp at %d,%d clipped to %d,%d-%d,%d differs from the reference\n", blits[i][0], blits[i][1], rect[0], rect[1], rect[2], rect[3]);
+                errors++;
+            }
+        }
+
+        memset(expected, 0, sizeof(expected));
+
+        for (int16_t y = -4; y <= 70; y++)
+            for (int16_t x = -9; x <= 90; x++)
+                reference_pixel(expected, x, y, bounds);
+
+        display.fill(0);
+        display.set_clip_rect(rect[0], rect[1], rect[2], rect[3]);
+        display.fill_rect(0, 90, 70, -9, -4);
+        display.reset_clip_rect();
+
+        if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+        {
+            printf("# fill_rect clipped to %d,%d-%d,%d differs from the reference\n", rect[0], rect[1], rect[2], rect[3]);
+            errors++;
+        }
+    }
+
+    // Drawing with an origin is the same as drawing moved by it
+    display.fill(0);
+    display.set_font(press_start_2p);
+    display.set_cursor(2, 3);
+    display.print("Origin");
+    display.draw_box(10, 20, 60, 50);
+    display.draw_line(12, 22, 58, 48);
+    display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 70, 30);
+    memcpy(expected, display.get_pixels(), sizeof(expected));
+
+    display.fill(0);
+    display.set_origin(-30, 12);
+    display.set_cursor(32, -9);
+    display.print("Origin");
+    display.draw_box(40, 8, 90, 38);
+    display.draw_line(42, 10, 88, 36);
+    display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 100, 18);
+    display.set_origin(0, 0);
+
+    if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+    {
+        printf("# drawing with an origin differs from drawing moved by it\n");
+        errors++;
+    }
+
+    return errors;
+}
+
+
+/// @brief Check sprites against the same bitmap blitted, at every row within a page, partly off each edge and in
+///        each draw mode, and check the collision queries
+/// @return number of checks that failed
+static uint32_t check_sprites()
+{
+    static const int16_t positions[][2] = {{37, 8}, {37, 9}, {37, 10}, {37, 11}, {37, 12}, {37, 13}, {37, 14}, {37, 15},
+                                           {-5, -3}, {-9, -12}, {120, 50}, {100, 60}, {-15, 44}, {0, -19}, {60, 63}};
+    uint8_t expected[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    uint32_t errors = 0;
+
+    for (uint8_t op = OLED_OP_SET; op <= OLED_OP_INVERT; op++)
+    {
+        display.set_draw_mode((OLED_raster_op) op);
+
+        for (uint8_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+        {
+            int16_t x = positions[i][0], y = positions[i][1];
+
+            display.fill(0xA5);
+            display.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, x, y);
+            memcpy(expected, display.get_pixels(), sizeof(expected));
+
+            display.fill(0xA5);
+            display.draw_sprite(&raspberry_sprite, x, y);
+
+            if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+            {
+                printf("# draw_sprite at %d,%d in mode %u differs from draw_bmp\n", x, y, op);
+                errors++;
+            }
+        }
+    }
+
+    display.set_draw_mode(OLED_OP_SET);
+
+    oled_sprite memory[4];
+    oled_sprite_list list(memory, 4);
+    oled_sprite *a = list.add(&raspberry_sprite, 0, 0, 1);
+    oled_sprite *b = list.add(&raspberry_sprite, 15, 19, 0);     // Overlaps a by one pixel
+    oled_sprite *c = list.add(&raspberry_sprite, 16, 0, 0);      // Touches a without overlapping
+    oled_sprite *d = list.add(&raspberry_sprite, 20, 10, 2);
+
+    if (list.add(&raspberry_sprite, 0, 0) != NULL || list.find_overlap(a) != b || list.find_overlap(a, b) != NULL ||
+        list.find_overlap(c) != b || list.find_overlap(c, b) != d || list.sprite_at(15, 19) != a)
+    {
+        printf("# sprite list queries are wrong\n");
+        errors++;
+    }
+
+    // Hidden sprites don't collide, and a new depth moves a sprite in the draw order
+    b->visible = 0;
+    list.set_depth(d, -1);
+
+    if (list.find_overlap(a) != NULL || list.find_overlap(c) != d || list.sprite_at(21, 11) != c)
+    {
+        printf("# sprite list queries are wrong after hiding or moving a sprite\n");
+        errors++;
+    }
+
+    return errors;
+}
+
+
+/// @brief Check blit_screen and blit_masked against a pixel at a time copy for random source regions, positions
+///        (partly off each edge) and draw modes, and blit_screen against the reference blit wherever that one is right
+/// @return number of blits that came out different
+static uint32_t check_blit()
+{
+    static uint8_t legacy[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    static uint8_t expected[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    const gfx_font &font = press_start_2p;
+    uint8_t font_height = font.character['A' - font.first].height;
+    uint32_t seed = 12345;
+    uint32_t errors = 0;
+
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        // Random source region of the font bitmap and a position up to a blit size off each edge
+        seed = seed * 1103515245u + 12345u;
+        uint8_t src_y = (seed >> 8) % font_height;
+        uint8_t blit_height = 1 + (seed >> 16) % (font_height - src_y);
+        seed = seed * 1103515245u + 12345u;
+        uint16_t src_x = (seed >> 8) % (font.src_width - 40);
+        uint8_t blit_width = 1 + (seed >> 20) % 40;
+        seed = seed * 1103515245u + 12345u;
+        int16_t screen_x = (int16_t) ((seed >> 8) % (DISPLAY_WIDTH + 2*blit_width)) - blit_width;
+        int16_t screen_y = (int16_t) ((seed >> 20) % (DISPLAY_HEIGHT + 2*blit_height)) - blit_height;
+        OLED_raster_op op = (OLED_raster_op) ((seed >> 4) % 3);
+
+        // Every other blit is masked, with a different part of the font bitmap as the mask
+        bool masked = i & 1;
+        const uint8_t *mask = font.bitmap + 21;
+
+        display.fill(0xA5);
+        memcpy(expected, display.get_pixels(), sizeof(expected));
+        memcpy(legacy, display.get_pixels(), sizeof(legacy));
+
+        for (int16_t y = 0; y < blit_height; y++)
+        {
+            for (int16_t x = 0; x < blit_width; x++)
+            {
+                int16_t dx = screen_x + x, dy = screen_y + y;
+                uint16_t sx = src_x + x, sy = src_y + y;
+
+                if (dx < 0 || dx >= (int16_t) DISPLAY_WIDTH || dy < 0 || dy >= (int16_t) DISPLAY_HEIGHT)
+                    continue;
+
+                uint16_t src_byte = sx + (sy / OLED_PAGE_HEIGHT)*font.src_width;
+                uint8_t src_bit = 1 << (sy % OLED_PAGE_HEIGHT);
+                uint8_t *pixel = &expected[dx + (dy / OLED_PAGE_HEIGHT)*DISPLAY_WIDTH];
+                uint8_t bit = 1 << (dy % OLED_PAGE_HEIGHT);
+
+                if (masked)
+                {
+                    if (mask[src_byte] & src_bit)
+                        *pixel = (font.bitmap[src_byte] & src_bit) ? (*pixel | bit) : (*pixel & ~bit);
+
+                    continue;
+                }
+
+                if (!(font.bitmap[src_byte] & src_bit))
+                    continue;
+
+                if (op == OLED_OP_SET)
+                    *pixel |= bit;
+                else if (op == OLED_OP_CLEAR)
+                    *pixel &= ~bit;
+                else
+                    *pixel ^= bit;
+            }
+        }
+
+        legacy_blit(legacy, font.bitmap, font.src_width, src_x, src_y, blit_width, blit_height, screen_x, screen_y, op);
+
+        display.set_draw_mode(op);
+
+        if (masked)
+            display.blit_masked(font.bitmap, mask, font.src_width, src_x, src_y, blit_width, blit_height, screen_x, screen_y);
+        else
+            display.blit_screen(font.bitmap, font.src_width, src_x, src_y, blit_width, blit_height, screen_x, screen_y);
+
+        display.set_draw_mode(OLED_OP_SET);
+
+        if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+        {
+            printf("# %s(src %u,%u, %ux%u, at %d,%d, mode %u) differs from a pixel at a time copy\n", masked ? "blit_masked" : "blit_screen",
+                src_x, src_y, blit_width, blit_height, screen_x, screen_y, op);
+            errors++;
+        }
+        else if (masked)
+        {
+            continue;
+        }
+        else if (memcmp(legacy, display.get_pixels(), sizeof(legacy)) != 0)
+        {
+            // The reference blit drops rows of some blits whose first source row isn't at the top of a page
+            uint16_t src_top = src_y + ((screen_y < 0) ? -screen_y : 0);
+
+            if (src_top % OLED_PAGE_HEIGHT == 0)
+            {
+                printf("# blit_screen(src %u,%u, %ux%u, at %d,%d, mode %u) differs from the reference blit\n",
+                    src_x, src_y, blit_width, blit_height, screen_x, screen_y, op);
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+
+/// @brief Check that packed assets decode to the bitmaps they were made from, and that drawing them (in every draw
+///        mode, partly off each edge, clipped, shifted by the origin and recorded in a display list) and printing
+///        with a packed font gives the same pixels as drawing the originals
+/// @return number of checks that failed
+static uint32_t check_packed()
+{
+    const packed_bitmap *packed[] = {&splash_packed, &raspberry_packed, &raspberry_mask_packed};
+    const uint8_t *originals[] = {splash_bitmap, raspberry_bitmap, raspberry_mask_bitmap};
+    static uint8_t unpacked[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    static uint8_t expected[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    uint32_t seed = 12345;
+    uint32_t errors = 0;
+
+    for (uint8_t i = 0; i < sizeof(packed) / sizeof(packed[0]); i++)
+    {
+        uint32_t size = packed[i]->width * ((packed[i]->height + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT);
+        oled_unpacker unpacker(packed[i]->data, packed[i]->format);
+        unpacker.unpack(unpacked, size);
+
+        if (memcmp(unpacked, originals[i], size) != 0)
+        {
+            printf("# packed bitmap %u doesn't unpack to its original\n", i);
+            errors++;
+        }
+    }
+
+    // Every glyph of the packed font is the glyph's columns of the original bitmap table
+    for (uint16_t c = 0; c <= Retron2000.last - Retron2000.first; c++)
+    {
+        const gfx_char *character = &Retron2000.character[c];
+        oled_unpacker unpacker(Retron2000_packed.packed, Retron2000_packed.packed_format, Retron2000_packed.packed_offsets[c]);
+
+        for (uint8_t page = 0; page < (character->height + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT; page++)
+        {
+            unpacker.unpack(unpacked, character->width);
+
+            if (memcmp(unpacked, &Retron2000.bitmap[character->bitmap_x + page*Retron2000.src_width], character->width) != 0)
+            {
+                printf("# packed glyph of character %u doesn't unpack to its original\n", c + Retron2000.first);
+                errors++;
+                break;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < 3000; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        uint8_t asset = (seed >> 8) % (sizeof(packed) / sizeof(packed[0]));
+        const packed_bitmap *src = packed[asset];
+        int16_t x = (int16_t) ((seed >> 12) % (DISPLAY_WIDTH + 2*src->width)) - src->width;
+        int16_t y = (int16_t) ((seed >> 20) % (DISPLAY_HEIGHT + 2*src->height)) - src->height;
+        OLED_raster_op op = (OLED_raster_op) ((seed >> 4) % 3);
+
+        // Every fourth draw is clipped to a rectangle and moved by the origin
+        seed = seed * 1103515245u + 12345u;
+        bool clipped = (i & 3) == 3;
+        int16_t clip_x = (seed >> 8) % DISPLAY_WIDTH, clip_y = (seed >> 16) % DISPLAY_HEIGHT;
+        int16_t origin_x = (int16_t) ((seed >> 20) % 9) - 4, origin_y = (int16_t) ((seed >> 24) % 9) - 4;
+
+        if (clipped)
+        {
+            display.set_clip_rect(clip_x, clip_y, clip_x + 40, clip_y + 20);
+            display.set_origin(origin_x, origin_y);
+        }
+
+        display.set_draw_mode(op);
+        display.fill(0xA5);
+        display.draw_bmp(originals[asset], src->width, src->height, x, y);
+        memcpy(expected, display.get_pixels(), sizeof(expected));
+
+        display.fill(0xA5);
+        display.draw_packed(*src, x, y);
+
+        display.set_draw_mode(OLED_OP_SET);
+        display.reset_clip_rect();
+        display.set_origin(0, 0);
+
+        if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+        {
+            printf("# draw_packed(%u at %d,%d, mode %u%s) differs from draw_bmp\n", asset, x, y, op, clipped ? ", clipped" : "");
+            errors++;
+        }
+    }
+
+    static const int16_t positions[][2] = {{0, 0}, {-7, -5}, {3, 13}, {50, 45}, {-40, 30}, {20, -20}};
+
+    for (uint8_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+    {
+        display.fill(0);
+        display.set_font(Retron2000);
+        display.set_cursor(positions[i][0], positions[i][1]);
+        display.print(TEST_TEXT);
+        memcpy(expected, display.get_pixels(), sizeof(expected));
+
+        display.fill(0);
+        display.set_font(Retron2000_packed);
+        display.set_cursor(positions[i][0], positions[i][1]);
+        display.print(TEST_TEXT);
+
+        if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+        {
+            printf("# printing with the packed font at %d,%d differs from the original font\n", positions[i][0], positions[i][1]);
+            errors++;
+        }
+    }
+
+    // Recorded in a display list and played back when the frame is finished
+    static uint8_t list_memory[256];
+    static oled_display_list list(list_memory, sizeof(list_memory));
+
+    display.fill(0);
+    display.draw_packed(splash_packed, 5, -3);
+    display.set_cursor(positions[5][0], positions[5][1]);
+    display.print(TEST_TEXT);
+    memcpy(expected, display.get_pixels(), sizeof(expected));
+
+    display.set_display_list(&list);
+    display.fill(0);
+    display.draw_packed(splash_packed, 5, -3);
+    display.set_cursor(positions[5][0], positions[5][1]);
+    display.print(TEST_TEXT);
+    display.render();
+    display.set_display_list(NULL);
+
+    if (memcmp(expected, display.get_pixels(), sizeof(expected)) != 0)
+    {
+        printf("# packed drawing recorded in a display list differs from drawing it straight away\n");
+        errors++;
+    }
+
+    display.set_font(press_start_2p);
+
+    return errors;
+}
+
+/// @brief Check that render() sends the window around what was drawn, then that window's bytes of the frame, and
+///        puts back the bytes it lends the transport as header bytes
+/// @return number of checks that failed
+static uint32_t check_window()
+{
+    // Each draw and the window it should send: x1, page1, x2, page2
+    static const uint8_t windows[][4] = {{10, 0, 40, 2}, {120, 1, 127, 1}, {0, 2, 127, 3}, {100, 5, 115, 7}};
+    static uint8_t before[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    oled_record_transport bus;
+    pico_oled target(OLED_SSD1306, &bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    uint32_t errors = 0;
+
+    target.oled_init();
+    target.render();
+
+    for (uint8_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++)
+    {
+        const uint8_t *window = windows[i];
+
+        switch (i)
+        {
+            case 0:
+                target.draw_pixel(10, 12);
+                target.draw_line(20, 3, 40, 20);
+                break;
+
+            case 1:
+                target.fill_rect(0, 120, 8, 127, 15);
+                break;
+
+            case 2:
+                // Full width, so the last byte of page 1 (set by the draw before) is lent as the header byte
+                target.fill_rect(0, 0, 16, 127, 31);
+                break;
+
+            default:
+                target.draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 100, 40);
+        }
+
+        memcpy(before, target.get_pixels(), sizeof(before));
+        bus.clear_calls();
+        target.render();
+
+        const std::vector<oled_record_call> &calls = bus.get_calls();
+        const uint8_t window_cmds[] = {0x21, window[0], window[2], 0x22, window[1], window[3]};
+
+        if (calls.empty() || calls[0].kind != OLED_RECORD_CMD || calls[0].bytes != std::vector<uint8_t>(window_cmds, window_cmds + 6))
+        {
+            printf("# draw %u didn't send the window commands 21 %02x %02x 22 %02x %02x first\n", i, window[0], window[2], window[1], window[3]);
+            errors++;
+            continue;
+        }
+
+        std::vector<uint8_t> expected, sent;
+
+        for (uint8_t page = window[1]; page <= window[3]; page++)
+            expected.insert(expected.end(), &before[window[0] + page*DISPLAY_WIDTH], &before[window[2] + 1 + page*DISPLAY_WIDTH]);
+
+        for (size_t call = 1; call < calls.size(); call++)
+        {
+            if (calls[call].kind != OLED_RECORD_DATA)
+            {
+                printf("# draw %u sent something other than data after the window commands\n", i);
+                errors++;
+            }
+
+            sent.insert(sent.end(), calls[call].bytes.begin(), calls[call].bytes.end());
+        }
+
+        if (sent != expected)
+        {
+            printf("# draw %u sent %u data bytes that aren't the window's %u bytes of the frame\n", i, (uint) sent.size(), (uint) expected.size());
+            errors++;
+        }
+
+        if (memcmp(before, target.get_pixels(), sizeof(before)) != 0)
+        {
+            printf("# rendering draw %u changed the frame, a byte lent as a header byte wasn't put back\n", i);
+            errors++;
+        }
+
+        // Nothing is drawn between these, so nothing is sent
+        bus.clear_calls();
+        target.render();
+
+        if (!bus.get_calls().empty())
+        {
+            printf("# rendering again after draw %u sent %u calls\n", i, (uint) bus.get_calls().size());
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+
+/// @brief Check that oled_init() sends each controller the same command and data bytes as the original library,
+///        which sent them one command byte per transaction. How the bytes are grouped into calls isn't checked
+/// @return number of controllers whose bytes differ
+static uint32_t check_init()
+{
+    // Up to the window of the first frame, which is sent blank before the display is turned on
+    static const uint8_t ssd1306_cmds[] = {0xAE, 0x20, 0x00, 0x40, 0xA1, 0xA8, 0x3F, 0xC8, 0xD3, 0x00, 0xDA, 0x12, 0xD5, 0x80,
+                                           0xD9, 0xF1, 0xDB, 0x30, 0x81, 0x0F, 0xA4, 0xA6, 0x8D, 0x14, 0x2E, 0x21, 0x00, 0x7F, 0x22, 0x00, 0x07};
+    static const uint8_t ssd1309_cmds[] = {0xAE, 0x20, 0x00, 0x40, 0xA1, 0xC8, 0xA8, 0x3F, 0xD3, 0x00, 0xDA, 0x12, 0xD5, 0xA0,
+                                           0xD9, 0xD3, 0xDB, 0x30, 0x81, 0x0F, 0xA4, 0xA6, 0x8D, 0x10, 0x2E, 0x21, 0x00, 0x7F, 0x22, 0x00, 0x07};
+    const OLED_type controllers[] = {OLED_SSD1306, OLED_SSD1309};
+    const uint8_t *init_cmds[] = {ssd1306_cmds, ssd1309_cmds};
+    const char *names[] = {"SSD1306", "SSD1309"};
+    uint32_t errors = 0;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        oled_record_transport bus;
+        pico_oled target(controllers[i], &bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        target.oled_init();
+
+        // Each byte sent, with data bytes marked by bit 8
+        std::vector<uint16_t> expected(init_cmds[i], init_cmds[i] + sizeof(ssd1306_cmds));
+        std::vector<uint16_t> sent;
+
+        expected.insert(expected.end(), DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT, 0x100);
+        expected.push_back(0xAF);
+
+        for (const oled_record_call &call : bus.get_calls())
+        {
+            for (uint8_t value : call.bytes)
+                sent.push_back((call.kind == OLED_RECORD_CMD) ? value : 0x100 | value);
+        }
+
+        if (sent != expected)
+        {
+            size_t first = 0;
+
+            while (first < sent.size() && first < expected.size() && sent[first] == expected[first])
+                first++;
+
+            printf("# oled_init() sent the %s %u bytes that differ from the original from byte %u\n", names[i], (uint) sent.size(), (uint) first);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+
+/// @brief Check oled_triple_buffer with a producer and a consumer thread: the consumer only gets whole frames, in
+///        increasing order and always the newest one published, and neither side waits for the other
+/// @return number of checks that failed
+static uint32_t check_triple_buffer()
+{
+    #define TEST_FRAME_WORDS 64
+    #define TEST_FRAMES 200000
+
+    static uint32_t slots[3][TEST_FRAME_WORDS];
+    static oled_triple_buffer frames;
+    static std::atomic<uint32_t> published(0);
+    static std::atomic<bool> stop(false);
+    uint32_t errors = 0;
+
+    // Every word of a frame holds its frame number, so a frame written over while it is read shows up
+    auto draw = [](uint8_t slot, uint32_t seq)
+    {
+        for (uint16_t i = 0; i < TEST_FRAME_WORDS; i++)
+            slots[slot][i] = seq;
+    };
+
+    auto whole = [](uint8_t slot, uint32_t seq)
+    {
+        for (uint16_t i = 0; i < TEST_FRAME_WORDS; i++)
+            if (slots[slot][i] != seq)
+                return false;
+
+        return true;
+    };
+
+    // The producer never waits: it publishes every frame while the consumer holds one slot and does nothing
+    uint32_t seq = 0;
+    draw(frames.back_slot(), 1);
+    frames.publish(1);
+    int8_t held = frames.acquire(&seq);
+
+    std::thread producer([&draw]
+    {
+        for (uint32_t n = 2; n <= 1000; n++)
+        {
+            draw(frames.back_slot(), n);
+            frames.publish(n);
+        }
+    });
+
+    producer.join();
+
+    if (held < 0 || seq != 1 || !whole(held, 1))
+    {
+        printf("# a slot held by the consumer was drawn over by the producer\n");
+        errors++;
+    }
+
+    if (frames.acquire(&seq) < 0 || seq != 1000 || frames.acquire(&seq) >= 0)
+    {
+        printf("# after the producer ran on its own the consumer didn't get the last frame, once\n");
+        errors++;
+    }
+
+    published.store(1000);
+
+    // Both at once. The consumer checks every frame it gets before and after reading it slowly
+    std::thread consumer([&whole, &errors]
+    {
+        uint32_t last = 1000;
+        uint32_t received = 0;
+
+        while (!stop.load() || last != published.load())
+        {
+            uint32_t newest = published.load();
+            uint32_t frame_seq;
+            int8_t slot = frames.acquire(&frame_seq);
+
+            if (slot < 0)
+            {
+                // The producer counts a frame as published just after publishing it, so last can be ahead
+                if (newest > last)
+                {
+                    printf("# frame %u was published but acquire() found nothing new after frame %u\n", newest, last);
+                    errors++;
+                    return;
+                }
+
+                continue;
+            }
+
+            if (frame_seq <= last || frame_seq < newest)
+            {
+                printf("# acquire() returned frame %u after frame %u with frame %u published\n", frame_seq, last, newest);
+                errors++;
+                return;
+            }
+
+            bool complete = whole(slot, frame_seq);
+
+            for (volatile uint16_t spin = 0; spin < 200; spin++)
+                ;
+
+            if (!complete || !whole(slot, frame_seq))
+            {
+                printf("# frame %u wasn't whole while the consumer held it\n", frame_seq);
+                errors++;
+                return;
+            }
+
+            last = frame_seq;
+            received++;
+        }
+
+        if (received == 0)
+        {
+            printf("# the consumer received no frames while the producer ran\n");
+            errors++;
+        }
+    });
+
+    producer = std::thread([&draw]
+    {
+        for (uint32_t n = 1001; n <= 1000 + TEST_FRAMES; n++)
+        {
+            draw(frames.back_slot(), n);
+            frames.publish(n);
+            published.store(n);
+        }
+
+        stop.store(true);
+    });
+
+    producer.join();
+    consumer.join();
+
+    #undef TEST_FRAME_WORDS
+    #undef TEST_FRAMES
+
+    return errors;
+}
+
+
+/// @brief Check render_async() with a transport that stays busy until the test lets it finish: render_busy() follows
+///        the transport, drawing after render_async() doesn't change the frame being sent, and the next
+///        render_async() waits for the last frame before sending anything
+/// @return number of checks that failed
+static uint32_t check_async()
+{
+    static uint8_t frame_a[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    static uint8_t frame_b[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    oled_record_transport bus(true);
+    pico_oled target(OLED_SSD1306, &bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    uint32_t errors = 0;
+
+    target.oled_init();
+    bus.set_hold(true);
+    bus.clear_calls();
+
+    // Frame A covers the whole screen, so its window is every byte of the frame
+    target.fill(0);
+    target.set_font(press_start_2p);
+    target.set_cursor(0, 0);
+    target.print(TEST_TEXT);
+    target.draw_pixel(127, 63);
+    target.draw_pixel(0, 63);
+    memcpy(frame_a, target.get_pixels(), sizeof(frame_a));
+    target.render_async();
+
+    if (!target.render_busy() || bus.get_calls().size() != 1)
+    {
+        printf("# render_busy() is false, or the frame was sent, while the transport holds the transfer\n");
+        errors++;
+    }
+
+    // Frame B is drawn over frame A while A is still being sent
+    target.fill_rect_op(OLED_OP_INVERT, 10, 10, 50, 30);
+    target.draw_line(0, 0, 127, 63);
+    memcpy(frame_b, target.get_pixels(), sizeof(frame_b));
+
+    // The transfer finishes a little after the next render_async() starts waiting for it. Timed from before the
+    // thread starts, so the wait can't look short when the thread gets going first
+    uint64_t start_us = time_us_64();
+    std::thread finish([&bus]
+    {
+        sleep_ms(20);
+        bus.release();
+    });
+
+    target.render_async();
+    uint64_t waited_us = time_us_64() - start_us;
+    finish.join();
+
+    // Window and rows of A, then the window of B. B's rows are still held
+    const std::vector<oled_record_call> &calls = bus.get_calls();
+
+    if (calls.size() != 3 || calls[0].kind != OLED_RECORD_CMD || calls[1].kind != OLED_RECORD_ASYNC || calls[2].kind != OLED_RECORD_CMD ||
+        waited_us < 15000)
+    {
+        printf("# the second render_async() didn't wait %u us for the first frame to finish before sending\n", (uint) waited_us);
+        errors++;
+    }
+    else if (calls[1].bytes != std::vector<uint8_t>(frame_a, frame_a + sizeof(frame_a)))
+    {
+        printf("# drawing after render_async() changed the frame being sent\n");
+        errors++;
+    }
+
+    if (!target.render_busy())
+    {
+        printf("# render_busy() is false while the second frame is held\n");
+        errors++;
+    }
+
+    bus.release();
+
+    if (target.render_busy())
+    {
+        printf("# render_busy() is still true after the transfer finished\n");
+        errors++;
+    }
+
+    // B went out as the window around what changed, cut from the frame as it was when render_async() was called
+    if (calls.size() == 4 && calls[3].kind == OLED_RECORD_ASYNC && calls[2].bytes.size() == 6)
+    {
+        const std::vector<uint8_t> &window = calls[2].bytes;
+        std::vector<uint8_t> expected;
+
+        for (uint8_t page = window[4]; page <= window[5]; page++)
+            expected.insert(expected.end(), &frame_b[window[1] + page*DISPLAY_WIDTH], &frame_b[window[2] + 1 + page*DISPLAY_WIDTH]);
+
+        if (calls[3].bytes != expected)
+        {
+            printf("# the second frame sent by render_async() isn't its window of the frame\n");
+            errors++;
+        }
+    }
+    else
+    {
+        printf("# the second frame wasn't sent in the background when its transfer was released\n");
+        errors++;
+    }
+
+    return errors;
+}
+
+
+/// @brief Check the frame scheduler's statistics when only some frame slots have something to send: skipped and
+///        deferred slots are counted, and don't add to the jitter of the frames sent after them
+/// @return number of checks that failed
+static uint32_t check_scheduler()
+{
+    oled_record_transport bus;
+    pico_oled target(OLED_SSD1306, &bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_frame_scheduler scheduler(&target, 20);
+    uint32_t errors = 0;
+
+    target.oled_init();
+    scheduler.reset_stats();
+
+    // A frame every third slot, and one held back by a quiet period until the slot after it. The quiet period
+    // is a quarter of a slot, so a slot that starts late on a busy host still ends it before the next slot
+    for (uint8_t slot = 0; slot < 30; slot++)
+    {
+        scheduler.wait_for_frame();
+
+        if (slot % 3 == 0)
+            target.draw_pixel(slot, slot);
+
+        if (slot == 15)
+            scheduler.quiet_for_us(12500);
+
+        scheduler.submit();
+    }
+
+    oled_frame_stats stats = scheduler.get_stats();
+
+    if (stats.frames_rendered != 10 || stats.frames_skipped != 19 || stats.frames_deferred != 1 || stats.frames_dropped != 0)
+    {
+        printf("# scheduler counted %u rendered, %u skipped, %u deferred and %u dropped frames instead of 10, 19, 1 and 0\n",
+            stats.frames_rendered, stats.frames_skipped, stats.frames_deferred, stats.frames_dropped);
+        errors++;
+    }
+
+    // Every frame went out at the start of its slot, a whole period (50 ms) would mean skipped slots were counted
+    if (stats.jitter_max_us >= 25000)
+    {
+        printf("# scheduler jitter is up to %u us with every frame sent at the start of its slot\n", stats.jitter_max_us);
+        errors++;
+    }
+
+    return errors;
+}
+
+
+/// @brief Check that renders which find nothing changed in OLED_UPDATE_SHADOW/OLED_UPDATE_CHECKSUM mode send nothing
+///        and aren't counted, that renders which send something are, and that frames sent from core 1 are added in
+///        while core 0 reads and clears the counters. Without OLED_TELEMETRY the counters stay at zero
+/// @return number of checks that failed
+static uint32_t check_telemetry()
+{
+    const OLED_update_mode modes[] = {OLED_UPDATE_SHADOW, OLED_UPDATE_CHECKSUM};
+    uint32_t errors = 0;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        oled_record_transport bus;
+        pico_oled target(OLED_SSD1306, &bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        target.set_update_mode(modes[i]);
+        target.oled_init();
+        target.reset_telemetry();
+        bus.clear_calls();
+
+        // Drawn and drawn back, so there is something dirty but nothing different
+        for (uint8_t frame = 0; frame < 3; frame++)
+        {
+            target.draw_pixel(10, 10);
+            target.fill(0);
+            target.render();
+        }
+
+        target.draw_pixel(10, 10);
+        target.render();
+
+        oled_telemetry counters = target.get_telemetry();
+
+#ifdef OLED_TELEMETRY
+        uint32_t renders = 1;
+        uint32_t sent = 0;
+
+        for (const oled_record_call &call : bus.get_calls())
+            sent += call.bytes.size();
+#else
+        uint32_t renders = 0;
+        uint32_t sent = 0;
+#endif
+
+        if (counters.renders != renders || counters.bytes_sent != sent)
+        {
+            printf("# mode %u counted %u renders and %u bytes for frames that sent %u bytes in %u renders\n", modes[i],
+                counters.renders, counters.bytes_sent, sent, renders);
+            errors++;
+        }
+    }
+
+    // A thread standing in for core 1 sends frames, e.g. for oled_render_service, while core 0 reads and clears the
+    // counters. Every copy core 0 gets must be whole, and core 1's frames are counted along with core 0's
+    oled_record_transport bus;
+    pico_oled target(OLED_SSD1306, &bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    std::atomic<bool> done(false);
+
+    target.oled_init();
+    target.reset_telemetry();
+
+    std::thread core1([&target, &done]
+    {
+        host_set_core_num(1);
+
+        for (uint16_t frame = 0; frame < 2000; frame++)
+        {
+            target.draw_pixel(frame % DISPLAY_WIDTH, frame % DISPLAY_HEIGHT);
+            target.render();
+        }
+
+        done.store(true);
+    });
+
+    uint32_t torn = 0;
+
+    while (!done.load())
+    {
+        oled_telemetry counters = target.get_telemetry();
+
+        if (counters.bytes_sent != counters.cmd_bytes + counters.data_bytes)
+            torn++;
+
+        if (counters.renders >= 500)
+            target.reset_telemetry();
+    }
+
+    core1.join();
+
+    if (torn > 0)
+    {
+        printf("# %u copies of the counters were taken part way through core 1 changing them\n", torn);
+        errors++;
+    }
+
+    // Cleared by core 0, then one frame each from core 1 and core 0
+    target.reset_telemetry();
+
+    std::thread last_frame([&target]
+    {
+        host_set_core_num(1);
+        target.draw_pixel(0, 0);
+        target.render();
+    });
+
+    last_frame.join();
+    target.draw_pixel(1, 1);
+    target.render();
+
+    oled_telemetry counters = target.get_telemetry();
+
+#ifdef OLED_TELEMETRY
+    uint32_t renders = 2;
+#else
+    uint32_t renders = 0;
+#endif
+
+    if (counters.renders != renders || counters.bytes_sent != counters.cmd_bytes + counters.data_bytes)
+    {
+        printf("# counted %u renders across both cores after a clear instead of %u\n", counters.renders, renders);
+        errors++;
+    }
+
+    return errors;
+}
+
+
+#define PIO_CLK_PIN 10
+#define PIO_DATA_PIN 11
+#define PIO_DC_PIN 12
+#define PIO_CS_PIN 13
+
+// Every cycle the PIO transport's state machine ran, with the D/C and CS levels at the time
+struct pio_cycle
+{
+    bool clk;
+    bool data;
+    bool dc;
+    bool cs;
+    bool stalled;
+};
+
+static void record_pio_cycle(void *context, uint sm, uint32_t pins, bool stalled)
+{
+    pio_cycle cycle = {(bool) (pins & (1u << PIO_CLK_PIN)), (bool) (pins & (1u << PIO_DATA_PIN)),
+        gpio_get(PIO_DC_PIN), gpio_get(PIO_CS_PIN), stalled};
+    ((std::vector<pio_cycle> *) context)->push_back(cycle);
+}
+
+
+/// @brief Check the bits the PIO transport clocks out, by running its program on the host PIO: bytes are sent
+///        MSB first with the data set up while the clock is low, for commands put in the FIFO by the CPU and for
+///        data written to it by 8-bit DMA, and the state machine only stalls between bytes with the clock low
+/// @return number of checks that failed
+static uint32_t check_pio()
+{
+    std::vector<pio_cycle> cycles;
+    host_pio_set_handler(pio0, record_pio_cycle, &cycles);
+
+    oled_pio_transport bus(pio0, PIO_CLK_PIN, PIO_DATA_PIN, PIO_DC_PIN, PIO_CS_PIN, 1000000);
+    uint32_t errors = 0;
+
+    const uint8_t cmds[] = {0xAE, 0x81, 0x7F, 0xA5};
+    uint8_t data[] = {0x00, 0x00, 0xFF, 0x96, 0x01, 0x80, 0x5A};     // data[0] is the unused header byte
+    uint8_t rows[3][8];
+
+    for (uint8_t row = 0; row < 3; row++)
+    {
+        for (uint8_t column = 0; column < 8; column++)
+            rows[row][column] = row*0x40 + column*0x11;
+    }
+
+    // Each byte expected, bit 8 set for data
+    std::vector<uint16_t> expected;
+
+    for (uint8_t cmd : cmds)
+        expected.push_back(cmd);
+
+    for (uint8_t i = 1; i < sizeof(data); i++)
+        expected.push_back(0x100 | data[i]);
+
+    for (uint8_t row = 0; row < 3; row++)
+    {
+        for (uint8_t column = 0; column < 4; column++)
+            expected.push_back(0x100 | rows[row][column]);
+    }
+
+    cycles.clear();
+    bus.write_cmd(cmds, sizeof(cmds));
+    bus.write_data(data, sizeof(data) - 1);
+    bus.write_data_async(&rows[0][0], 4, 8, 3, true);
+    bus.wait();
+
+    std::vector<uint16_t> sent;
+    uint16_t byte = 0;
+    uint8_t bits = 0;
+    uint32_t clocked = 0;
+    bool bad_stall = false;
+    bool bad_setup = false;
+
+    for (size_t i = 0; i < cycles.size(); i++)
+    {
+        const pio_cycle &cycle = cycles[i];
+
+        if (cycle.stalled)
+        {
+            bad_stall |= cycle.clk || bits != 0;
+            continue;
+        }
+
+        clocked++;
+
+        // The display samples on the rising edge, the data has to be there from the cycle before
+        if (cycle.clk && i > 0 && !cycles[i - 1].clk)
+        {
+            bad_setup |= cycles[i - 1].data != cycle.data || cycle.cs;
+            byte = (byte << 1) | cycle.data;
+
+            if (++bits == 8)
+            {
+                sent.push_back((cycle.dc ? 0x100 : 0) | (byte & 0xFF));
+                byte = 0;
+                bits = 0;
+            }
+        }
+    }
+
+    if (sent != expected)
+    {
+        printf("# PIO transport sent %zu bytes instead of %zu:", sent.size(), expected.size());
+
+        for (size_t i = 0; i < sent.size(); i++)
+            printf(" %03x", sent[i]);
+
+        printf("\n");
+        errors++;
+    }
+
+    if (clocked != 16*expected.size())
+    {
+        printf("# PIO transport ran %u cycles for %zu bytes instead of two per bit\n", clocked, expected.size());
+        errors++;
+    }
+
+    if (bad_stall)
+    {
+        printf("# PIO transport stalled part way through a byte or with the clock high\n");
+        errors++;
+    }
+
+    if (bad_setup)
+    {
+        printf("# PIO transport changed the data on a rising clock edge or clocked with CS high\n");
+        errors++;
+    }
+
+    for (uint8_t row = 0; row < 3; row++)
+    {
+        if (rows[row][0] != 0 || rows[row][3] != 0 || rows[row][4] != row*0x40 + 4*0x11)
+        {
+            printf("# PIO transport didn't clear just the %u bytes sent of row %u\n", 4, row);
+            errors++;
+        }
+    }
+
+    host_pio_set_handler(pio0, NULL, NULL);
+    return errors;
+}
+
+
+/// @brief Draw one of everything on a canvas, in each draw mode and with a clip rectangle and origin
+static void draw_scene(oled_canvas *canvas, analog_gauge *scene_gauge)
+{
+    const OLED_raster_op modes[] = {OLED_OP_SET, OLED_OP_INVERT, OLED_OP_CLEAR};
+
+    canvas->fill(0x3C);
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        canvas->set_draw_mode(modes[i]);
+        canvas->set_origin(i * 3, i * 5 - 4);
+
+        if (i == 2)
+            canvas->set_clip_rect(7, 3, 117, 58);
+
+        canvas->draw_pixel(5, 9);
+        canvas->draw_line(0, 10, 127, 50);
+        canvas->draw_line(20, 0, 60, 63);
+        canvas->draw_line_dotted(127, 0, 0, 60);
+        canvas->draw_line(2, 33, 125, 33);
+        canvas->draw_line(90, 1, 90, 62);
+        canvas->fill_rect_op(OLED_OP_INVERT, 3, 5, 124, 58);
+        canvas->fill_rect(0, 0, 12, 127, 40);
+        canvas->draw_box(10, 11, 50, 30);
+        canvas->draw_bmp(raspberry.bitmap, raspberry.width, raspberry.height, 37, 8 + i);
+        canvas->draw_masked_bmp(raspberry_masked, 100, 50);
+        canvas->draw_sprite(&raspberry_sprite, 70, 21 + i);
+        canvas->draw_packed(splash_packed, 60, 30 + i);
+        canvas->set_font(i == 1 ? Retron2000_packed : Retron2000);
+        canvas->set_cursor(0, 3);
+        canvas->print(TEST_TEXT);
+        scene_gauge->draw();
+    }
+
+    canvas->set_draw_mode(OLED_OP_SET);
+    canvas->set_origin(0, 0);
+    canvas->reset_clip_rect();
+}
+
+
+/// @brief Check that a pico_oled_static, which draws with the kernels compiled for its width, draws the same as a
+///        pico_oled when called through a base class pointer
+/// @return number of checks that failed
+static uint32_t check_static()
+{
+    static pico_oled_static<DISPLAY_WIDTH, DISPLAY_HEIGHT, OLED_SSD1306> static_display(&sim_bus);
+    oled_canvas *canvases[] = {&display, &static_display};
+    uint8_t frames[2][DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        analog_gauge scene_gauge(canvases[i]);
+        scene_gauge.set_position(63, 63);
+        scene_gauge.set_scale(0, 100, 220, 320);
+        scene_gauge.set_markers(3, 45, 15, 1);
+        scene_gauge.set_value(70);
+
+        draw_scene(canvases[i], &scene_gauge);
+        memcpy(frames[i], canvases[i]->get_pixels(), sizeof(frames[i]));
+    }
+
+    uint32_t errors = 0;
+
+    for (uint16_t i = 0; i < sizeof(frames[0]); i++)
+    {
+        if (frames[0][i] != frames[1][i])
+        {
+            printf("# pico_oled_static drew %02x instead of %02x at page %u, column %u\n", frames[1][i], frames[0][i],
+                i / DISPLAY_WIDTH, i % DISPLAY_WIDTH);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+
+/// @brief Draw a frame with text in three fonts, with an origin, a clip rectangle and an offscreen canvas
+static void draw_list_frame(oled_canvas *target, const oled_canvas *widget, const char *text)
+{
+    target->fill(0);
+    target->set_font(Retron2000);
+    target->set_cursor(0, 0);
+    target->print(text);
+    target->print(" and on");
+
+    target->set_origin(-5, 3);
+    target->set_clip_rect(10, 0, 100, 40);
+    target->set_font(Retron2000_packed);
+    target->set_cursor(60, 20);
+    target->print("Clipped\nand moved");
+    target->reset_clip_rect();
+    target->set_origin(0, 0);
+
+    target->set_font(press_start_2p);
+    target->set_draw_mode(OLED_OP_INVERT);
+    target->set_cursor(2, 44);
+    target->print("Inverted");
+    target->set_draw_mode(OLED_OP_SET);
+
+    target->draw_canvas(widget, 96, 48);
+    target->draw_line(0, 63, 127, 40);
+
+    // Ends in the font the next frame starts with
+    target->set_font(Retron2000);
+    target->set_cursor(60, 56);
+    target->print("End");
+}
+
+
+/// @brief Check frames recorded in a display list: they draw the same as drawing straight away, an identical frame
+///        sends nothing, and changed text or a redrawn offscreen canvas are sent
+/// @return number of checks that failed
+static uint32_t check_display_list()
+{
+    static uint8_t list_memory[1024];
+    static uint8_t widget_memory[16 * 2 + 1];
+    static uint8_t expected[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    oled_display_list list(list_memory, sizeof(list_memory));
+    oled_canvas widget(widget_memory, 16, 16);
+    oled_record_transport bus;
+    pico_oled target(OLED_SSD1306, &bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    uint32_t errors = 0;
+
+    const char *texts[] = {TEST_TEXT, TEST_TEXT, TEST_TEXT, "Changed text"};
+    const char *frame_names[] = {"first", "identical", "redrawn canvas", "changed text"};
+    bool sent_expected[] = {true, false, true, true};
+
+    target.oled_init();
+    target.set_display_list(&list);
+    widget.fill(0);
+    widget.draw_box(0, 0, 15, 15);
+
+    for (uint8_t frame = 0; frame < 4; frame++)
+    {
+        if (frame == 2)
+            widget.draw_line(0, 0, 15, 15);
+
+        draw_list_frame(&display, &widget, texts[frame]);
+        memcpy(expected, display.get_pixels(), sizeof(expected));
+
+        bus.clear_calls();
+        draw_list_frame(&target, &widget, texts[frame]);
+        target.render();
+
+        if (memcmp(expected, target.get_pixels(), sizeof(expected)) != 0)
+        {
+            printf("# %s frame recorded in a display list differs from drawing it straight away\n", frame_names[frame]);
+            errors++;
+        }
+
+        if (bus.get_calls().empty() == sent_expected[frame])
+        {
+            printf("# %s frame recorded in a display list %s\n", frame_names[frame], sent_expected[frame] ? "wasn't sent" : "was sent");
+            errors++;
+        }
+    }
+
+    if (list.did_overflow())
+    {
+        printf("# frames overflowed a %u byte display list\n", (uint32_t) sizeof(list_memory));
+        errors++;
+    }
+
+    target.set_display_list(NULL);
+    display.set_font(press_start_2p);
+
+    return errors;
+}
+
+
+/// @brief Compare a simulated display's RAM with a frame buffer
+/// @return true if every byte matches
+static bool sim_shows(oled_sim_controller *screen, const uint8_t *frame)
+{
+    for (uint8_t page = 0; page < DISPLAY_HEIGHT / OLED_PAGE_HEIGHT; page++)
+    {
+        for (uint8_t column = 0; column < DISPLAY_WIDTH; column++)
+        {
+            if (screen->get_ram(column, page) != frame[column + page*DISPLAY_WIDTH])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+/// @brief Check background I2C frames sent to an address nothing acknowledges: the transfer is aborted rather than
+///        waited on forever, the failure is reported, and the bus and DMA channel can be used again afterwards
+/// @return number of checks that failed
+static uint32_t check_i2c_nack()
+{
+    oled_sim_controller present_sim(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_sim_controller late_sim(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_i2c_transport present_bus(i2c1, 0x3C);
+    oled_i2c_transport missing_bus(i2c1, 0x3E);
+    pico_oled present(OLED_SSD1306, &present_bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    pico_oled missing(OLED_SSD1306, &missing_bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    uint32_t errors = 0;
+
+    present_sim.attach_i2c(i2c1, 0x3C);
+    present.oled_init();
+    missing.oled_init();
+
+    missing.fill(0);
+    missing.draw_line(0, 0, 127, 63);
+    missing.render_async();
+
+    if (missing.render_busy() || !missing_bus.transfer_failed())
+    {
+        printf("# a background frame nothing acknowledged %s\n", missing.render_busy() ? "is still busy" : "wasn't reported");
+        errors++;
+    }
+
+    // The display sharing the bus has to wait for the aborted frame before it can send
+    present.fill(0);
+    present.set_font(press_start_2p);
+    present.set_cursor(0, 0);
+    present.print(TEST_TEXT);
+    present.render_async();
+    present.render_wait();
+
+    if (present_bus.transfer_failed() || !sim_shows(&present_sim, present.get_pixels()))
+    {
+        printf("# a display sharing the bus didn't get its frame after another display's frame was aborted\n");
+        errors++;
+    }
+
+    // Once the display answers, its frames go through on the same DMA channel. Only what was drawn since the last
+    // render is sent, so the lost frame is drawn again
+    late_sim.attach_i2c(i2c1, 0x3E);
+    missing.oled_init();
+    missing.fill(0);
+    missing.draw_line(0, 0, 127, 63);
+    missing.render_async();
+    missing.render_wait();
+
+    if (missing_bus.transfer_failed() || !sim_shows(&late_sim, missing.get_pixels()))
+    {
+        printf("# a background frame was lost after an aborted frame\n");
+        errors++;
+    }
+
+    return errors;
+}
+
+
+/// @brief Check a render group: every display's frame is started before the group waits for any of them, the group
+///        is busy until the last one finishes, it holds at most OLED_RENDER_GROUP_MAX displays, and two I2C displays
+///        on one block take turns
+/// @return number of checks that failed
+static uint32_t check_render_group()
+{
+    oled_record_transport bus_a(true);
+    oled_record_transport bus_b(true);
+    pico_oled display_a(OLED_SSD1306, &bus_a, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    pico_oled display_b(OLED_SSD1306, &bus_b, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_render_group group;
+    uint32_t errors = 0;
+
+    for (uint8_t i = 0; i < OLED_RENDER_GROUP_MAX; i++)
+    {
+        if (!group.add((i & 1) ? &display_b : &display_a))
+        {
+            printf("# a render group took %u displays, not %u\n", i, OLED_RENDER_GROUP_MAX);
+            errors++;
+        }
+    }
+
+    if (group.add(&display_a))
+    {
+        printf("# a render group took more than %u displays\n", OLED_RENDER_GROUP_MAX);
+        errors++;
+    }
+
+    // Separate transports: both frames are held, so if either were waited on before the other started the group
+    // would only get going when the releases below come
+    oled_render_group pair;
+    pair.add(&display_a);
+    pair.add(&display_b);
+    display_a.oled_init();
+    display_b.oled_init();
+    bus_a.set_hold(true);
+    bus_b.set_hold(true);
+    bus_a.clear_calls();
+    bus_b.clear_calls();
+    display_a.fill(0);
+    display_a.draw_line(0, 0, 127, 63);
+    display_b.fill(0);
+    display_b.draw_box(10, 10, 50, 30);
+
+    std::atomic<bool> done(false);
+    std::thread finish([&bus_a, &bus_b, &done]
+    {
+        sleep_ms(100);
+
+        while (!done.load())
+        {
+            bus_a.release();
+            bus_b.release();
+            sleep_us(100);
+        }
+    });
+
+    uint64_t start_us = time_us_64();
+    pair.render_async();
+    uint64_t started_us = time_us_64() - start_us;
+    bool both_busy = bus_a.busy() && bus_b.busy();
+
+    if (!both_busy || started_us >= 50000)
+    {
+        printf("# a render group waited %u us for a held frame before starting the next one\n", (uint) started_us);
+        errors++;
+    }
+
+    pair.render_wait();
+    done.store(true);
+    finish.join();
+
+    if (pair.render_busy() || bus_a.get_calls().back().kind != OLED_RECORD_ASYNC || bus_b.get_calls().back().kind != OLED_RECORD_ASYNC)
+    {
+        printf("# a render group didn't finish sending both frames\n");
+        errors++;
+    }
+
+    // One I2C block: the second display's window command waits for the first display's frame to finish
+    oled_sim_controller sim_a(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_sim_controller sim_b(OLED_SSD1306, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_i2c_transport i2c_a(i2c1, 0x3C);
+    oled_i2c_transport i2c_b(i2c1, 0x3E);
+    pico_oled shared_a(OLED_SSD1306, &i2c_a, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    pico_oled shared_b(OLED_SSD1306, &i2c_b, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    oled_render_group shared;
+
+    sim_a.attach_i2c(i2c1, 0x3C);
+    sim_b.attach_i2c(i2c1, 0x3E);
+    shared.add(&shared_a);
+    shared.add(&shared_b);
+    shared_a.oled_init();
+    shared_b.oled_init();
+    shared_a.fill(0);
+    shared_a.draw_line(0, 63, 127, 0);
+    shared_b.fill(0);
+    shared_b.draw_box(20, 8, 100, 50);
+    host_i2c_hold(i2c1, true);
+
+    // The second release is only for a group that waits on the second frame too, so that it fails rather than hangs.
+    // Timed from before the thread starts, so the wait can't look short when the thread gets going first
+    start_us = time_us_64();
+    std::thread release([]
+    {
+        sleep_ms(20);
+        host_i2c_release(i2c1);
+        sleep_ms(200);
+        host_i2c_release(i2c1);
+    });
+
+    shared.render_async();
+    uint64_t waited_us = time_us_64() - start_us;
+
+    if (waited_us < 15000 || shared_a.render_busy() || !shared_b.render_busy())
+    {
+        printf("# two I2C displays on one block didn't take turns, the render group returned after %u us\n", (uint) waited_us);
+        errors++;
+    }
+
+    host_i2c_release(i2c1);
+    shared.render_wait();
+    release.join();
+    host_i2c_hold(i2c1, false);
+
+    if (shared.render_busy() || !sim_shows(&sim_a, shared_a.get_pixels()) || !sim_shows(&sim_b, shared_b.get_pixels()))
+    {
+        printf("# a render group of I2C displays on one block didn't send both frames\n");
+        errors++;
+    }
+
+    return errors;
+}
+
+
+/// @brief Check a canvas pool: canvases come from separate parts of the arena and start cleared, acquire() fails once
+///        memory or slots run out, memory only comes back when the newest canvases are released, and reset() gives
+///        everything back
+/// @return number of checks that failed
+static uint32_t check_canvas_pool()
+{
+    static uint8_t memory[200];
+    oled_canvas_pool pool(memory, sizeof(memory));
+    const uint8_t sizes[][2] = {{16, 16}, {10, 12}, {20, 8}};
+    oled_canvas *canvases[3];
+    uint32_t errors = 0;
+
+    memset(memory, 0xFF, sizeof(memory));
+
+    // 33 + 21 + 21 bytes, heights rounded up to whole pages
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        canvases[i] = pool.acquire(sizes[i][0], sizes[i][1]);
+
+        if (canvases[i] == NULL)
+        {
+            printf("# a canvas pool with %u bytes free couldn't hand out a %ux%u canvas\n", pool.bytes_free(), sizes[i][0], sizes[i][1]);
+            return errors + 1;
+        }
+    }
+
+    uint32_t used = 0;
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const uint8_t *start = canvases[i]->get_pixels() - 1;
+        uint32_t length = oled_canvas_pool::bytes_needed(sizes[i][0], sizes[i][1]);
+        bool cleared = true;
+
+        for (uint32_t byte = 1; byte < length; byte++)
+            cleared &= (start[byte] == 0);
+
+        if (start < memory || start + length > memory + sizeof(memory) || !cleared)
+        {
+            printf("# canvas %u from a pool is outside the arena or wasn't cleared\n", i);
+            errors++;
+        }
+
+        for (uint8_t j = 0; j < i; j++)
+        {
+            const uint8_t *other = canvases[j]->get_pixels() - 1;
+
+            if (start < other + oled_canvas_pool::bytes_needed(sizes[j][0], sizes[j][1]) && other < start + length)
+            {
+                printf("# canvases %u and %u from a pool share memory\n", j, i);
+                errors++;
+            }
+        }
+
+        used += length;
+    }
+
+    if (pool.bytes_free() != sizeof(memory) - used)
+    {
+        printf("# a canvas pool has %u bytes free after handing out %u, not %u\n", pool.bytes_free(), used, (uint32_t) (sizeof(memory) - used));
+        errors++;
+    }
+
+    // Drawing on one canvas leaves the others alone
+    canvases[1]->fill(1);
+
+    if (canvases[0]->get_pixels()[oled_canvas_pool::bytes_needed(16, 16) - 2] != 0 || canvases[2]->get_pixels()[0] != 0)
+    {
+        printf("# drawing on a pool canvas changed its neighbours\n");
+        errors++;
+    }
+
+    // Out of memory: 125 bytes are left, and a 128x8 canvas needs 129
+    if (pool.acquire(128, 8) != NULL)
+    {
+        printf("# a canvas pool handed out more memory than it has\n");
+        errors++;
+    }
+
+    uint32_t free_before = pool.bytes_free();
+
+    // Releasing older canvases frees their slots but not their memory, which sits below a canvas still in use
+    pool.release(canvases[1]);
+    pool.release(canvases[0]);
+
+    if (pool.bytes_free() != free_before)
+    {
+        printf("# releasing canvases below one still in use gave back %u bytes\n", pool.bytes_free() - free_before);
+        errors++;
+    }
+
+    // Releasing the newest gives back everything above the last canvas still in use, here all of it
+    pool.release(canvases[2]);
+
+    if (pool.bytes_free() != sizeof(memory))
+    {
+        printf("# a canvas pool has %u of %u bytes free after every canvas was released\n", pool.bytes_free(), (uint32_t) sizeof(memory));
+        errors++;
+    }
+
+    // Reused memory comes back cleared, including where canvas 1 was filled
+    oled_canvas *reused = pool.acquire(30, 16);
+    bool reused_cleared = (reused != NULL);
+
+    for (uint8_t byte = 0; reused_cleared && byte < 60; byte++)
+        reused_cleared = (reused->get_pixels()[byte] == 0);
+
+    if (!reused_cleared || reused->get_pixels() - 1 != memory)
+    {
+        printf("# a released canvas' memory wasn't handed out again, cleared\n");
+        errors++;
+    }
+
+    // Out of slots
+    pool.reset();
+    uint8_t handed_out = 0;
+
+    while (pool.acquire(1, 8) != NULL)
+        handed_out++;
+
+    if (handed_out != OLED_CANVAS_POOL_MAX || pool.bytes_free() != sizeof(memory) - OLED_CANVAS_POOL_MAX * oled_canvas_pool::bytes_needed(1, 8))
+    {
+        printf("# a canvas pool handed out %u canvases, not its %u slots\n", handed_out, OLED_CANVAS_POOL_MAX);
+        errors++;
+    }
+
+    // Out of memory, after reset() gave everything back
+    pool.reset();
+    handed_out = 0;
+
+    while (pool.acquire(64, 16) != NULL)
+        handed_out++;
+
+    if (handed_out != sizeof(memory) / oled_canvas_pool::bytes_needed(64, 16))
+    {
+        printf("# a %u byte canvas pool handed out %u 64x16 canvases after reset()\n", (uint32_t) sizeof(memory), handed_out);
+        errors++;
+    }
+
+    return errors;
+}
+
+
+// Changed columns on one page, for check_shadow_windows()
+struct shadow_change
+{
+    uint8_t page;
+    uint8_t x1;
+    uint8_t x2;
+};
+
+// Changes to one frame and the windows (x1, page1, x2, page2) OLED_UPDATE_SHADOW should send them in
+struct shadow_case
+{
+    const char *name;
+    shadow_change changes[2];
+    uint8_t window_count;
+    uint8_t windows[2][4];
+};
+
+
+/// @brief Check the windows OLED_UPDATE_SHADOW sends changes in. A gap on a page is resent when it costs no more than
+///        a new window and row (OLED_WINDOW_COST + OLED_ROW_COST bytes), and a page's changes join the window of the
+///        page above when the merged window costs no more than sending both
+/// @return number of checks that failed
+static uint32_t check_shadow_windows()
+{
+    static const shadow_case cases[] =
+    {
+        {"a 13 column gap", {{0, 10, 10}, {0, 24, 24}}, 1, {{10, 0, 24, 0}}},
+        {"a 14 column gap", {{0, 10, 10}, {0, 25, 25}}, 2, {{10, 0, 10, 0}, {25, 0, 25, 0}}},
+        {"overlapping columns on the page below", {{0, 10, 20}, {1, 12, 18}}, 1, {{10, 0, 20, 1}}},
+        {"distant columns on the page below", {{0, 0, 4}, {1, 100, 104}}, 2, {{0, 0, 4, 0}, {100, 1, 104, 1}}},
+        {"a page between the changes", {{0, 10, 10}, {2, 10, 10}}, 2, {{10, 0, 10, 0}, {10, 2, 10, 2}}},
+        {"a merge costing as much as two windows", {{3, 0, 0}, {4, 5, 5}}, 1, {{0, 3, 5, 4}}},
+        {"a merge costing 2 bytes more than two windows", {{3, 0, 0}, {4, 6, 6}}, 2, {{0, 3, 0, 3}, {6, 4, 6, 4}}},
+    };
+    static uint8_t before[DISPLAY_WIDTH * DISPLAY_HEIGHT / OLED_PAGE_HEIGHT];
+    oled_record_transport bus;
+    pico_oled target(OLED_SSD1306, &bus, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    uint32_t errors = 0;
+
+    target.set_update_mode(OLED_UPDATE_SHADOW);
+    target.oled_init();
+    target.render();
+
+    for (const shadow_case &test : cases)
+    {
+        for (const shadow_change &change : test.changes)
+            target.draw_line(change.x1, change.page * OLED_PAGE_HEIGHT, change.x2, change.page * OLED_PAGE_HEIGHT);
+
+        memcpy(before, target.get_pixels(), sizeof(before));
+        bus.clear_calls();
+        target.render();
+
+        // Window commands, each followed by that window's bytes of the frame
+        std::vector<uint8_t> expected, sent;
+
+        for (uint8_t i = 0; i < test.window_count; i++)
+        {
+            const uint8_t *window = test.windows[i];
+            const uint8_t window_cmds[] = {0x21, window[0], window[2], 0x22, window[1], window[3]};
+
+            expected.insert(expected.end(), window_cmds, window_cmds + sizeof(window_cmds));
+
+            for (uint8_t page = window[1]; page <= window[3]; page++)
+                expected.insert(expected.end(), &before[window[0] + page*DISPLAY_WIDTH], &before[window[2] + 1 + page*DISPLAY_WIDTH]);
+        }
+
+        for (const oled_record_call &call : bus.get_calls())
+            sent.insert(sent.end(), call.bytes.begin(), call.bytes.end());
+
+        if (sent != expected)
+        {
+            printf("# %s wasn't sent as", test.name);
+
+            for (uint8_t i = 0; i < test.window_count; i++)
+                printf(" %u,%u-%u,%u", test.windows[i][0], test.windows[i][1], test.windows[i][2], test.windows[i][3]);
+
+            printf(", sent:");
+
+            for (const oled_record_call &call : bus.get_calls())
+            {
+                if (call.kind == OLED_RECORD_CMD && call.bytes.size() == 6)
+                    printf(" %u,%u-%u,%u", call.bytes[1], call.bytes[4], call.bytes[2], call.bytes[5]);
+            }
+
+            printf("\n");
+            errors++;
+        }
+
+        // Back to a blank frame for the next case
+        target.fill(0);
+        target.render();
+    }
+
+    return errors;
+}
+
+
+/// @brief Run a function with stdout going to a temporary file
+/// @return everything the function printed
+static std::string capture_stdout(void (*print)())
+{
+    std::string output;
+    FILE *capture = tmpfile();
+    int saved = dup(fileno(stdout));
+
+    fflush(stdout);
+    dup2(fileno(capture), fileno(stdout));
+    print();
+    fflush(stdout);
+    dup2(saved, fileno(stdout));
+    close(saved);
+
+    rewind(capture);
+
+    for (int c = fgetc(capture); c != EOF; c = fgetc(capture))
+        output += (char) c;
+
+    fclose(capture);
+    return output;
+}
+
+
+/// @brief Check the drawing profile after a known set of calls: each primitive counts its own calls, including ones
+///        made by other primitives, GFX_PROFILE_SCOPE() times its scope, and gfx_profile_dump() lists exactly the
+///        primitives that were called. Without GFX_PROFILE nothing is counted and the dump says how to turn it on
+/// @return number of checks that failed
+static uint32_t check_profile()
+{
+    static uint8_t memory[32 * 2 + 1];
+    oled_canvas canvas(memory, 32, 16);
+    uint32_t errors = 0;
+
+    gfx_profile_reset();
+
+    for (uint8_t i = 0; i < 7; i++)
+        canvas.draw_pixel(i, i);
+
+    canvas.fill_rect(0, 0, 0, 9, 9);
+    canvas.fill_rect(1, 2, 2, 5, 5);
+    canvas.fill_rect_op(OLED_OP_INVERT, 0, 0, 31, 15);
+
+    // Each box draws two horizontal and two vertical lines
+    canvas.draw_box(0, 0, 9, 9);
+    canvas.draw_box(10, 2, 20, 12);
+
+    // Scopes of at least 50 us
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        GFX_PROFILE_SCOPE(GFX_PROF_GAUGE_DRAW);
+        sleep_us(50);
+    }
+
+    uint32_t expected[GFX_PROF_COUNT] = {0};
+
+#ifdef GFX_PROFILE
+    expected[GFX_PROF_DRAW_PIXEL] = 7;
+    expected[GFX_PROF_FILL_RECT] = 3;
+    expected[GFX_PROF_DRAW_BOX] = 2;
+    expected[GFX_PROF_DRAW_FAST_HLINE] = 4;
+    expected[GFX_PROF_DRAW_FAST_VLINE] = 4;
+    expected[GFX_PROF_GAUGE_DRAW] = 3;
+#endif
+
+    for (uint8_t id = 0; id < GFX_PROF_COUNT; id++)
+    {
+        const gfx_profile_entry *entry = gfx_profile_get((gfx_profile_id) id);
+        uint32_t bucketed = 0;
+
+        for (uint8_t bucket = 0; bucket < GFX_PROFILE_BUCKETS; bucket++)
+            bucketed += entry->histogram[bucket];
+
+        if (entry->calls != expected[id] || bucketed != entry->calls || (entry->calls > 0 && entry->min_ticks > entry->max_ticks))
+        {
+            printf("# %s counted %u calls (%u in the histogram) instead of %u\n", gfx_profile_name((gfx_profile_id) id), entry->calls,
+                bucketed, expected[id]);
+            errors++;
+        }
+    }
+
+#ifdef GFX_PROFILE
+    // Host ticks are nanoseconds
+    if (gfx_profile_get(GFX_PROF_GAUGE_DRAW)->min_ticks < 50000)
+    {
+        printf("# a scope that slept 50 us was timed at %u ns\n", gfx_profile_get(GFX_PROF_GAUGE_DRAW)->min_ticks);
+        errors++;
+    }
+#endif
+
+    std::string dump = capture_stdout(gfx_profile_dump);
+
+    for (uint8_t id = 0; id < GFX_PROF_COUNT; id++)
+    {
+        // Each table row starts with the padded name and then the call count
+        char row[64];
+        snprintf(row, sizeof(row), "\n%-32s %10u ", gfx_profile_name((gfx_profile_id) id), expected[id]);
+        bool listed = dump.find(row) != std::string::npos;
+
+        if (listed != (expected[id] > 0))
+        {
+            printf("# gfx_profile_dump() %s %s\n", listed ? "listed" : "left out", gfx_profile_name((gfx_profile_id) id));
+            errors++;
+        }
+    }
+
+#ifndef GFX_PROFILE
+    if (dump.find("GFX_PROFILE") == std::string::npos)
+    {
+        printf("# gfx_profile_dump() without GFX_PROFILE didn't say how to turn profiling on\n");
+        errors++;
+    }
+#endif
+
+    gfx_profile_reset();
+
+    if (gfx_profile_get(GFX_PROF_DRAW_PIXEL)->calls != 0)
+    {
+        printf("# gfx_profile_reset() left %u draw_pixel calls\n", gfx_profile_get(GFX_PROF_DRAW_PIXEL)->calls);
+        errors++;
+    }
+
+    return errors;
+}
+
+
+struct test_case
+{
+    const char *name;
+    uint32_t (*check)();
+};
+
+static const test_case tests[] =
+{
+    {"fill_rect", check_fill_rect},
+    {"invert_undraw", check_invert_undraw},
+    {"clipping", check_clipping},
+    {"sprites", check_sprites},
+    {"blit", check_blit},
+    {"packed", check_packed},
+    {"window", check_window},
+    {"init", check_init},
+    {"triple_buffer", check_triple_buffer},
+    {"async", check_async},
+    {"scheduler", check_scheduler},
+    {"telemetry", check_telemetry},
+    {"pio", check_pio},
+    {"static", check_static},
+    {"display_list", check_display_list},
+    {"i2c_nack", check_i2c_nack},
+    {"render_group", check_render_group},
+    {"canvas_pool", check_canvas_pool},
+    {"shadow_windows", check_shadow_windows},
+    {"profile", check_profile},
+};
+
+
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 1) ? argv[1] : NULL;
+    uint32_t failed = 0;
+    uint32_t run = 0;
+
+    display.oled_init();
+
+    gauge.set_position(63, 63);
+    gauge.set_scale(/*scale_min=*/ 0, /*scale_max=*/ 100, /*scale_start_deg=*/ 220, /*scale_end_deg=*/ 320);
+    gauge.set_markers(/*scale_divisions=*/ 3, /*needle_len=*/ 45, /*marker_len=*/ 15, /*half_divisions=*/ 1);
+    gauge.set_value(70);
+
+    for (uint8_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+    {
+        if (name != NULL && strcmp(name, tests[i].name) != 0)
+            continue;
+
+        uint32_t errors = tests[i].check();
+        printf("%s: %s\n", tests[i].name, errors ? "FAILED" : "ok");
+
+        failed += errors ? 1 : 0;
+        run++;
+    }
+
+    if (run == 0)
+    {
+        printf("# no check called '%s'\n", name);
+        return 1;
+    }
+
+    return failed ? 1 : 0;
+}
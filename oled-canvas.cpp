@@ -0,0 +1,1897 @@
+#include "oled-canvas.hpp"
+#include "oled-raster.hpp"
+#include "oled-sprite.hpp"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+#include <new>
+#include "pico/float.h"
+#include "gfx_font.h"
+#include "gfx-profile.hpp"
+
+
+//#define GFX_DEBUG
+
+#define PRINT_NUM_BUFFER 30     // Length of temporary buffers for printing numbers
+
+// Run the version of a drawing kernel compiled for the canvas width when the canvas has one, see fixed_stride
+#define STRIDE_DISPATCH(kernel, ...) \
+    do \
+    { \
+        if (fixed_stride == OLED_FIXED_STRIDE) \
+            kernel<OLED_FIXED_STRIDE>(__VA_ARGS__); \
+        else \
+            kernel<0>(__VA_ARGS__); \
+    } while (0)
+
+
+/// @brief Draw into a page format buffer
+/// @param buffer (canvas_height / 8) * canvas_width + 1 bytes: a header byte followed by the pixel data
+/// @param canvas_width width in pixels
+/// @param canvas_height height in pixels, a multiple of 8
+oled_canvas::oled_canvas(uint8_t *buffer, uint8_t canvas_width, uint8_t canvas_height)
+{
+    oled_width = canvas_width;
+    oled_height = canvas_height;
+
+    screen_buf_length = (oled_height / OLED_PAGE_HEIGHT) * oled_width + 1;
+    screen_buffer = buffer;
+    screen_buffer[0] = 0;
+
+    // Buffer holds the whole canvas, and everything is drawn
+    buffer_page1 = 0;
+    buffer_page2 = oled_height / OLED_PAGE_HEIGHT - 1;
+    clip_page1 = buffer_page1;
+    clip_page2 = buffer_page2;
+
+    // No clip rectangle and no offset
+    origin_x = 0;
+    origin_y = 0;
+    reset_clip_rect();
+
+    // Drawing calls are carried out straight away
+    display_list = NULL;
+
+    // Width only known at run time, unless a pico_oled_static says otherwise
+    fixed_stride = 0;
+
+    // Indicate that font has not been set yet
+    font_set = 0;
+
+    // Set cursor default position to something reasonable
+    cursor_x = 0;
+    cursor_y = 10;
+
+    pixel_counter = 0;
+
+    // Drawing turns pixels on
+    set_draw_mode(OLED_OP_SET);
+
+    // Nothing drawn yet
+    last_fill = 0;
+    ink_x1 = 0xFF;
+    ink_x2 = 0;
+    ink_page1 = 0xFF;
+    ink_page2 = 0;
+    clear_dirty();
+}
+
+
+/// @brief Make the buffer hold only some pages of the canvas, e.g. one strip of a display drawn a page at a time.
+///        Drawing calls still take canvas coordinates, and anything outside these pages is clipped.
+/// @param page1 first page held in the buffer
+/// @param page2 last page held in the buffer. The buffer must have room for (page2 - page1 + 1) pages
+void oled_canvas::set_buffer_pages(uint8_t page1, uint8_t page2)
+{
+    buffer_page1 = page1;
+    buffer_page2 = page2;
+    clip_page1 = page1;
+    clip_page2 = page2;
+    screen_buf_length = (page2 - page1 + 1) * oled_width + 1;
+
+    update_clip();
+}
+
+
+/// @brief Limit drawing to some of the pages held in the buffer
+/// @param page1 first page that can be drawn on
+/// @param page2 last page that can be drawn on
+void oled_canvas::set_clip_pages(uint8_t page1, uint8_t page2)
+{
+    clip_page1 = (page1 > buffer_page1) ? page1 : buffer_page1;
+    clip_page2 = (page2 < buffer_page2) ? page2 : buffer_page2;
+
+    update_clip();
+}
+
+
+/// @brief Limit drawing to a rectangle of the canvas. The rectangle is in canvas pixels, set_origin() doesn't move it.
+///        fill() still fills the whole canvas.
+/// @param x1 left edge, drawn on
+/// @param y1 top edge, drawn on
+/// @param x2 right edge, drawn on
+/// @param y2 bottom edge, drawn on
+void oled_canvas::set_clip_rect(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    int16_t corners[] = {x1, y1, x2, y2};
+
+    // A rectangle entirely above or left of the canvas clips everything
+    if (x2 < 0 || y2 < 0 || x1 > x2 || y1 > y2)
+    {
+        corners[0] = 0xFF;
+        corners[1] = 0xFF;
+        corners[2] = 0;
+        corners[3] = 0;
+    }
+
+    for (uint8_t i = 0; i < 4; i++)
+        clip_rect[i] = (corners[i] < 0) ? 0 : (corners[i] > 0xFF) ? 0xFF : corners[i];
+
+    update_clip();
+}
+
+
+/// @brief Allow drawing on the whole canvas again
+void oled_canvas::reset_clip_rect()
+{
+    clip_rect[0] = 0;
+    clip_rect[1] = 0;
+    clip_rect[2] = 0xFF;
+    clip_rect[3] = 0xFF;
+
+    update_clip();
+}
+
+
+/// @brief Work out the pixels that can be drawn on from the clip rectangle, the canvas size and the clip pages
+void oled_canvas::update_clip()
+{
+    int16_t page_top = clip_page1 * OLED_PAGE_HEIGHT;
+    int16_t page_bottom = clip_page2 * OLED_PAGE_HEIGHT + OLED_PAGE_HEIGHT - 1;
+
+    clip_x1 = clip_rect[0];
+    clip_y1 = (clip_rect[1] > page_top) ? clip_rect[1] : page_top;
+    clip_x2 = (clip_rect[2] < oled_width - 1) ? clip_rect[2] : oled_width - 1;
+    clip_y2 = (clip_rect[3] < page_bottom) ? clip_rect[3] : page_bottom;
+}
+
+
+/// @brief Clip a box to the pixels that can be drawn on
+/// @param x1 left edge, moved right to the clip region
+/// @param y1 top edge, moved down to the clip region
+/// @param x2 right edge, moved left to the clip region
+/// @param y2 bottom edge, moved up to the clip region
+/// @return false if none of the box can be drawn
+bool oled_canvas::clip_box(int16_t *x1, int16_t *y1, int16_t *x2, int16_t *y2)
+{
+    if (*x2 < clip_x1 || *x1 > clip_x2 || *y2 < clip_y1 || *y1 > clip_y2 || clip_x1 > clip_x2 || clip_y1 > clip_y2)
+        return false;
+
+    if (*x1 < clip_x1) *x1 = clip_x1;
+    if (*y1 < clip_y1) *y1 = clip_y1;
+    if (*x2 > clip_x2) *x2 = clip_x2;
+    if (*y2 > clip_y2) *y2 = clip_y2;
+
+    return true;
+}
+
+
+/// @brief Choose what drawing does to the pixels it touches. Applies to every drawing function except fill(),
+///        and to fill_rect() unless it is blanking. OLED_OP_INVERT (or OLED_OP_XOR) toggles pixels, so a cursor or
+///        needle drawn twice in the same place is erased without redrawing what was under it.
+/// @param op OLED_OP_SET (default) to turn pixels on, OLED_OP_CLEAR to turn them off, OLED_OP_INVERT to toggle them
+void oled_canvas::set_draw_mode(OLED_raster_op op)
+{
+    draw_op = op;
+    oled_op_bits(op, &op_clear, &op_toggle);
+}
+
+
+/// @brief Fill entire display with the specified byte
+/// @param fill value to set each column of 8 pixels to
+void oled_canvas::fill(uint8_t fill)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_FILL);
+
+    if (display_list != NULL)
+    {
+        uint8_t args[] = {fill};
+
+        if (record(OLED_LIST_FILL, 0, 0, oled_width - 1, oled_height / OLED_PAGE_HEIGHT - 1, args, sizeof(args)))
+            return;
+    }
+
+    // Only the pages that can be drawn on, normally the whole buffer
+    oled_span_fill(page_row(clip_page1), (clip_page2 - clip_page1 + 1) * oled_width, fill);
+
+    if (fill == last_fill)
+    {
+        // Only the area drawn since the last fill can differ from what the display already shows
+        if (ink_x1 <= ink_x2)
+            mark_dirty(ink_x1, ink_page1, ink_x2, ink_page2);
+    }
+    else
+    {
+        mark_dirty(0, 0, oled_width - 1, oled_height / OLED_PAGE_HEIGHT - 1);
+        last_fill = fill;
+    }
+
+    // Screen is uniform again, so nothing has been drawn over the fill yet
+    ink_x1 = 0xFF;
+    ink_x2 = 0;
+    ink_page1 = 0xFF;
+    ink_page2 = 0;
+}
+
+
+/// @brief Copy a block from the source src_bitmap to the screen buffer. The part outside the clip region is left out.
+/// @param src_bitmap bitmap data
+/// @param src_width width of the entire source bitmap
+/// @param src_x source x coordinate to copy from
+/// @param src_y source y coordinate to copy from
+/// @param blit_width width of region to copy
+/// @param blit_height height of region to copy
+/// @param screen_x screen x coordinate to draw at, may be off the canvas
+/// @param screen_y screen y coordinate to draw at, may be off the canvas
+void oled_canvas::blit_screen(const uint8_t *src_bitmap, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height, int16_t screen_x, int16_t screen_y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_BLIT_SCREEN);
+
+    blit_planes(src_bitmap, NULL, src_width, src_x, src_y, blit_width, blit_height, screen_x, screen_y);
+}
+
+
+/// @brief Copy a block of a bitmap with a mask plane to the screen buffer: pixels lit in the mask are replaced by
+///        the bitmap's, the others are left alone, whatever the draw mode. Draws over existing graphics without
+///        clearing the area first. The part outside the clip region is left out.
+/// @param src_bitmap bitmap data
+/// @param src_mask mask data, laid out like the bitmap
+/// @param src_width width of the entire source bitmap and mask
+/// @param src_x source x coordinate to copy from
+/// @param src_y source y coordinate to copy from
+/// @param blit_width width of region to copy
+/// @param blit_height height of region to copy
+/// @param screen_x screen x coordinate to draw at, may be off the canvas
+/// @param screen_y screen y coordinate to draw at, may be off the canvas
+void oled_canvas::blit_masked(const uint8_t *src_bitmap, const uint8_t *src_mask, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height,
+    int16_t screen_x, int16_t screen_y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_BLIT_MASKED);
+
+    blit_planes(src_bitmap, src_mask, src_width, src_x, src_y, blit_width, blit_height, screen_x, screen_y);
+}
+
+
+/// @brief Draw the whole of another canvas, e.g. a pre-rendered widget. Its lit pixels are drawn in the draw mode.
+///        Display lists compare its pixels as well, since it can be drawn on between frames
+/// @param src canvas to draw
+/// @param screen_x screen x coordinate to draw at, may be off the canvas
+/// @param screen_y screen y coordinate to draw at, may be off the canvas
+void oled_canvas::draw_canvas(const oled_canvas *src, int16_t screen_x, int16_t screen_y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_BLIT_SCREEN);
+
+    blit_planes(src->get_pixels(), NULL, src->oled_width, 0, 0, src->oled_width, src->oled_height, screen_x, screen_y, true);
+}
+
+
+/// @brief Blit one or two planes, see blit_screen() and blit_masked()
+/// @param src_mask mask plane, or NULL to draw the bitmap in the draw mode
+/// @param hash_source true if the source can change between frames, so display lists compare its pixels
+void oled_canvas::blit_planes(const uint8_t *src_bitmap, const uint8_t *src_mask, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height,
+    int16_t screen_x, int16_t screen_y, bool hash_source)
+{
+    STRIDE_DISPATCH(planes_kernel, src_bitmap, src_mask, src_width, src_x, src_y, blit_width, blit_height, screen_x, screen_y, hash_source);
+}
+
+
+/// @brief blit_planes() for a canvas Stride bytes wide, or oled_width wide when Stride is 0
+template <uint8_t Stride>
+void oled_canvas::planes_kernel(const uint8_t *src_bitmap, const uint8_t *src_mask, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height,
+    int16_t screen_x, int16_t screen_y, bool hash_source)
+{
+    if (blit_width == 0 || blit_height == 0)
+        return;
+
+    screen_x += origin_x;
+    screen_y += origin_y;
+
+    // Part of the blit that can be drawn
+    int16_t left = screen_x;
+    int16_t top = screen_y;
+    int16_t right = screen_x + blit_width - 1;
+    int16_t bottom = screen_y + blit_height - 1;
+
+    if (!clip_box(&left, &top, &right, &bottom))
+        return;
+
+    if (display_list != NULL && record_blit(src_bitmap, src_mask, src_width, src_x, src_y, blit_width, blit_height, screen_x, screen_y, left, top, right, bottom,
+        hash_source))
+        return;
+
+    mark_dirty(left, top / OLED_PAGE_HEIGHT, right, bottom / OLED_PAGE_HEIGHT);
+
+    // Blit only the visible part, so nothing below has to check bounds
+    uint16_t src_top = src_y + (top - screen_y);
+    uint8_t src_last_page = (src_top + (bottom - top)) / OLED_PAGE_HEIGHT;
+    const uint8_t *src_columns = &src_bitmap[src_x + (left - screen_x)];
+    uint8_t count = right - left + 1;
+    uint8_t first_page = top / OLED_PAGE_HEIGHT;
+    uint8_t last_page = bottom / OLED_PAGE_HEIGHT;
+
+    // Source row that lines up with the top row of the first page, at most 7 rows above the source. Every page
+    // takes its rows from this source page and the one after it, moved up by the same shift
+    int16_t src_row = src_top - top % OLED_PAGE_HEIGHT;
+    uint8_t shift = src_row & (OLED_PAGE_HEIGHT - 1);
+    int16_t src_page = (src_row - shift) / OLED_PAGE_HEIGHT;
+
+#ifdef GFX_DEBUG
+    printf("\n\nBlit of %dx%d from source row %d, to screen pages %d-%d, source page %d, shift %d\n", count, bottom - top + 1, src_top, first_page, last_page, src_page, shift);
+#endif
+
+    for (uint8_t page = first_page; page <= last_page; page++, src_page++)
+    {
+        // Rows clipped off the first and last page
+        uint8_t mask = 0xFF;
+
+        if (page == first_page)
+            mask &= 0xFF << (top % OLED_PAGE_HEIGHT);
+
+        if (page == last_page)
+            mask &= 0xFF >> (OLED_PAGE_HEIGHT - 1 - bottom % OLED_PAGE_HEIGHT);
+
+        uint8_t *dest = &page_row<Stride>(page)[left];
+
+        // Masked: a source page outside the source is stood in for by the other one, its rows are masked off
+        if (src_mask != NULL)
+        {
+            uint32_t lo = ((src_page >= 0) ? src_page : src_page + 1) * src_width;
+            uint32_t hi = ((src_page < src_last_page) ? src_page + 1 : src_page) * src_width;
+            const uint8_t *mask_columns = &src_mask[src_x + (left - screen_x)];
+
+            oled_mask_span16(dest, &src_columns[lo], &src_columns[hi], &mask_columns[lo], &mask_columns[hi], count, shift, mask);
+            continue;
+        }
+
+        // Page aligned: straight copy of one source page
+        if (shift == 0)
+        {
+            oled_blit_span(dest, &src_columns[src_page * src_width], count, mask, 0, 0, draw_op);
+            continue;
+        }
+
+        // Both source pages are inside the source: shift the pair as one 16-bit column
+        if (src_page >= 0 && src_page < src_last_page)
+        {
+            const uint8_t *src_lo = &src_columns[src_page * src_width];
+            oled_blit_span16(dest, src_lo, src_lo + src_width, count, shift, mask, draw_op);
+        }
+        // Bottom of the blit, the rows from the page after the source's last page are all masked off
+        else if (src_page >= 0)
+        {
+            oled_blit_span(dest, &src_columns[src_page * src_width], count, mask << shift, 0, shift, draw_op);
+        }
+        // Top of the blit, starting above the source
+        else
+        {
+            oled_blit_span(dest, src_columns, count, mask >> (OLED_PAGE_HEIGHT - shift), OLED_PAGE_HEIGHT - shift, 0, draw_op);
+        }
+    }
+}
+
+
+/// @brief Draw a pre-shifted bitmap. Every page byte is a masked OR (AND-NOT, XOR in the other draw modes) of a
+///        byte of the copy shifted to the sprite's row within the page, so nothing is shifted while drawing.
+/// @param image bitmap and its shifted copies
+/// @param screen_x screen x coordinate to draw at, may be off the canvas
+/// @param screen_y screen y coordinate to draw at, may be off the canvas
+void oled_canvas::draw_sprite(const oled_sprite_image *image, int16_t screen_x, int16_t screen_y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_SPRITE);
+
+    STRIDE_DISPATCH(sprite_kernel, image, screen_x, screen_y);
+}
+
+
+/// @brief draw_sprite() for a canvas Stride bytes wide, or oled_width wide when Stride is 0
+template <uint8_t Stride>
+void oled_canvas::sprite_kernel(const oled_sprite_image *image, int16_t screen_x, int16_t screen_y)
+{
+    uint8_t width = image->get_width();
+
+    // Display lists record the unshifted bitmap as a blit
+    if (display_list != NULL)
+    {
+        blit_screen(image->get_plane(0), width, 0, 0, width, image->get_height(), screen_x, screen_y);
+        return;
+    }
+
+    screen_x += origin_x;
+    screen_y += origin_y;
+
+    int16_t left = screen_x;
+    int16_t top = screen_y;
+    int16_t right = screen_x + width - 1;
+    int16_t bottom = screen_y + image->get_height() - 1;
+
+    if (width == 0 || !clip_box(&left, &top, &right, &bottom))
+        return;
+
+    uint8_t first_page = top / OLED_PAGE_HEIGHT;
+    uint8_t last_page = bottom / OLED_PAGE_HEIGHT;
+
+    mark_dirty(left, first_page, right, last_page);
+
+    // Copy shifted to the sprite's row within its page, starting at the first visible column. The sprite's
+    // first page may be above the canvas
+    uint8_t shift = screen_y & (OLED_PAGE_HEIGHT - 1);
+    int16_t sprite_page = (screen_y - shift) / OLED_PAGE_HEIGHT;
+    const uint8_t *src = image->get_plane(shift) + (left - screen_x) + (first_page - sprite_page) * width;
+    uint8_t count = right - left + 1;
+
+    for (uint8_t page = first_page; page <= last_page; page++)
+    {
+        // Rows clipped off the first and last page
+        uint8_t mask = 0xFF;
+
+        if (page == first_page)
+            mask &= 0xFF << (top % OLED_PAGE_HEIGHT);
+
+        if (page == last_page)
+            mask &= 0xFF >> (OLED_PAGE_HEIGHT - 1 - bottom % OLED_PAGE_HEIGHT);
+
+        oled_blit_span(&page_row<Stride>(page)[left], src, count, mask, 0, 0, draw_op);
+        src += width;
+    }
+}
+
+
+/// @brief Draw a packed bitmap, decoding it straight into the screen buffer. Its lit pixels are drawn in the draw mode,
+///        like draw_bmp(). The part outside the clip region is skipped over without being drawn.
+/// @param src bitmap made by oled-pack.py
+/// @param screen_x screen x coordinate to draw at, may be off the canvas
+/// @param screen_y screen y coordinate to draw at, may be off the canvas
+void oled_canvas::draw_packed(const packed_bitmap &src, int16_t screen_x, int16_t screen_y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_PACKED);
+
+    blit_packed(src.data, src.format, 0, src.width, src.height, screen_x, screen_y);
+}
+
+
+/// @brief Draw packed page format data, see draw_packed(). Each decoded source page is split across the two screen
+///        pages it lands on as it is read, so only the pages and columns inside the clip region are drawn
+/// @param data packed data
+/// @param format OLED_pack_format of the data
+/// @param start offset of the bitmap's first token in the data
+/// @param width width of the bitmap, bytes per page
+/// @param height rows of the bitmap to draw
+void oled_canvas::blit_packed(const uint8_t *data, uint8_t format, uint16_t start, uint16_t width, uint16_t height, int16_t screen_x, int16_t screen_y)
+{
+    STRIDE_DISPATCH(packed_kernel, data, format, start, width, height, screen_x, screen_y);
+}
+
+
+/// @brief blit_packed() for a canvas Stride bytes wide, or oled_width wide when Stride is 0
+template <uint8_t Stride>
+void oled_canvas::packed_kernel(const uint8_t *data, uint8_t format, uint16_t start, uint16_t width, uint16_t height, int16_t screen_x, int16_t screen_y)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    screen_x += origin_x;
+    screen_y += origin_y;
+
+    int16_t left = screen_x;
+    int16_t top = screen_y;
+    int16_t right = screen_x + width - 1;
+    int16_t bottom = screen_y + height - 1;
+
+    if (!clip_box(&left, &top, &right, &bottom))
+        return;
+
+    // Packed data can't change, so the arguments are all a display list needs to know
+    if (display_list != NULL)
+    {
+        uint8_t args[sizeof(data) + 12];
+
+        memcpy(args, &data, sizeof(data));
+        uint8_t *arg = args + sizeof(data);
+
+        *arg++ = start;
+        *arg++ = start >> 8;
+        *arg++ = format;
+        *arg++ = width;
+        *arg++ = width >> 8;
+        *arg++ = height;
+        *arg++ = height >> 8;
+        *arg++ = screen_x;
+        *arg++ = screen_x >> 8;
+        *arg++ = screen_y;
+        *arg++ = screen_y >> 8;
+
+        if (record(OLED_LIST_PACKED, left, top / OLED_PAGE_HEIGHT, right, bottom / OLED_PAGE_HEIGHT, args, arg - args))
+            return;
+    }
+
+    uint8_t first_page = top / OLED_PAGE_HEIGHT;
+    uint8_t last_page = bottom / OLED_PAGE_HEIGHT;
+
+    mark_dirty(left, first_page, right, last_page);
+
+    // Source page p lands on screen page base_page + p moved down by shift rows, the rows pushed out of the
+    // bottom land on the page after it. The bitmap's first page may be above the canvas
+    uint8_t shift = screen_y & (OLED_PAGE_HEIGHT - 1);
+    int16_t base_page = (screen_y - shift) / OLED_PAGE_HEIGHT;
+    int16_t src_first = first_page - base_page - ((shift != 0) ? 1 : 0);
+    int16_t src_last = last_page - base_page;
+
+    if (src_first < 0)
+        src_first = 0;
+
+    if (src_last > (int16_t) ((height - 1) / OLED_PAGE_HEIGHT))
+        src_last = (height - 1) / OLED_PAGE_HEIGHT;
+
+    uint16_t skip_left = left - screen_x;
+    uint8_t count = right - left + 1;
+    uint16_t skip_right = width - skip_left - count;
+
+    oled_unpacker unpacker(data, format, start);
+    unpacker.skip((uint32_t) src_first * width);
+
+    for (int16_t src_page = src_first; src_page <= src_last; src_page++)
+    {
+        // Source rows drawn on the page the source page starts on, and on the page below it
+        uint8_t upper = 0, lower = 0;
+
+        for (uint8_t half = 0; half < 2; half++)
+        {
+            int16_t page = base_page + src_page + half;
+
+            if (page < first_page || page > last_page)
+                continue;
+
+            // Rows clipped off the first and last page
+            uint8_t mask = 0xFF;
+
+            if (page == first_page)
+                mask &= 0xFF << (top % OLED_PAGE_HEIGHT);
+
+            if (page == last_page)
+                mask &= 0xFF >> (OLED_PAGE_HEIGHT - 1 - bottom % OLED_PAGE_HEIGHT);
+
+            if (half == 0)
+                upper = mask >> shift;
+            else if (shift != 0)
+                lower = mask << (OLED_PAGE_HEIGHT - shift);
+        }
+
+        uint8_t *upper_dest = (upper != 0) ? &page_row<Stride>(base_page + src_page)[left] : NULL;
+        uint8_t *lower_dest = (lower != 0) ? &page_row<Stride>(base_page + src_page + 1)[left] : NULL;
+
+        unpacker.skip(skip_left);
+
+        for (uint8_t column = 0; column < count; )
+        {
+            const uint8_t *src;
+            uint8_t value;
+            uint8_t step = unpacker.read(count - column, &src, &value);
+
+            if (src != NULL)
+            {
+                if (upper_dest != NULL)
+                    oled_blit_span(upper_dest + column, src, step, upper, shift, 0, draw_op);
+
+                if (lower_dest != NULL)
+                    oled_blit_span(lower_dest + column, src, step, lower, 0, OLED_PAGE_HEIGHT - shift, draw_op);
+            }
+            else
+            {
+                // Runs are mostly blank, and draw nothing
+                uint8_t upper_bits = (uint8_t) ((value & upper) << shift);
+                uint8_t lower_bits = (value & lower) >> (OLED_PAGE_HEIGHT - shift);
+
+                if (upper_bits != 0)
+                    oled_span_apply(upper_dest + column, step, ~(upper_bits & op_clear), upper_bits & op_toggle);
+
+                if (lower_bits != 0)
+                    oled_span_apply(lower_dest + column, step, ~(lower_bits & op_clear), lower_bits & op_toggle);
+            }
+
+            column += step;
+        }
+
+        if (src_page < src_last)
+            unpacker.skip(skip_right);
+    }
+}
+
+
+/// @brief Set the font to use for subsequent print calls
+/// @param new_font font to use
+void oled_canvas::set_font(gfx_font new_font)
+{
+    font = new_font;
+    font_set = 1;
+}
+
+
+/// @brief Draw a single character at the specified position. Font must be previously set.
+/// @param char_c character to draw
+/// @param x_pos screen x position
+/// @param y_pos screen y position
+void oled_canvas::draw_char(uint8_t char_c, int16_t x_pos, int16_t y_pos)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_CHAR);
+
+    // Abort if the char is not within the drawable range
+    // if (char_c > font.last || char_c < font.first)
+    //     return;
+
+#ifdef GFX_DEBUG            
+    printf("Character: %c, src_x: %d\n", char_c, font.character[char_c].bitmap_x);
+#endif
+    
+    char_c -= font.first;     // First character is element 0 of table
+
+    // Packed fonts keep each character as its own packed bitmap
+    if (font.bitmap == NULL)
+    {
+        const gfx_char *character = &font.character[char_c];
+        blit_packed(font.packed, font.packed_format, font.packed_offsets[char_c], character->width, character->height, x_pos + character->x_offset, y_pos + character->y_offset);
+        return;
+    }
+
+    blit_screen(font.bitmap, font.src_width, font.character[char_c].bitmap_x, 0, font.character[char_c].width, font.character[char_c].height, x_pos + font.character[char_c].x_offset, y_pos + font.character[char_c].y_offset);
+}
+
+
+/// @brief Print a basic string. Only basic character drawing is supported, control characters have no effect
+/// @param print_str string to print
+void oled_canvas::print(const char *print_str)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_PRINT);
+
+    // Abort if no font has been set yet
+    if (!font_set)
+        return;
+
+    uint16_t length = strlen(print_str);
+
+    if (display_list != NULL && record_text(print_str, length))
+        return;
+
+    print_chars(print_str, length, NULL);
+}
+
+
+/// @brief Print characters at the cursor and move the cursor past them, or only find where they would be drawn
+/// @param text characters to print, not necessarily ending in '\0'
+/// @param length number of characters
+/// @param box NULL to draw the characters. Otherwise the canvas area x1, y1, x2, y2 to grow to take in every
+///        character, which are not drawn
+void oled_canvas::print_chars(const char *text, uint16_t length, int16_t *box)
+{
+    int16_t start_x = cursor_x;
+
+    for (; length > 0; length--, text++)
+    {
+        // Draw character if it's valid
+        if (*text <= font.last && *text >= font.first)
+        {
+            const gfx_char *character = &font.character[*text - font.first];
+
+            // If character would be drawn over the edge of the screen
+            if (character->width + cursor_x >= oled_width)
+            {      
+                // Reposition cursor at the left edge of the screen, one line down
+                cursor_x = 0;
+                cursor_y += font.line_height;
+            }
+
+            if (box == NULL)
+            {
+                draw_char(*text, cursor_x, cursor_y);
+            }
+            else if (character->width > 0 && character->height > 0)
+            {
+                int16_t x = cursor_x + character->x_offset + origin_x;
+                int16_t y = cursor_y + character->y_offset + origin_y;
+
+                if (x < box[0]) box[0] = x;
+                if (y < box[1]) box[1] = y;
+                if (x + character->width - 1 > box[2]) box[2] = x + character->width - 1;
+                if (y + character->height - 1 > box[3]) box[3] = y + character->height - 1;
+            }
+
+            cursor_x += character->x_advance;
+        }
+        else if (*text == '\n')
+        {
+            // Reposition cursor one line down, at the x coordinate where printing started
+            cursor_x = start_x;
+            cursor_y += font.line_height;            
+        }
+        else if (*text == '\r')
+        {
+            // Reposition cursor back to the left edge of the screen
+            cursor_x = 0;
+        }
+    }
+}
+
+
+/// @brief Print numbers by outsourcing formatting to sprintf()
+/// @param format_str printf style format string
+/// @param print_data number to print
+void oled_canvas::print_num(const char *format_str, int32_t print_data)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_PRINT_NUM);
+
+    // Allocate a buffer big enough to hold the printed data
+    char output_buf[PRINT_NUM_BUFFER];
+    sprintf(output_buf, format_str, print_data);
+    print(output_buf);
+}
+
+
+/// @brief Print numbers by outsourcing formatting to sprintf()
+/// @param format_str printf style format string
+/// @param print_data number to print
+void oled_canvas::print_num(const char *format_str, uint32_t print_data)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_PRINT_NUM);
+
+    // Allocate a buffer big enough to hold the printed data
+    char output_buf[PRINT_NUM_BUFFER];
+    sprintf(output_buf, format_str, print_data);
+    print(output_buf);
+}
+
+
+/// @brief Print numbers by outsourcing formatting to sprintf()
+/// @param format_str printf style format string
+/// @param print_data number to print
+void oled_canvas::print_num(const char *format_str, float print_data)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_PRINT_NUM);
+
+    // Allocate a buffer big enough to hold the printed data
+    char output_buf[PRINT_NUM_BUFFER];
+    sprintf(output_buf, format_str, print_data);
+    print(output_buf);
+}
+
+
+/// @brief Print numbers by outsourcing formatting to sprintf()
+/// @param format_str printf style format string
+/// @param print_data number to print
+void oled_canvas::print_num(const char *format_str, uint8_t print_data)
+{
+    print_num(format_str, (uint32_t) print_data);
+}
+
+
+/// @brief Print numbers by outsourcing formatting to sprintf()
+/// @param format_str printf style format string
+/// @param print_data number to print
+void oled_canvas::print_num(const char *format_str, int8_t print_data)
+{
+    print_num(format_str, (int32_t) print_data);
+}
+
+
+/// @brief Print numbers by outsourcing formatting to sprintf()
+/// @param format_str printf style format string
+/// @param print_data number to print
+void oled_canvas::print_num(const char *format_str, uint16_t print_data)
+{
+    print_num(format_str, (uint32_t) print_data);
+}
+
+
+/// @brief Print numbers by outsourcing formatting to sprintf()
+/// @param format_str printf style format string
+/// @param print_data number to print
+void oled_canvas::print_num(const char *format_str, int16_t print_data)
+{
+    print_num(format_str, (int32_t) print_data);
+}
+
+
+/// @brief Draw a single pixel in the screen buffer
+/// @param x screen x position
+/// @param y screen y position
+void oled_canvas::draw_pixel(int16_t x, int16_t y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_PIXEL);
+
+    STRIDE_DISPATCH(pixel_kernel, x, y);
+}
+
+
+/// @brief draw_pixel() for a canvas Stride bytes wide, or oled_width wide when Stride is 0
+template <uint8_t Stride>
+void oled_canvas::pixel_kernel(int16_t x, int16_t y)
+{
+    x += origin_x;
+    y += origin_y;
+
+    // Abort if coordinates are outside the clip region
+    if (x < clip_x1 || x > clip_x2 || y < clip_y1 || y > clip_y2)
+        return;
+
+    uint8_t screen_page = y / OLED_PAGE_HEIGHT;
+
+    if (display_list != NULL)
+    {
+        uint8_t args[] = {(uint8_t) x, (uint8_t) y};
+
+        if (record(OLED_LIST_PIXEL, x, screen_page, x, screen_page, args, sizeof(args)))
+            return;
+    }
+
+    // Write to the column where the target pixel is
+    oled_byte_op(&page_row<Stride>(screen_page)[x], 1 << (y - screen_page*OLED_PAGE_HEIGHT), op_clear, op_toggle);
+    mark_dirty(x, screen_page, x, screen_page);
+}
+
+
+/// @brief Draw a single pixel every other time this function is called
+/// @param x screen x position
+/// @param y screen y position
+void oled_canvas::draw_pixel_alternating(int16_t x, int16_t y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_PIXEL_ALTERNATING);
+
+    if (pixel_counter++ > 0)
+    {
+        pixel_counter = 0;
+        draw_pixel(x, y);
+    }   
+}
+
+
+/// @brief Draw a line with the Bresenham algorithm
+/// @param x1 screen x position of line start
+/// @param y1 screen y position of line start
+/// @param x2 screen x position of line end
+/// @param y2 screen y position of line end
+void oled_canvas::draw_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_LINE);
+
+    // Draw straight lines with the fast function instead
+    if (y1 == y2)
+    {
+        draw_fast_hline(x1, x2, y1);
+        return;
+    }
+
+    if (x1 == x2)
+    {
+        draw_fast_vline(y1, y2, x1);
+        return;
+    }
+
+    raster_line(x1 + origin_x, y1 + origin_y, x2 + origin_x, y2 + origin_y, false);
+}
+
+
+/// @brief Draw a dotted line with the Bresenham algorithm
+/// @param x1 screen x position of line start
+/// @param y1 screen y position of line start
+/// @param x2 screen x position of line end
+/// @param y2 screen y position of line end
+void oled_canvas::draw_line_dotted(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_LINE_DOTTED);
+
+    raster_line(x1 + origin_x, y1 + origin_y, x2 + origin_x, y2 + origin_y, true);
+}
+
+
+/// @brief Draw a line in canvas coordinates, clipped to the clip region. The clipped part of the line is stepped
+///        over arithmetically, so the pixels drawn are exactly those of the whole line that are inside the clip region.
+/// @param x1 canvas x position of line start
+/// @param y1 canvas y position of line start
+/// @param x2 canvas x position of line end
+/// @param y2 canvas y position of line end
+/// @param dotted true to draw only every other pixel
+void oled_canvas::raster_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool dotted)
+{
+    STRIDE_DISPATCH(line_kernel, x1, y1, x2, y2, dotted);
+}
+
+
+/// @brief raster_line() for a canvas Stride bytes wide, or oled_width wide when Stride is 0
+template <uint8_t Stride>
+void oled_canvas::line_kernel(int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool dotted)
+{
+    int16_t left = (x1 < x2) ? x1 : x2;
+    int16_t top = (y1 < y2) ? y1 : y2;
+    int16_t right = (x1 > x2) ? x1 : x2;
+    int16_t bottom = (y1 > y2) ? y1 : y2;
+
+    // Skip lines entirely outside the clip region
+    if (!clip_box(&left, &top, &right, &bottom))
+        return;
+
+    if (display_list != NULL)
+    {
+        uint8_t args[] = {(uint8_t) x1, (uint8_t) (x1 >> 8), (uint8_t) y1, (uint8_t) (y1 >> 8),
+                          (uint8_t) x2, (uint8_t) (x2 >> 8), (uint8_t) y2, (uint8_t) (y2 >> 8)};
+
+        if (record(dotted ? OLED_LIST_LINE_DOTTED : OLED_LIST_LINE, left, top / OLED_PAGE_HEIGHT, right, bottom / OLED_PAGE_HEIGHT, args, sizeof(args)))
+            return;
+    }
+
+    // Step along the major axis a, the minor axis b follows
+    bool steep = abs(y2 - y1) > abs(x2 - x1);
+    int32_t a1 = steep ? y1 : x1;
+    int32_t b1 = steep ? x1 : y1;
+    int32_t a2 = steep ? y2 : x2;
+    int32_t b2 = steep ? x2 : y2;
+
+    // Switch coordinates around so that a1 < a2
+    if (a1 > a2)
+    {
+        int32_t tmp = a1;
+        a1 = a2;
+        a2 = tmp;
+
+        tmp = b1;
+        b1 = b2;
+        b2 = tmp;
+    }
+
+    uint32_t dx = a2 - a1;
+    uint32_t dy = abs(b2 - b1);
+    int8_t b_step = (b1 < b2) ? 1 : -1;
+    uint32_t p0 = dx / 2;
+
+    // Clip region along each axis
+    int32_t a_min = steep ? clip_y1 : clip_x1;
+    int32_t a_max = steep ? clip_y2 : clip_x2;
+    int32_t b_min = steep ? clip_x1 : clip_y1;
+    int32_t b_max = steep ? clip_x2 : clip_y2;
+
+    // Steps k of the line that are inside the clip region along the major axis
+    uint32_t k_first = (a_min > a1) ? a_min - a1 : 0;
+    uint32_t k_last = (a_max < a2) ? a_max - a1 : dx;
+
+    // Along the minor axis: after k steps, b has moved m_k = max(0, ceil((k*dy - p0) / dx)) times, and must have
+    // moved between m_min and m_max times to be inside
+    int32_t m_min = (b_step > 0) ? b_min - b1 : b1 - b_max;
+    int32_t m_max = (b_step > 0) ? b_max - b1 : b1 - b_min;
+
+    if (m_max < 0)
+        return;
+
+    if (m_min > 0)
+    {
+        if (dy == 0)
+            return;
+
+        uint32_t k = ((uint32_t) (m_min - 1) * dx + p0) / dy + 1;
+
+        if (k > k_first)
+            k_first = k;
+    }
+
+    if (dy > 0)
+    {
+        uint32_t k = ((uint32_t) m_max * dx + p0) / dy;
+
+        if (k < k_last)
+            k_last = k;
+    }
+
+    if (k_first > k_last)
+        return;
+
+    // Start the Bresenham walk at the first step inside the clip region
+    uint32_t m = (k_first * dy > p0) ? (k_first * dy - p0 + dx - 1) / dx : 0;
+    int32_t p = p0 - k_first * dy + m * dx;
+    int32_t a = a1 + k_first;
+    int32_t b = b1 + b_step * (int32_t) m;
+    int32_t a_end = a1 + k_last;
+
+    // Last pixel, for the dirty region
+    uint32_t m_last = (k_last * dy > p0) ? (k_last * dy - p0 + dx - 1) / dx : 0;
+    int32_t b_last = b1 + b_step * (int32_t) m_last;
+
+    if (steep)
+        mark_dirty((b < b_last) ? b : b_last, a / OLED_PAGE_HEIGHT, (b > b_last) ? b : b_last, a_end / OLED_PAGE_HEIGHT);
+    else
+        mark_dirty(a, ((b < b_last) ? b : b_last) / OLED_PAGE_HEIGHT, a_end, ((b > b_last) ? b : b_last) / OLED_PAGE_HEIGHT);
+
+    // Dotted lines draw the odd steps of the whole line
+    uint8_t draw_step = dotted ? 2 : 1;
+    uint8_t step_count = (dotted && (k_first & 1)) ? 1 : 0;
+
+    for (; a <= a_end; a++)
+    {
+        if (++step_count >= draw_step)
+        {
+            step_count = 0;
+
+            // If slope is less than one, coordinates are swapped
+            if (steep)
+                oled_byte_op(&page_row<Stride>(a / OLED_PAGE_HEIGHT)[b], 1 << (a % OLED_PAGE_HEIGHT), op_clear, op_toggle);
+            else
+                oled_byte_op(&page_row<Stride>(b / OLED_PAGE_HEIGHT)[a], 1 << (b % OLED_PAGE_HEIGHT), op_clear, op_toggle);
+        }
+
+        p -= dy;
+
+        if (p < 0)
+        {
+            b += b_step;
+            p += dx;
+        }
+    }
+}
+
+
+/// @brief Simplified line drawing for horizontal lines
+/// @param x1 screen x position of line start
+/// @param x2 screen x position of line end
+/// @param y screen y coordinate of the line
+void oled_canvas::draw_fast_hline(int16_t x1, int16_t x2, int16_t y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_FAST_HLINE);
+
+    STRIDE_DISPATCH(hline_kernel, x1, x2, y);
+}
+
+
+/// @brief draw_fast_hline() for a canvas Stride bytes wide, or oled_width wide when Stride is 0
+template <uint8_t Stride>
+void oled_canvas::hline_kernel(int16_t x1, int16_t x2, int16_t y)
+{
+    x1 += origin_x;
+    x2 += origin_x;
+    y += origin_y;
+
+    // Flip x coordinates to keep x1 < x2
+    if (x1 > x2)
+    {
+        int16_t tmp = x1;
+        x1 = x2;
+        x2 = tmp;
+    }
+
+    // Clip once, the line is then drawn as one span
+    if (!clip_box(&x1, &y, &x2, &y))
+        return;
+
+    uint8_t screen_page = y / OLED_PAGE_HEIGHT;
+    uint8_t mask = 1 << (y - screen_page*OLED_PAGE_HEIGHT);
+
+    if (display_list != NULL)
+    {
+        uint8_t args[] = {(uint8_t) x1, (uint8_t) x2, (uint8_t) y};
+
+        if (record(OLED_LIST_HLINE, x1, screen_page, x2, screen_page, args, sizeof(args)))
+            return;
+    }
+
+    mark_dirty(x1, screen_page, x2, screen_page);
+
+    // Same row of every column, so the whole line is one span
+    oled_span_apply(&page_row<Stride>(screen_page)[x1], x2 - x1 + 1, ~(mask & op_clear), mask & op_toggle);
+}
+
+
+/// @brief Simplified line drawing for vertical lines
+/// @param y1 screen y coordinate of the line start
+/// @param y2 screen y coordinate of the line end
+/// @param x screen x coordinate of the line
+void oled_canvas::draw_fast_vline(int16_t y1, int16_t y2, int16_t x)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_FAST_VLINE);
+
+    STRIDE_DISPATCH(vline_kernel, y1, y2, x);
+}
+
+
+/// @brief draw_fast_vline() for a canvas Stride bytes wide, or oled_width wide when Stride is 0
+template <uint8_t Stride>
+void oled_canvas::vline_kernel(int16_t y1, int16_t y2, int16_t x)
+{
+    y1 += origin_y;
+    y2 += origin_y;
+    x += origin_x;
+
+    // Flip y coordinates to keep y1 < y2
+    if (y1 > y2)
+    {
+        int16_t tmp = y1;
+        y1 = y2;
+        y2 = tmp;
+    }
+
+    // Clip once, then every page of the line is drawn
+    if (!clip_box(&x, &y1, &x, &y2))
+        return;
+
+    uint8_t first_page = y1 / OLED_PAGE_HEIGHT;    
+    uint8_t last_page = y2 / OLED_PAGE_HEIGHT;
+    uint8_t top_offset = y1 - first_page*OLED_PAGE_HEIGHT;
+    uint8_t bottom_offset = y2 - last_page*OLED_PAGE_HEIGHT + 1;
+
+    if (display_list != NULL)
+    {
+        uint8_t args[] = {(uint8_t) y1, (uint8_t) y2, (uint8_t) x};
+
+        if (record(OLED_LIST_VLINE, x, first_page, x, last_page, args, sizeof(args)))
+            return;
+    }
+
+    mark_dirty(x, first_page, x, last_page);
+
+    for (uint8_t page = first_page; page <= last_page; page++)
+    {
+        uint8_t mask = 0xFF;
+
+        if (page == first_page)
+        {
+            mask &= 0xFF << top_offset; // Pull zeros into LSBs
+        }
+
+        if (page == last_page)
+        {
+            mask &= 0xFF >> (OLED_PAGE_HEIGHT - bottom_offset);
+        }
+
+        // Draw current page
+        oled_byte_op(&page_row<Stride>(page)[x], mask, op_clear, op_toggle);
+    }
+
+}
+
+
+/// @brief Draw a vertical bar graph
+/// @param fullness how full the bar is, where 0 = empty and 100 = full
+/// @param x1 screen x coordinate of the top-left corner of the bar
+/// @param y1 screen y coordinate of the top-left corner of the bar
+/// @param x2 screen x coordinate of the bottom-right corner of the bar
+/// @param y2 screen y coordinate of the bottom-right corner of the bar
+void oled_canvas::draw_vbar(uint8_t fullness, int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_VBAR);
+
+    int16_t height = y2 - y1;
+    int16_t filled_px = (fullness * (height - 2)) / 100;
+
+    // Draw the outline
+    draw_box(x1, y1, x2, y2); 
+
+    // Fill the internal area from the bottom
+    fill_rect_op(draw_op, x1 + 1, (y2 - 1) - filled_px, x2 - 1, y2 - 1);
+}
+
+
+/// @brief Draw a horizontal bar graph
+/// @param fullness how full the bar is, where 0 = empty and 100 = full
+/// @param start_right Greater than 0 for bar to start on the right instead of the left side
+/// @param x1 screen x coordinate of the top-left corner of the bar
+/// @param y1 screen y coordinate of the top-left corner of the bar
+/// @param x2 screen x coordinate of the bottom-right corner of the bar
+/// @param y2 screen y coordinate of the bottom-right corner of the bar
+void oled_canvas::draw_hbar(uint8_t fullness, uint8_t start_right, int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_HBAR);
+
+    int16_t width = x2 - x1;
+    int16_t filled_px = (fullness * (width - 2)) / 100;
+
+    // Draw the outline
+    draw_box(x1, y1, x2, y2);
+
+    // Fill the internal area from the chosen side
+    if (start_right)
+        fill_rect_op(draw_op, (x2 - 1) - filled_px, y1 + 1, x2 - 1, y2 - 1);
+    else
+        fill_rect_op(draw_op, x1 + 1, y1 + 1, (x1 + 1) + filled_px, y2 - 1);
+}
+
+
+/// @brief Draw a vertical bar graph using bitmap images. In OLED_OP_INVERT mode pixels lit in both bitmaps
+///        cancel out, but drawing the same bar twice still erases it.
+/// @param fullness how full the bar is, where 0 = empty and 100 = full
+/// @param empty_bitmap bitmap of the bar (empty frame) when it is 0% full
+/// @param full_bitmap bitmap of the bar (with or without frame) when it is 100% full.
+/// @param x screen x coordinate of the top-left corner of the bar image
+/// @param y screen y coordinate of the top-left corner of the bar image
+void oled_canvas::draw_bmp_vbar(uint8_t fullness, const bitmap empty_bitmap, const bitmap full_bitmap, int16_t x, int16_t y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_BMP_VBAR);
+
+    uint8_t filled_px = (fullness * empty_bitmap.height) / 100;   // This assumes the active area is the whole bar bmp, including frame
+
+    // Draw the empty frame 
+    blit_screen(empty_bitmap.bitmap, empty_bitmap.width, 0, 0, empty_bitmap.width, empty_bitmap.height, x, y);
+
+    // Draw as much of the full bitmap that would be proportional to fullness (from the bottom)
+    blit_screen(full_bitmap.bitmap, full_bitmap.width, 0, full_bitmap.height - filled_px, full_bitmap.width, filled_px, x, y + (full_bitmap.height - filled_px));
+
+}
+
+
+/// @brief Solid fill a rectangular region in the draw mode
+/// @param blank nonzero to clear the rectangle (pixels off) whatever the draw mode
+/// @param x1 screen x coordinate of the top-left corner of the rectangle
+/// @param y1 screen y coordinate of the top-left corner of the rectangle
+/// @param x2 screen x coordinate of the bottom-right corner of the rectangle
+/// @param y2 screen y coordinate of the bottom-right corner of the rectangle
+void oled_canvas::fill_rect(uint8_t blank, int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_FILL_RECT);
+
+    STRIDE_DISPATCH(rect_kernel, blank ? OLED_OP_CLEAR : draw_op, x1, y1, x2, y2);
+}
+
+
+/// @brief Set, clear or invert every pixel in a rectangular region. Corners may be given in any order,
+///        the part of the rectangle outside the clip region is ignored.
+/// @param op what to do to each pixel
+/// @param x1 x coordinate of one corner
+/// @param y1 y coordinate of one corner
+/// @param x2 x coordinate of the opposite corner
+/// @param y2 y coordinate of the opposite corner
+void oled_canvas::fill_rect_op(OLED_raster_op op, int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_FILL_RECT);
+
+    STRIDE_DISPATCH(rect_kernel, op, x1, y1, x2, y2);
+}
+
+
+/// @brief fill_rect_op() for a canvas Stride bytes wide, or oled_width wide when Stride is 0
+template <uint8_t Stride>
+void oled_canvas::rect_kernel(OLED_raster_op op, int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    int16_t left = ((x1 <= x2) ? x1 : x2) + origin_x;
+    int16_t right = ((x1 <= x2) ? x2 : x1) + origin_x;
+    int16_t top = ((y1 <= y2) ? y1 : y2) + origin_y;
+    int16_t bottom = ((y1 <= y2) ? y2 : y1) + origin_y;
+
+    if (!clip_box(&left, &top, &right, &bottom))
+        return;
+
+    if (display_list != NULL)
+    {
+        uint8_t args[] = {(uint8_t) op, (uint8_t) left, (uint8_t) top, (uint8_t) right, (uint8_t) bottom};
+
+        if (record(OLED_LIST_RECT, left, top / OLED_PAGE_HEIGHT, right, bottom / OLED_PAGE_HEIGHT, args, sizeof(args)))
+            return;
+    }
+
+    uint8_t start_page = top / OLED_PAGE_HEIGHT;
+    uint8_t end_page = bottom / OLED_PAGE_HEIGHT;
+    uint8_t width = right - left + 1;
+
+    mark_dirty(left, start_page, right, end_page);
+
+    // Rows of the first and last page that are inside the rectangle
+    uint8_t first_mask = 0xFF << (top % OLED_PAGE_HEIGHT);
+    uint8_t last_mask = 0xFF >> (OLED_PAGE_HEIGHT - 1 - bottom % OLED_PAGE_HEIGHT);
+
+    // Full width interior pages are one run of bytes, set and clear are a memset()
+    if (width == row_stride<Stride>() && end_page - start_page >= 2)
+    {
+        oled_rows_op(page_row<Stride>(start_page), width, 0, 1, op, first_mask, 0xFF);
+        oled_span_op(page_row<Stride>(start_page + 1), (end_page - start_page - 1)*row_stride<Stride>(), op, 0xFF);
+        oled_rows_op(page_row<Stride>(end_page), width, 0, 1, op, 0xFF, last_mask);
+        return;
+    }
+
+    // Only the edge pages are masked
+    oled_rows_op(&page_row<Stride>(start_page)[left], width, row_stride<Stride>(), end_page - start_page + 1, op, first_mask, last_mask);
+}
+
+
+/// @brief Draw a box outline at the given coordinates. Each pixel of the outline is drawn once, so it can be
+///        toggled in OLED_OP_INVERT mode.
+/// @param x1 screen x coordinate of the top-left corner of the box
+/// @param y1 screen y coordinate of the top-left corner of the box
+/// @param x2 screen x coordinate of the bottom-right corner of the box
+/// @param y2 screen y coordinate of the bottom-right corner of the box
+void oled_canvas::draw_box(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_BOX);
+
+    if (y1 > y2)
+    {
+        int16_t tmp = y1;
+        y1 = y2;
+        y2 = tmp;
+    }
+
+    draw_fast_hline(x1, x2, y1);  // Top 
+
+    if (y2 != y1)
+        draw_fast_hline(x1, x2, y2);  // Bottom
+
+    // The sides leave out the corners, which the top and bottom already drew
+    if (y2 - y1 >= 2)
+    {
+        draw_fast_vline(y1 + 1, y2 - 1, x1);  // Left
+
+        if (x2 != x1)
+            draw_fast_vline(y1 + 1, y2 - 1, x2);  // Right
+    }
+}
+
+
+// x = r*cos(th)
+// y = r*sin(th)
+// th = atan(y/x)
+// r = sqrt(x^2 + y^2)
+
+
+/// @brief Draw a line with polar coordinates
+/// @param start_x screen x coordinate of the start of the line
+/// @param start_y screen y coordinate of the start of the line
+/// @param magnitude polar magnitude of the line
+/// @param angle polar angle of the line
+void oled_canvas::draw_line_polar(int16_t start_x, int16_t start_y, uint8_t magnitude, float angle)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_LINE_POLAR);
+
+    float end_x, end_y;
+
+    // Convert degrees to radians
+    angle = (angle / 360.0) * 2.0 * M_PI;
+
+    // Convert polar to rect
+    sincosf(angle, &end_y, &end_x);
+    end_x = end_x * magnitude + start_x;
+    end_y = end_y * magnitude + start_y;
+
+    draw_line(start_x, start_y, end_x, end_y);
+}
+
+
+/// @brief Determine the screen space required to draw a string
+/// @param input_str string to calculate size of
+/// @param width pointer to variable to store the calculated width
+/// @param height pointer to variable to store the calculated height
+void oled_canvas::get_str_dimensions(const char *input_str, uint8_t *width, uint8_t *height)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_GET_STR_DIMENSIONS);
+
+    uint8_t max_width = 0;
+    uint8_t line_width = 0;
+    char* current_char = (char *)input_str; 
+
+    *height = font.line_height;
+
+    while (*current_char != '\0')
+    {
+        if (*current_char != '\n')
+        {
+
+            line_width += font.character[*current_char - font.first].x_advance; 
+        }
+        else
+        {
+            // Character is newline, height is increased one line's worth
+            *height += font.line_height;
+
+            // Save current line's width if it's longest
+            if (line_width > max_width)
+                max_width = line_width;
+
+            line_width = 0;
+        }
+        current_char++;
+    }
+
+    if (line_width > max_width)
+        *width = line_width;
+    else
+        *width = max_width;
+
+}
+
+
+/// @brief Draw a string within a box outline
+/// @param print_str string to print
+/// @param padding number of extra pixels to pad around the text
+/// @param fill_bg nonzero to clear the area under the text box before drawing it
+/// @param x screen x coordinate of the top-left of the text box
+/// @param y screen y coordinate of the top-left of the text box
+void oled_canvas::draw_boxed_text(const char *print_str, uint8_t padding, uint8_t fill_bg, int16_t x, int16_t y)
+{
+    GFX_PROFILE_SCOPE(GFX_PROF_DRAW_BOXED_TEXT);
+
+    uint8_t text_width, text_height;
+    int16_t tmp_cursor_x = cursor_x;
+    int16_t tmp_cursor_y = cursor_y;
+    int16_t box_x2;
+    int16_t box_y2;
+    
+    get_str_dimensions(print_str, &text_width, &text_height);
+
+    box_x2 = 2 + x + text_width + 2*padding;
+    box_y2 = 2 + y + text_height + 2*padding;
+
+    // Clear the area under the textbox if desired
+    if (fill_bg)
+        fill_rect(1, x, y, box_x2, box_y2);
+
+    draw_box(x, y, box_x2, box_y2);
+
+    set_cursor(x + padding + 2, y + padding + 1);
+    print(print_str);
+
+    // Restore original cursor position
+    set_cursor(tmp_cursor_x, tmp_cursor_y);
+}
+
+
+
+/// @brief Record drawing calls in a display list instead of drawing them straight away. At the end of each frame,
+///        finish_display_list() (called by pico_oled::render()) draws only the pages whose commands changed since
+///        the last frame. Each frame must draw the whole screen, starting from a blank page for the changed pages.
+/// @param list list to record into, or NULL to draw straight away again
+void oled_canvas::set_display_list(oled_display_list *list)
+{
+    // Lists only keep hashes for as many pages as a display has
+    if (oled_height / OLED_PAGE_HEIGHT > OLED_LIST_MAX_PAGES)
+        return;
+
+    display_list = list;
+
+    // Nothing is known about what the buffer holds
+    if (list != NULL)
+        list->forget();
+}
+
+
+/// @brief Add a command to the display list. Coordinates in the arguments already include the origin.
+/// @param cmd command
+/// @param x1 first column the command can draw on, within the clip region
+/// @param page1 first page the command can draw on, within the clip region
+/// @param x2 last column the command can draw on, within the clip region
+/// @param page2 last page the command can draw on, within the clip region
+/// @param args arguments of the command
+/// @param length bytes of arguments
+/// @return true if the command was recorded, false if it has to be drawn straight away
+bool oled_canvas::record(OLED_list_cmd cmd, uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2, const uint8_t *args, uint8_t length)
+{
+    uint8_t pages = oled_height / OLED_PAGE_HEIGHT;
+
+    if (display_list->overflowed)
+        return false;
+
+    // Commands are played back with the clip rectangle they were recorded with
+    bool added = true;
+
+    if (memcmp(display_list->clip_rect, clip_rect, sizeof(clip_rect)) != 0)
+    {
+        added = display_list->add(OLED_LIST_CLIP, draw_op, 0, 0, oled_width - 1, pages - 1, clip_rect, sizeof(clip_rect));
+
+        if (added)
+            memcpy(display_list->clip_rect, clip_rect, sizeof(clip_rect));
+    }
+
+    // Text is played back in the font it was recorded with
+    if (added && cmd == OLED_LIST_TEXT && display_list->font_chars != font.character)
+    {
+        added = display_list->add(OLED_LIST_FONT, draw_op, 0, 0, oled_width - 1, pages - 1, (const uint8_t *) &font, sizeof(font));
+
+        if (added)
+            display_list->font_chars = font.character;
+    }
+
+    if (added && display_list->add(cmd, draw_op, x1, page1, x2, page2, args, length))
+        return true;
+
+    // List is full: draw what was recorded so far, the rest of the frame is drawn straight away
+    oled_display_list *list = display_list;
+    display_list = NULL;
+
+    oled_span_fill(page_row(clip_page1), (clip_page2 - clip_page1 + 1) * oled_width, 0);
+    play_display_list(list, 0, pages - 1);
+    mark_dirty(0, 0, oled_width - 1, pages - 1);
+
+    display_list = list;
+    display_list->overflowed = 1;
+
+    return false;
+}
+
+
+/// @brief Add a bitmap blit to the display list. Bitmaps and fonts are constant, so the source address and the
+///        arguments are all that is compared with the last frame. Sources that can be drawn on between frames
+///        (see draw_canvas()) also add a hash of the source pixels drawn.
+///        Takes the arguments of blit_screen() with the origin already added, and the part of the canvas it draws on
+/// @param hash_source true to hash the source pixels
+/// @return true if the blit was recorded, false if it has to be drawn straight away
+bool oled_canvas::record_blit(const uint8_t *src_bitmap, const uint8_t *src_mask, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height, int16_t screen_x, int16_t screen_y,
+    int16_t left, int16_t top, int16_t right, int16_t bottom, bool hash_source)
+{
+    uint8_t args[2*sizeof(src_bitmap) + 15];
+    uint8_t *arg = args;
+
+    memcpy(arg, &src_bitmap, sizeof(src_bitmap));
+    arg += sizeof(src_bitmap);
+
+    if (src_mask != NULL)
+    {
+        memcpy(arg, &src_mask, sizeof(src_mask));
+        arg += sizeof(src_mask);
+    }
+
+    *arg++ = src_width;
+    *arg++ = src_width >> 8;
+    *arg++ = src_x;
+    *arg++ = src_x >> 8;
+    *arg++ = src_y;
+    *arg++ = blit_width;
+    *arg++ = blit_height;
+    *arg++ = screen_x;
+    *arg++ = screen_x >> 8;
+    *arg++ = screen_y;
+    *arg++ = screen_y >> 8;
+
+    if (hash_source)
+    {
+        uint32_t source_hash = 2166136261u;
+
+        for (uint8_t page = src_y / OLED_PAGE_HEIGHT; page <= (src_y + blit_height - 1) / OLED_PAGE_HEIGHT; page++)
+        {
+            const uint8_t *row = &src_bitmap[src_x + page*src_width];
+
+            for (uint8_t column = 0; column < blit_width; column++)
+            {
+                source_hash ^= row[column];
+                source_hash *= 16777619u;
+
+                if (src_mask != NULL)
+                {
+                    source_hash ^= src_mask[src_x + page*src_width + column];
+                    source_hash *= 16777619u;
+                }
+            }
+        }
+
+        memcpy(arg, &source_hash, sizeof(source_hash));
+        arg += sizeof(source_hash);
+    }
+
+    return record((src_mask != NULL) ? OLED_LIST_MASKED_BLIT : OLED_LIST_BLIT, left, top / OLED_PAGE_HEIGHT, right, bottom / OLED_PAGE_HEIGHT, args, arg - args);
+}
+
+
+/// @brief Add a print() call to the display list as one command: the font, cursor, origin and characters are all
+///        that is compared with the last frame. Moves the cursor as printing would
+/// @param text characters to print
+/// @param length number of characters
+/// @return true if the text was recorded, false if it has to be drawn straight away
+bool oled_canvas::record_text(const char *text, uint16_t length)
+{
+    // Glyph by glyph instead
+    if (length > OLED_LIST_TEXT_MAX)
+        return false;
+
+    int16_t start_x = cursor_x;
+    int16_t start_y = cursor_y;
+    int16_t box[4] = {INT16_MAX, INT16_MAX, INT16_MIN, INT16_MIN};
+
+    print_chars(text, length, box);
+
+    // Nothing to draw, only the cursor moves
+    if (box[0] > box[2] || !clip_box(&box[0], &box[1], &box[2], &box[3]))
+        return true;
+
+    uint8_t args[8 + OLED_LIST_TEXT_MAX];
+
+    // Played back with the origin it was recorded with, since lines wrap at the edge of the canvas before the origin is added
+    args[0] = origin_x;
+    args[1] = origin_x >> 8;
+    args[2] = origin_y;
+    args[3] = origin_y >> 8;
+    args[4] = start_x;
+    args[5] = start_x >> 8;
+    args[6] = start_y;
+    args[7] = start_y >> 8;
+    memcpy(&args[8], text, length);
+
+    if (record(OLED_LIST_TEXT, box[0], box[1] / OLED_PAGE_HEIGHT, box[2], box[3] / OLED_PAGE_HEIGHT, args, 8 + length))
+        return true;
+
+    cursor_x = start_x;
+    cursor_y = start_y;
+    return false;
+}
+
+
+/// @brief Carry out the recorded commands that touch some of the pages, with drawing clipped to those pages
+/// @param list commands to carry out
+/// @param page1 first page to draw
+/// @param page2 last page to draw
+void oled_canvas::play_display_list(const oled_display_list *list, uint8_t page1, uint8_t page2)
+{
+    const uint8_t *entry = list->memory;
+    const uint8_t *end = entry + list->used;
+    OLED_raster_op saved_op = draw_op;
+    int16_t saved_origin_x = origin_x, saved_origin_y = origin_y;
+    int16_t saved_cursor_x = cursor_x, saved_cursor_y = cursor_y;
+    gfx_font saved_font = font;
+    uint8_t saved_clip_rect[sizeof(clip_rect)];
+
+    // Recorded coordinates already include the origin, and the list sets its own clip rectangle
+    memcpy(saved_clip_rect, clip_rect, sizeof(clip_rect));
+    set_origin(0, 0);
+    reset_clip_rect();
+    set_clip_pages(page1, page2);
+
+    for (; entry < end; entry += OLED_LIST_HEADER + entry[3])
+    {
+        if (entry[2] < page1 || entry[1] > page2)
+            continue;
+
+        const uint8_t *args = &entry[OLED_LIST_HEADER];
+
+        // Each command is drawn in the mode it was recorded in
+        set_draw_mode((OLED_raster_op) (entry[0] >> OLED_LIST_MODE_SHIFT));
+
+        switch (entry[0] & ((1 << OLED_LIST_MODE_SHIFT) - 1))
+        {
+            case OLED_LIST_FILL:
+                fill(args[0]);
+                break;
+
+            case OLED_LIST_BLIT:
+            case OLED_LIST_MASKED_BLIT:
+            {
+                const uint8_t *src_bitmap;
+                const uint8_t *src_mask = NULL;
+                memcpy(&src_bitmap, args, sizeof(src_bitmap));
+                args += sizeof(src_bitmap);
+
+                if ((entry[0] & ((1 << OLED_LIST_MODE_SHIFT) - 1)) == OLED_LIST_MASKED_BLIT)
+                {
+                    memcpy(&src_mask, args, sizeof(src_mask));
+                    args += sizeof(src_mask);
+                }
+
+                blit_planes(src_bitmap, src_mask, args[0] | (args[1] << 8), args[2] | (args[3] << 8), args[4], args[5], args[6],
+                    (int16_t) (args[7] | (args[8] << 8)), (int16_t) (args[9] | (args[10] << 8)));
+                break;
+            }
+
+            case OLED_LIST_PACKED:
+            {
+                const uint8_t *data;
+                memcpy(&data, args, sizeof(data));
+                args += sizeof(data);
+
+                blit_packed(data, args[2], args[0] | (args[1] << 8), args[3] | (args[4] << 8), args[5] | (args[6] << 8),
+                    (int16_t) (args[7] | (args[8] << 8)), (int16_t) (args[9] | (args[10] << 8)));
+                break;
+            }
+
+            case OLED_LIST_PIXEL:
+                draw_pixel(args[0], args[1]);
+                break;
+
+            case OLED_LIST_LINE:
+            case OLED_LIST_LINE_DOTTED:
+            {
+                int16_t x1 = args[0] | (args[1] << 8);
+                int16_t y1 = args[2] | (args[3] << 8);
+                int16_t x2 = args[4] | (args[5] << 8);
+                int16_t y2 = args[6] | (args[7] << 8);
+
+                raster_line(x1, y1, x2, y2, (entry[0] & ((1 << OLED_LIST_MODE_SHIFT) - 1)) == OLED_LIST_LINE_DOTTED);
+                break;
+            }
+
+            case OLED_LIST_HLINE:
+                draw_fast_hline(args[0], args[1], args[2]);
+                break;
+
+            case OLED_LIST_VLINE:
+                draw_fast_vline(args[0], args[1], args[2]);
+                break;
+
+            case OLED_LIST_RECT:
+                fill_rect_op((OLED_raster_op) args[0], args[1], args[2], args[3], args[4]);
+                break;
+
+            case OLED_LIST_TEXT:
+                set_origin(args[0] | (args[1] << 8), args[2] | (args[3] << 8));
+                set_cursor(args[4] | (args[5] << 8), args[6] | (args[7] << 8));
+                print_chars((const char *) &args[8], entry[3] - 8, NULL);
+                set_origin(0, 0);
+                break;
+
+            case OLED_LIST_CLIP:
+                memcpy(clip_rect, args, sizeof(clip_rect));
+                update_clip();
+                break;
+
+            case OLED_LIST_FONT:
+                memcpy(&font, args, sizeof(font));
+                break;
+        }
+    }
+
+    set_draw_mode(saved_op);
+    set_origin(saved_origin_x, saved_origin_y);
+    set_cursor(saved_cursor_x, saved_cursor_y);
+    font = saved_font;
+    memcpy(clip_rect, saved_clip_rect, sizeof(clip_rect));
+    set_clip_pages(buffer_page1, buffer_page2);
+}
+
+
+/// @brief End the frame recorded in the display list: draw the pages whose commands differ from the last frame
+///        and mark them for the next render. Identical frames draw nothing. Starts a new list for the next frame.
+/// @return true if any page changed
+bool oled_canvas::finish_display_list()
+{
+    oled_display_list *list = display_list;
+
+    if (list == NULL)
+        return false;
+
+    uint8_t pages = oled_height / OLED_PAGE_HEIGHT;
+
+    if (list->overflowed)
+    {
+        // Already drawn straight away, and the next frame can't be compared with it
+        list->forget();
+        return true;
+    }
+
+    // Playing back marks whole commands dirty, only the changed pages need to be sent
+    uint8_t saved_x1 = dirty_x1, saved_x2 = dirty_x2, saved_page1 = dirty_page1, saved_page2 = dirty_page2;
+    uint8_t first_changed = 0xFF, last_changed = 0;
+    int16_t run_start = -1;
+
+    display_list = NULL;
+
+    // Go one page past the end to close the last run of changed pages
+    for (uint8_t page = 0; page <= pages; page++)
+    {
+        bool page_changed = page < pages && list->page_changed(page);
+
+        if (page_changed && run_start < 0)
+        {
+            run_start = page;
+        }
+        else if (!page_changed && run_start >= 0)
+        {
+            oled_span_fill(page_row(run_start), (page - run_start) * oled_width, 0);
+            play_display_list(list, run_start, page - 1);
+
+            if (first_changed == 0xFF)
+                first_changed = run_start;
+
+            last_changed = page - 1;
+            run_start = -1;
+        }
+    }
+
+    dirty_x1 = saved_x1;
+    dirty_x2 = saved_x2;
+    dirty_page1 = saved_page1;
+    dirty_page2 = saved_page2;
+
+    if (first_changed != 0xFF)
+    {
+        uint8_t x1 = 0;
+        uint8_t x2 = oled_width - 1;
+
+        // Unless the background changed, only columns drawn on in this frame or the last can differ
+        list->changed_columns(&x1, &x2);
+
+        if (x1 <= x2)
+            mark_dirty(x1, first_changed, x2, last_changed);
+    }
+
+    display_list = list;
+
+    list->end_frame();
+
+    return first_changed != 0xFF;
+}
+
+
+/// @brief Create a pool of canvases in a block of memory
+/// @param memory block to carve canvas buffers from, e.g. a static array. It must outlive the pool.
+/// @param size size of the block in bytes
+oled_canvas_pool::oled_canvas_pool(uint8_t *memory, uint32_t size)
+{
+    arena = memory;
+    arena_size = size;
+    arena_used = 0;
+
+    for (uint8_t slot = 0; slot < OLED_CANVAS_POOL_MAX; slot++)
+        slot_used[slot] = 0;
+}
+
+
+/// @brief Get a cleared canvas
+/// @param width width in pixels
+/// @param height height in pixels, rounded up to a multiple of 8
+/// @return the canvas, or NULL if the pool is out of memory or slots
+oled_canvas *oled_canvas_pool::acquire(uint8_t width, uint8_t height)
+{
+    uint32_t needed = bytes_needed(width, height);
+
+    if (needed > arena_size - arena_used)
+        return NULL;
+
+    for (uint8_t slot = 0; slot < OLED_CANVAS_POOL_MAX; slot++)
+    {
+        if (slot_used[slot])
+            continue;
+
+        uint8_t pages = (height + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT;
+        oled_canvas *canvas = new (slots[slot]) oled_canvas(&arena[arena_used], width, pages * OLED_PAGE_HEIGHT);
+        canvas->fill(0);
+
+        slot_used[slot] = 1;
+        slot_offset[slot] = arena_used;
+        arena_used += needed;
+
+        return canvas;
+    }
+
+    return NULL;
+}
+
+
+/// @brief Give a canvas back to the pool. The canvas must not be used afterwards.
+void oled_canvas_pool::release(oled_canvas *canvas)
+{
+    for (uint8_t slot = 0; slot < OLED_CANVAS_POOL_MAX; slot++)
+    {
+        if (!slot_used[slot] || (oled_canvas *) slots[slot] != canvas)
+            continue;
+
+        canvas->~oled_canvas();
+        slot_used[slot] = 0;
+
+        // Give back memory from the end of the arena down to the last canvas still in use
+        uint32_t end = 0;
+
+        for (uint8_t other = 0; other < OLED_CANVAS_POOL_MAX; other++)
+        {
+            if (!slot_used[other])
+                continue;
+
+            oled_canvas *used = (oled_canvas *) slots[other];
+            uint32_t used_end = slot_offset[other] + bytes_needed(used->get_width(), used->get_height());
+
+            if (used_end > end)
+                end = used_end;
+        }
+
+        arena_used = end;
+        return;
+    }
+}
+
+
+/// @brief Release every canvas at once
+void oled_canvas_pool::reset()
+{
+    for (uint8_t slot = 0; slot < OLED_CANVAS_POOL_MAX; slot++)
+    {
+        if (slot_used[slot])
+            ((oled_canvas *) slots[slot])->~oled_canvas();
+
+        slot_used[slot] = 0;
+    }
+
+    arena_used = 0;
+}
@@ -0,0 +1,277 @@
+/**
+ *  oled-canvas.hpp
+ *  Drawing into page format buffers, the layout used by SSD1306/SSD1309 display RAM.
+ *  pico_oled draws through a canvas on its screen buffer; offscreen canvases hold pre-rendered
+ *  widgets, icons or text that are blitted onto the screen each frame.
+ */
+#ifndef _OLED_CANVAS_H_
+#define _OLED_CANVAS_H_
+
+#include "pico/stdlib.h"
+#include "gfx_font.h"
+#include "oled-display-list.hpp"
+#include "oled-packed.hpp"
+
+
+#define OLED_PAGE_HEIGHT _u(8)
+#define OLED_CANVAS_POOL_MAX 8      // Most canvases a pool can hand out at once
+#define OLED_FIXED_STRIDE 128       // Width the drawing kernels are also compiled for, used by pico_oled_static
+
+
+// What drawing does to the pixels it touches, see set_draw_mode()
+typedef enum
+{
+    OLED_OP_SET,                    // Turn pixels on (OR)
+    OLED_OP_CLEAR,                  // Turn pixels off (AND-NOT)
+    OLED_OP_INVERT,                 // Toggle pixels, so drawing the same thing twice restores what was there
+    OLED_OP_XOR = OLED_OP_INVERT    // Same as OLED_OP_INVERT: toggling the drawn pixels is an XOR with them
+} OLED_raster_op;
+
+typedef struct
+{
+    const uint8_t *bitmap;
+    uint16_t width;
+    uint16_t height;
+} bitmap;
+
+// Bitmap with a second plane saying which pixels it covers, see blit_masked()
+typedef struct
+{
+    const uint8_t *bitmap;
+    const uint8_t *mask;
+    uint16_t width;
+    uint16_t height;
+} masked_bitmap;
+
+class oled_sprite_image;
+
+
+/// @brief Drawing functions over a page format buffer: each byte is a column of 8 pixels (LSB at the top),
+///        pages of width bytes follow each other. buffer[0] is a header byte for the display transport,
+///        pixel data starts at buffer[1].
+class oled_canvas
+{
+    protected:
+        uint8_t oled_height, oled_width;
+        uint8_t *screen_buffer;
+        int screen_buf_length;
+        gfx_font font;
+        uint8_t font_set;
+        int16_t cursor_x;
+        int16_t cursor_y;
+
+        // Draw mode, and the same as the pixels it clears and then toggles: drawn bits m become
+        // (byte & ~(m & op_clear)) ^ (m & op_toggle), so drawing code never checks the mode per pixel
+        OLED_raster_op draw_op;
+        uint8_t op_clear, op_toggle;
+
+        // Pages of the screen held in screen_buffer: all of them, unless the buffer is one strip of
+        // the screen (see pico_oled_paged)
+        uint8_t buffer_page1, buffer_page2;
+
+        // Pages that can be drawn on, drawing outside them is clipped. Normally the pages held in the buffer
+        uint8_t clip_page1, clip_page2;
+
+        // Clip rectangle set with set_clip_rect(), in canvas pixels: x1, y1, x2, y2. Can reach past the canvas
+        uint8_t clip_rect[4];
+
+        // Pixels that can be drawn on: the clip rectangle within the canvas and the clip pages. Empty when x1 > x2
+        // or y1 > y2. Every drawing function clips to this once and then draws without further checks
+        int16_t clip_x1, clip_y1, clip_x2, clip_y2;
+
+        // Added to the coordinates of every drawing call, see set_origin()
+        int16_t origin_x, origin_y;
+
+        // Region changed since the last render, in columns and pages. Empty when x1 > x2
+        uint8_t dirty_x1, dirty_x2, dirty_page1, dirty_page2;
+
+        // Region drawn since the last fill(), used to limit what a repeated fill() has to resend
+        uint8_t ink_x1, ink_x2, ink_page1, ink_page2;
+        uint8_t last_fill;
+
+        // Drawing calls are recorded here instead of drawn, when set
+        oled_display_list *display_list;
+
+        // OLED_FIXED_STRIDE to draw with the kernels compiled for that width, 0 to use the ones that read oled_width.
+        // Only set by pico_oled_static, whose width is known at compile time
+        uint8_t fixed_stride;
+
+        bool record(OLED_list_cmd cmd, uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2, const uint8_t *args, uint8_t length);
+        bool record_blit(const uint8_t *src_bitmap, const uint8_t *src_mask, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height, int16_t screen_x, int16_t screen_y,
+            int16_t left, int16_t top, int16_t right, int16_t bottom, bool hash_source);
+        void blit_planes(const uint8_t *src_bitmap, const uint8_t *src_mask, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height,
+            int16_t screen_x, int16_t screen_y, bool hash_source=false);
+        void blit_packed(const uint8_t *data, uint8_t format, uint16_t start, uint16_t width, uint16_t height, int16_t screen_x, int16_t screen_y);
+        bool record_text(const char *text, uint16_t length);
+        void print_chars(const char *text, uint16_t length, int16_t *box);
+        void play_display_list(const oled_display_list *list, uint8_t page1, uint8_t page2);
+
+        /// @brief Grow the dirty and ink regions to include the given area. Coordinates must already be on screen.
+        void mark_dirty(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2)
+        {
+            if (x1 < dirty_x1) dirty_x1 = x1;
+            if (x2 > dirty_x2) dirty_x2 = x2;
+            if (page1 < dirty_page1) dirty_page1 = page1;
+            if (page2 > dirty_page2) dirty_page2 = page2;
+
+            if (x1 < ink_x1) ink_x1 = x1;
+            if (x2 > ink_x2) ink_x2 = x2;
+            if (page1 < ink_page1) ink_page1 = page1;
+            if (page2 > ink_page2) ink_page2 = page2;
+        }
+
+        /// @brief Bytes from one page to the next: Stride, or oled_width when Stride is 0
+        template <uint8_t Stride>
+        uint8_t row_stride() { return Stride ? Stride : oled_width; }
+
+        /// @brief Pixel data of a page held in the buffer
+        /// @tparam Stride width of the canvas when it is known at compile time, 0 to read oled_width
+        template <uint8_t Stride = 0>
+        uint8_t *page_row(uint8_t page) { return &screen_buffer[1 + (page - buffer_page1)*row_stride<Stride>()]; }
+
+        // Drawing kernels, one version for each stride. Called through STRIDE_DISPATCH in oled-canvas.cpp
+        template <uint8_t Stride> void pixel_kernel(int16_t x, int16_t y);
+        template <uint8_t Stride> void line_kernel(int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool dotted);
+        template <uint8_t Stride> void hline_kernel(int16_t x1, int16_t x2, int16_t y);
+        template <uint8_t Stride> void vline_kernel(int16_t y1, int16_t y2, int16_t x);
+        template <uint8_t Stride> void rect_kernel(OLED_raster_op op, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        template <uint8_t Stride> void planes_kernel(const uint8_t *src_bitmap, const uint8_t *src_mask, uint16_t src_width, uint16_t src_x, uint8_t src_y,
+            uint8_t blit_width, uint8_t blit_height, int16_t screen_x, int16_t screen_y, bool hash_source);
+        template <uint8_t Stride> void sprite_kernel(const oled_sprite_image *image, int16_t screen_x, int16_t screen_y);
+        template <uint8_t Stride> void packed_kernel(const uint8_t *data, uint8_t format, uint16_t start, uint16_t width, uint16_t height, int16_t screen_x, int16_t screen_y);
+
+        void set_buffer_pages(uint8_t page1, uint8_t page2);
+        void set_clip_pages(uint8_t page1, uint8_t page2);
+        void update_clip();
+        bool clip_box(int16_t *x1, int16_t *y1, int16_t *x2, int16_t *y2);
+        void raster_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool dotted);
+
+        /// @brief Reset the dirty region to empty once the display matches the buffer
+        void clear_dirty()
+        {
+            dirty_x1 = 0xFF;
+            dirty_x2 = 0;
+            dirty_page1 = 0xFF;
+            dirty_page2 = 0;
+        }
+
+    public:
+        oled_canvas(uint8_t *buffer, uint8_t canvas_width, uint8_t canvas_height);
+
+        /// @brief Width in pixels
+        uint8_t get_width() { return oled_width; }
+
+        /// @brief Height in pixels, a multiple of 8
+        uint8_t get_height() { return oled_height; }
+
+        /// @brief Pixel data, starting after the header byte
+        const uint8_t *get_pixels() const { return screen_buffer + 1; }
+
+        void set_draw_mode(OLED_raster_op op);
+        void set_clip_rect(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void reset_clip_rect();
+
+        /// @brief Move the origin of drawing: (0, 0) in drawing calls is (x, y) on the canvas. Negative values
+        ///        scroll the drawing left or up
+        void set_origin(int16_t x, int16_t y)
+        {
+            origin_x = x;
+            origin_y = y;
+        }
+
+        /// @brief What drawing does to the pixels it touches
+        OLED_raster_op get_draw_mode() { return draw_op; }
+
+        void set_display_list(oled_display_list *list);
+        bool finish_display_list();
+
+        void fill(uint8_t fill);
+        void blit_screen(const uint8_t *src_bitmap, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height, int16_t screen_x, int16_t screen_y);
+        void blit_masked(const uint8_t *src_bitmap, const uint8_t *src_mask, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height,
+            int16_t screen_x, int16_t screen_y);
+
+        void draw_bmp(const uint8_t *src_bitmap, uint8_t src_width, uint8_t src_height, int16_t screen_x, int16_t screen_y)
+        {
+            blit_screen(src_bitmap, src_width, 0, 0, src_width, src_height, screen_x, screen_y);
+        }
+
+        /// @brief Draw the whole of a masked bitmap, replacing the pixels under its mask
+        void draw_masked_bmp(const masked_bitmap &src, int16_t screen_x, int16_t screen_y)
+        {
+            blit_masked(src.bitmap, src.mask, src.width, 0, 0, src.width, src.height, screen_x, screen_y);
+        }
+
+        void draw_canvas(const oled_canvas *src, int16_t screen_x, int16_t screen_y);
+
+        void draw_sprite(const oled_sprite_image *image, int16_t screen_x, int16_t screen_y);
+        void draw_packed(const packed_bitmap &src, int16_t screen_x, int16_t screen_y);
+
+        void set_cursor(int16_t cursor_x, int16_t cursor_y)
+        {
+            this->cursor_x = cursor_x;
+            this->cursor_y = cursor_y;
+        }
+
+        void set_font(gfx_font new_font);
+        uint8_t get_font_height(){return font.line_height;};    // char height + 1
+        void get_str_dimensions(const char *input_str, uint8_t *width, uint8_t *height);
+        void draw_char(uint8_t char_c, int16_t x_pos, int16_t y_pos);
+        void print(const char *print_str);
+        void print_num(const char *format_str, int32_t print_data);
+        void print_num(const char *format_str, uint32_t print_data);
+        void print_num(const char *format_str, float print_data);
+        void print_num(const char *format_str, uint16_t print_data);
+        void print_num(const char *format_str, int16_t print_data);
+        void print_num(const char *format_str, uint8_t print_data);
+        void print_num(const char *format_str, int8_t print_data);
+        void draw_pixel(int16_t x, int16_t y);
+        void draw_pixel_alternating(int16_t x, int16_t y);
+        void draw_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void draw_line_dotted(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void draw_fast_hline(int16_t x1, int16_t x2, int16_t y);
+        void draw_fast_vline(int16_t y1, int16_t y2, int16_t x);
+        void draw_line_polar(int16_t start_x, int16_t start_y, uint8_t magnitude, float angle);
+        void draw_vbar(uint8_t fullness, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void draw_hbar(uint8_t fullness, uint8_t start_right, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void draw_bmp_vbar(uint8_t fullness, const bitmap empty_bitmap, const bitmap full_bitmap, int16_t x, int16_t y);
+        void fill_rect(uint8_t blank, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void fill_rect_op(OLED_raster_op op, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void draw_box(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void draw_boxed_text(const char *print_str, uint8_t padding, uint8_t fill_bg, int16_t x, int16_t y);
+
+        uint8_t pixel_counter;
+};
+
+
+/// @brief Hands out offscreen canvases from a fixed block of memory, so they never fragment the heap.
+///        Memory is taken in order; releasing the most recently acquired canvas gives its memory back,
+///        releasing any other only frees its slot until reset() (or until everything after it is released).
+class oled_canvas_pool
+{
+    private:
+        uint8_t *arena;
+        uint32_t arena_size;
+        uint32_t arena_used;
+
+        // Canvas objects are built in place in these slots
+        alignas(oled_canvas) uint8_t slots[OLED_CANVAS_POOL_MAX][sizeof(oled_canvas)];
+        uint32_t slot_offset[OLED_CANVAS_POOL_MAX];     // Start of each canvas' buffer in the arena
+        uint8_t slot_used[OLED_CANVAS_POOL_MAX];
+
+    public:
+        oled_canvas_pool(uint8_t *memory, uint32_t size);
+        oled_canvas *acquire(uint8_t width, uint8_t height);
+        void release(oled_canvas *canvas);
+        void reset();
+
+        /// @brief Bytes of the arena not yet handed out
+        uint32_t bytes_free() { return arena_size - arena_used; }
+
+        /// @brief Arena bytes needed for a canvas of the given size
+        static uint32_t bytes_needed(uint8_t width, uint8_t height)
+        {
+            return (uint32_t) width * ((height + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT) + 1;
+        }
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "oled-display-list.hpp"
+#include "pico/stdlib.h"
+#include <string.h>
+
+
+#define LIST_HASH_BASIS 2166136261u     // FNV-1a
+#define LIST_HASH_PRIME 16777619u
+
+
+/// @brief Record drawing calls into a block of memory
+/// @param memory space for the commands of one frame. 4 bytes of header plus 1-27 bytes of arguments per call
+/// @param size bytes of memory
+oled_display_list::oled_display_list(uint8_t *memory, uint32_t size)
+{
+    this->memory = memory;
+    this->size = size;
+
+    forget();
+}
+
+
+/// @brief Forget the last frame, so every page is drawn at the next render, e.g. after the screen buffer was drawn on directly
+void oled_display_list::forget()
+{
+    last_valid = 0;
+    restart();
+}
+
+
+/// @brief Empty the list for the next frame
+void oled_display_list::restart()
+{
+    used = 0;
+    overflowed = 0;
+    fill_value = 0;
+
+    // Playback starts without a clip rectangle
+    clip_rect[0] = 0;
+    clip_rect[1] = 0;
+    clip_rect[2] = 0xFF;
+    clip_rect[3] = 0xFF;
+    font_chars = NULL;
+
+    for (uint8_t page = 0; page < OLED_LIST_MAX_PAGES; page++)
+    {
+        page_hashes[page] = LIST_HASH_BASIS;
+        page_x1[page] = 0xFF;
+        page_x2[page] = 0;
+    }
+}
+
+
+/// @brief Keep what is needed to compare the next frame with this one, and empty the list
+void oled_display_list::end_frame()
+{
+    memcpy(last_page_hashes, page_hashes, sizeof(page_hashes));
+    memcpy(last_page_x1, page_x1, sizeof(page_x1));
+    memcpy(last_page_x2, page_x2, sizeof(page_x2));
+    last_fill_value = fill_value;
+    last_valid = 1;
+
+    restart();
+}
+
+
+/// @brief Find the columns of the changed pages that can differ from the last frame: those drawn on in either frame.
+///        Leaves x1 and x2 alone if the fill value changed, when any column can differ
+/// @param x1 set to the first column that can differ, greater than x2 if none can
+/// @param x2 set to the last column that can differ
+void oled_display_list::changed_columns(uint8_t *x1, uint8_t *x2)
+{
+    if (!last_valid || fill_value != last_fill_value)
+        return;
+
+    *x1 = 0xFF;
+    *x2 = 0;
+
+    for (uint8_t page = 0; page < OLED_LIST_MAX_PAGES; page++)
+    {
+        if (!page_changed(page))
+            continue;
+
+        if (page_x1[page] < *x1) *x1 = page_x1[page];
+        if (page_x2[page] > *x2) *x2 = page_x2[page];
+        if (last_page_x1[page] < *x1) *x1 = last_page_x1[page];
+        if (last_page_x2[page] > *x2) *x2 = last_page_x2[page];
+    }
+}
+
+
+/// @brief Append a command and add it to the hash of every page it touches
+/// @param cmd command
+/// @param mode draw mode the command is drawn in
+/// @param x1 first column the command can draw on
+/// @param page1 first page the command can draw on
+/// @param x2 last column the command can draw on
+/// @param page2 last page the command can draw on
+/// @param args arguments of the command
+/// @param length bytes of arguments
+/// @return false if the list is full
+bool oled_display_list::add(OLED_list_cmd cmd, uint8_t mode, uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2, const uint8_t *args, uint8_t length)
+{
+    if (used + OLED_LIST_HEADER + length > size)
+        return false;
+
+    uint8_t *entry = &memory[used];
+    entry[0] = cmd | (mode << OLED_LIST_MODE_SHIFT);
+    entry[1] = page1;
+    entry[2] = page2;
+    entry[3] = length;
+    memcpy(&entry[OLED_LIST_HEADER], args, length);
+
+    used += OLED_LIST_HEADER + length;
+
+    // The last fill sets the background of the whole canvas
+    if (cmd == OLED_LIST_FILL)
+        fill_value = args[0];
+
+    // Hashed once, then folded into the hash of each page, in order so that reordered commands count as a change
+    uint32_t hash = LIST_HASH_BASIS;
+
+    for (uint8_t i = 0; i < OLED_LIST_HEADER + length; i++)
+    {
+        hash ^= entry[i];
+        hash *= LIST_HASH_PRIME;
+    }
+
+    for (uint8_t page = page1; page <= page2 && page < OLED_LIST_MAX_PAGES; page++)
+    {
+        page_hashes[page] = (page_hashes[page] ^ hash) * LIST_HASH_PRIME;
+
+        if (cmd != OLED_LIST_FILL && cmd != OLED_LIST_CLIP)
+        {
+            if (x1 < page_x1[page]) page_x1[page] = x1;
+            if (x2 > page_x2[page]) page_x2[page] = x2;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,88 @@
+/**
+ *  oled-display-list.hpp
+ *  Drawing calls recorded as a list of commands instead of being drawn straight away.
+ *  Each page of the screen keeps a hash of the commands that touch it, so at the end of a frame only the
+ *  pages whose commands changed since the last frame are drawn and sent, and identical frames cost nothing.
+ */
+#ifndef _OLED_DISPLAY_LIST_H_
+#define _OLED_DISPLAY_LIST_H_
+
+#include "pico/stdlib.h"
+#include "gfx_font.h"
+
+
+#define OLED_LIST_MAX_PAGES 8       // Pages of the tallest canvas a list can record for
+#define OLED_LIST_HEADER 4          // Bytes before the arguments of each command: command, page range and argument length
+#define OLED_LIST_MODE_SHIFT 4      // The command byte holds the command in its low bits and the draw mode above them
+#define OLED_LIST_TEXT_MAX 247      // Longest string recorded as one OLED_LIST_TEXT, longer ones are recorded glyph by glyph
+
+
+// Commands are the drawing calls everything else is built from
+typedef enum
+{
+    OLED_LIST_FILL,
+    OLED_LIST_BLIT,
+    OLED_LIST_MASKED_BLIT,
+    OLED_LIST_PACKED,
+    OLED_LIST_PIXEL,
+    OLED_LIST_LINE,
+    OLED_LIST_LINE_DOTTED,
+    OLED_LIST_HLINE,
+    OLED_LIST_VLINE,
+    OLED_LIST_RECT,
+    OLED_LIST_TEXT,     // A whole print() call, in the font set by the last OLED_LIST_FONT
+    OLED_LIST_CLIP,     // Clip rectangle for the commands after it, not drawn
+    OLED_LIST_FONT      // Font for the OLED_LIST_TEXT commands after it, not drawn
+} OLED_list_cmd;
+
+
+/// @brief Memory for the commands of one frame and what is needed to compare it with the last frame.
+///        Attach it to a display with set_display_list(); render() draws the pages that changed.
+class oled_display_list
+{
+    private:
+        uint8_t *memory;
+        uint32_t size;
+        uint32_t used;
+
+        // Set when a command didn't fit; the rest of the frame is drawn straight away
+        uint8_t overflowed;
+
+        // Hash of the commands touching each page, this frame and last frame
+        uint32_t page_hashes[OLED_LIST_MAX_PAGES];
+        uint32_t last_page_hashes[OLED_LIST_MAX_PAGES];
+        uint8_t last_valid;
+
+        // Columns drawn on in each page other than by fill(), and the last fill() value, this frame and last frame.
+        // Outside these columns a page only holds the fill value
+        uint8_t page_x1[OLED_LIST_MAX_PAGES], page_x2[OLED_LIST_MAX_PAGES];
+        uint8_t last_page_x1[OLED_LIST_MAX_PAGES], last_page_x2[OLED_LIST_MAX_PAGES];
+        uint8_t fill_value, last_fill_value;
+
+        // Clip rectangle the commands recorded next are drawn with, as kept by oled_canvas
+        uint8_t clip_rect[4];
+
+        // Character table of the font the text recorded next is drawn in, NULL until text is recorded
+        const gfx_char *font_chars;
+
+        bool add(OLED_list_cmd cmd, uint8_t mode, uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2, const uint8_t *args, uint8_t length);
+        bool page_changed(uint8_t page) { return !last_valid || page_hashes[page] != last_page_hashes[page]; }
+        void changed_columns(uint8_t *x1, uint8_t *x2);
+        void end_frame();
+        void restart();
+
+        // Records and plays back the commands
+        friend class oled_canvas;
+
+    public:
+        oled_display_list(uint8_t *memory, uint32_t size);
+        void forget();
+
+        /// @brief Bytes used by the commands recorded so far this frame
+        uint32_t bytes_used() { return used; }
+
+        /// @brief true if the frame being recorded didn't fit and is being drawn straight away
+        bool did_overflow() { return overflowed; }
+};
+
+#endif
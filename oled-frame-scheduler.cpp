@@ -0,0 +1,167 @@
+#include "oled-frame-scheduler.hpp"
+#include "pico-oled.hpp"
+#include "pico/stdlib.h"
+
+
+/// @brief Schedule frames for a display
+/// @param target_display display to send frames to
+/// @param target_fps frame rate to aim for
+oled_frame_scheduler::oled_frame_scheduler(pico_oled *target_display, float target_fps)
+{
+    display = target_display;
+    set_target_fps(target_fps);
+
+    next_frame = get_absolute_time();
+
+    quiet_depth = 0;
+    quiet_until = next_frame;
+
+    reset_stats();
+}
+
+
+/// @brief Change the frame rate to aim for
+/// @param target_fps frames per second
+void oled_frame_scheduler::set_target_fps(float target_fps)
+{
+    frame_period_us = 1000000.0f / target_fps;
+}
+
+
+/// @brief Check whether it is time to draw the next frame. Use this to interleave other work with drawing.
+/// @return true once the next frame slot has started
+bool oled_frame_scheduler::frame_due()
+{
+    return absolute_time_diff_us(next_frame, get_absolute_time()) >= 0;
+}
+
+
+/// @brief Sleep until the next frame slot starts
+void oled_frame_scheduler::wait_for_frame()
+{
+    sleep_until(next_frame);
+}
+
+
+/// @brief Check whether the display bus has to be left alone
+/// @param now current time
+/// @return true during a quiet period
+bool oled_frame_scheduler::in_quiet_period(absolute_time_t now)
+{
+    return quiet_depth > 0 || absolute_time_diff_us(now, quiet_until) > 0;
+}
+
+
+/// @brief End the current frame. Starts sending it if anything was drawn and the bus isn't in a quiet period,
+///        then schedules the next frame slot. Call this once per frame instead of render().
+void oled_frame_scheduler::submit()
+{
+    absolute_time_t now = get_absolute_time();
+    int64_t late_us = absolute_time_diff_us(next_frame, now);
+
+    // Frame slots that went by while this frame was being drawn are dropped, so the schedule doesn't try to catch up
+    if (late_us >= (int64_t) frame_period_us)
+    {
+        uint32_t missed = late_us / frame_period_us;
+
+        stats.frames_dropped += missed;
+        next_frame = delayed_by_us(next_frame, (uint64_t) missed * frame_period_us);
+        late_us -= (int64_t) missed * frame_period_us;
+    }
+
+    next_frame = delayed_by_us(next_frame, frame_period_us);
+
+    // Nothing new to show
+    if (!display->is_dirty())
+    {
+        stats.frames_skipped++;
+        return;
+    }
+
+    // The frame stays in the screen buffer and goes out with the first frame after the quiet period
+    if (in_quiet_period(now))
+    {
+        stats.frames_deferred++;
+        return;
+    }
+
+    display->render_async();
+
+    // Measured against the start of this frame's own slot, so slots that were skipped, deferred or dropped
+    // before it don't count as jitter
+    uint32_t jitter_us = (late_us >= 0) ? late_us : -late_us;
+
+    jitter_sum_us += jitter_us;
+    jitter_samples++;
+
+    if (jitter_us > stats.jitter_max_us)
+        stats.jitter_max_us = jitter_us;
+
+    stats.frames_rendered++;
+}
+
+
+/// @brief Start a quiet period, where nothing is sent to the display until end_quiet() is called.
+///        Waits for a frame that is still being sent, so the bus is idle when this returns. Calls can be nested.
+void oled_frame_scheduler::begin_quiet()
+{
+    quiet_depth++;
+    display->render_wait();
+}
+
+
+/// @brief End a quiet period started by begin_quiet()
+void oled_frame_scheduler::end_quiet()
+{
+    if (quiet_depth > 0)
+        quiet_depth--;
+}
+
+
+/// @brief Keep the display bus quiet for a fixed time, starting now. 
+///        Waits for a frame that is still being sent, so the bus is idle when this returns.
+/// @param duration_us length of the quiet period in microseconds
+void oled_frame_scheduler::quiet_for_us(uint32_t duration_us)
+{
+    absolute_time_t until = make_timeout_time_us(duration_us);
+
+    // Don't shorten a quiet period that is already running
+    if (absolute_time_diff_us(quiet_until, until) > 0)
+        quiet_until = until;
+
+    display->render_wait();
+}
+
+
+/// @brief Get a snapshot of the frame statistics
+/// @return statistics since the last reset_stats()
+oled_frame_stats oled_frame_scheduler::get_stats()
+{
+    oled_frame_stats snapshot = stats;
+    int64_t elapsed_us = absolute_time_diff_us(stats_start, get_absolute_time());
+
+    if (elapsed_us > 0)
+        snapshot.fps = stats.frames_rendered * 1000000.0f / elapsed_us;
+
+    if (jitter_samples > 0)
+        snapshot.jitter_avg_us = jitter_sum_us / jitter_samples;
+
+    return snapshot;
+}
+
+
+/// @brief Clear the frame statistics
+void oled_frame_scheduler::reset_stats()
+{
+    stats_start = get_absolute_time();
+    jitter_sum_us = 0;
+    jitter_samples = 0;
+
+    stats.fps = 0;
+    stats.frames_rendered = 0;
+    stats.frames_skipped = 0;
+    stats.frames_dropped = 0;
+    stats.frames_deferred = 0;
+    stats.jitter_avg_us = 0;
+    stats.jitter_max_us = 0;
+}
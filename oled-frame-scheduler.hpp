@@ -0,0 +1,58 @@
+/**
+ *  oled-frame-scheduler.hpp
+ *  Paces display updates to a target frame rate and keeps statistics on how well it is met
+ */
+#ifndef _OLED_FRAME_SCHEDULER_H_
+#define _OLED_FRAME_SCHEDULER_H_
+
+#include "pico/stdlib.h"
+#include "pico-oled.hpp"
+
+
+typedef struct
+{
+    float fps;                  // Frames sent per second since the statistics were reset
+    uint32_t frames_rendered;   // Frames sent to the display
+    uint32_t frames_skipped;    // Frame slots with nothing new to send
+    uint32_t frames_dropped;    // Frame slots missed because the previous frame ran late
+    uint32_t frames_deferred;   // Frames held back by a quiet period
+    uint32_t jitter_avg_us;     // Average time between the start of a frame's slot and when the frame was sent
+    uint32_t jitter_max_us;     // Largest time between the start of a frame's slot and when the frame was sent
+} oled_frame_stats;
+
+
+/// @brief Schedules display updates at a fixed frame rate instead of ad hoc render()/sleep_ms() calls.
+///        Frames are only sent when something was drawn, and never during quiet periods declared by the application.
+class oled_frame_scheduler
+{
+    private:
+        pico_oled *display;
+        uint32_t frame_period_us;
+        absolute_time_t next_frame;
+
+        // Quiet periods, where nothing may be sent on the display bus
+        uint8_t quiet_depth;
+        absolute_time_t quiet_until;
+
+        // Statistics
+        absolute_time_t stats_start;
+        uint64_t jitter_sum_us;
+        uint32_t jitter_samples;
+        oled_frame_stats stats;
+
+        bool in_quiet_period(absolute_time_t now);
+
+    public:
+        oled_frame_scheduler(pico_oled *target_display, float target_fps);
+        void set_target_fps(float target_fps);
+        bool frame_due();
+        void wait_for_frame();
+        void submit();
+        void begin_quiet();
+        void end_quiet();
+        void quiet_for_us(uint32_t duration_us);
+        oled_frame_stats get_stats();
+        void reset_stats();
+};
+
+#endif
@@ -0,0 +1,324 @@
+# Packs the page format bitmaps and fonts in C headers (as made by image2cpp or font/fnt_parse.py) for
+# oled-packed.hpp. Each asset is coded as RLE and as LZ and the smallest of those and the raw bytes is kept.
+# Writes <name>_packed.h next to each input header and prints the size of every asset before and after.
+#
+# Usage: python3 oled-pack.py [--format auto|raw|rle|lz] header.h [header.h ...]
+
+import argparse
+import os
+import re
+import sys
+from pathlib import Path
+
+
+PAGE_HEIGHT = 8
+
+RLE_MAX_LITERAL = 128
+RLE_MAX_RUN = 129
+
+LZ_MAX_LITERAL = 64
+LZ_MAX_RUN = 65
+LZ_MIN_MATCH = 4            # OLED_PACK_LZ_MIN_MATCH
+LZ_MAX_MATCH = 131
+LZ_MAX_OFFSET = 0xFFFF
+
+FORMATS = {'raw': 'OLED_PACK_RAW', 'rle': 'OLED_PACK_RLE', 'lz': 'OLED_PACK_LZ'}
+
+
+class Packer:
+    """Codes streams one after the other into one block of packed data. LZ copies can come from any earlier
+    stream, so the glyphs of a font share their columns."""
+
+    def __init__(self, fmt):
+        self.fmt = fmt
+        self.out = bytearray()
+        self.literals = {}      # First LZ_MIN_MATCH bytes -> (offset, end of its literal token) in out
+
+    def add(self, data):
+        """Code a stream, return its offset in the packed data"""
+        start = len(self.out)
+
+        if self.fmt == 'raw':
+            self.out += data
+        elif self.fmt == 'rle':
+            self.add_rle(data)
+        else:
+            self.add_lz(data)
+
+        return start
+
+    def add_rle(self, data):
+        literal = bytearray()
+        i = 0
+
+        while i < len(data):
+            run = run_length(data, i, RLE_MAX_RUN)
+
+            # A run of two only pays if it doesn't split a literal token
+            if run >= 3 or (run == 2 and not literal):
+                self.flush_rle(literal)
+                self.out += bytes([0x80 | (run - 2), data[i]])
+                i += run
+                continue
+
+            literal.append(data[i])
+            i += 1
+
+            if len(literal) == RLE_MAX_LITERAL:
+                self.flush_rle(literal)
+
+        self.flush_rle(literal)
+
+    def flush_rle(self, literal):
+        if literal:
+            self.out.append(len(literal) - 1)
+            self.out += literal
+            literal.clear()
+
+    def add_lz(self, data):
+        literal = bytearray()
+        i = 0
+
+        while i < len(data):
+            run = run_length(data, i, LZ_MAX_RUN)
+            offset, length = self.find_match(data, i, literal)
+
+            if length >= LZ_MIN_MATCH and length > run:
+                self.flush_lz(literal)
+                self.out += bytes([0x80 | (length - LZ_MIN_MATCH), offset & 0xFF, offset >> 8])
+                i += length
+            elif run >= 3 or (run == 2 and not literal):
+                self.flush_lz(literal)
+                self.out += bytes([0x40 | (run - 2), data[i]])
+                i += run
+            else:
+                literal.append(data[i])
+                i += 1
+
+                if len(literal) == LZ_MAX_LITERAL:
+                    self.flush_lz(literal)
+
+        self.flush_lz(literal)
+
+    def find_match(self, data, i, literal):
+        """Longest copy of data[i:] from the bytes of a literal token, including the one not written yet"""
+        key = bytes(data[i:i + LZ_MIN_MATCH])
+
+        if len(key) < LZ_MIN_MATCH:
+            return 0, 0
+
+        # The pending literal is written after its token byte
+        pending = len(self.out) + 1
+        candidates = list(self.literals.get(key, []))
+        candidates += [(pending + j, pending + len(literal)) for j in range(len(literal) - LZ_MIN_MATCH + 1)
+                       if literal[j:j + LZ_MIN_MATCH] == key]
+
+        best_offset, best_length = 0, 0
+
+        for offset, end in candidates:
+            if offset > LZ_MAX_OFFSET:
+                continue
+
+            length = 0
+
+            while (length < LZ_MAX_MATCH and i + length < len(data) and offset + length < end and
+                   self.byte_at(offset + length, literal) == data[i + length]):
+                length += 1
+
+            if length > best_length:
+                best_offset, best_length = offset, length
+
+        return best_offset, best_length
+
+    def byte_at(self, offset, literal):
+        if offset < len(self.out):
+            return self.out[offset]
+
+        return literal[offset - len(self.out) - 1]
+
+    def flush_lz(self, literal):
+        if not literal:
+            return
+
+        self.out.append(len(literal) - 1)
+        start = len(self.out)
+        self.out += literal
+
+        for j in range(len(literal) - LZ_MIN_MATCH + 1):
+            key = bytes(literal[j:j + LZ_MIN_MATCH])
+            self.literals.setdefault(key, []).append((start + j, start + len(literal)))
+
+        literal.clear()
+
+
+def run_length(data, i, limit):
+    run = 1
+
+    while run < limit and i + run < len(data) and data[i + run] == data[i]:
+        run += 1
+
+    return run
+
+
+def pack_streams(streams, fmt):
+    """Pack streams in every format, or the one asked for, and keep the smallest. Returns format, data, offsets"""
+    best = None
+
+    for name in (['raw', 'rle', 'lz'] if fmt == 'auto' else [fmt]):
+        packer = Packer(name)
+        offsets = {}
+        starts = []
+
+        # Identical streams, e.g. characters sharing a glyph, are stored once
+        for stream in streams:
+            key = bytes(stream)
+
+            if key not in offsets:
+                offsets[key] = packer.add(stream)
+
+            starts.append(offsets[key])
+
+        if best is None or len(packer.out) < len(best[1]):
+            best = (name, packer.out, starts)
+
+    if len(best[1]) > LZ_MAX_OFFSET + 1:
+        sys.exit(f"Packed data of {len(best[1])} bytes is too big for 16-bit offsets")
+
+    return best
+
+
+def strip_comments(text):
+    return re.sub(r'//[^\n]*', '', text)
+
+
+def parse_bytes(body):
+    return bytearray(int(value, 0) for value in re.findall(r'0x[0-9a-fA-F]+|\d+', strip_comments(body)))
+
+
+def format_bytes(data, indent='    '):
+    lines = []
+
+    for i in range(0, len(data), 16):
+        lines.append(indent + ' '.join(f'0x{value:02x},' for value in data[i:i + 16]))
+
+    return '\n'.join(lines)
+
+
+def format_words(data, indent='    '):
+    lines = []
+
+    for i in range(0, len(data), 12):
+        lines.append(indent + ' '.join(f'{value:5d},' for value in data[i:i + 12]))
+
+    return '\n'.join(lines)
+
+
+def report(name, raw_size, fmt, packed_size):
+    ratio = raw_size / packed_size if packed_size else 1.0
+    print(f"{name}: {raw_size} bytes packed to {packed_size} ({fmt.upper()}), ratio {ratio:.2f}")
+
+
+def pack_header(in_path, fmt):
+    text = Path(in_path).read_text()
+    arrays = {m.group(1): m.group(2) for m in re.finditer(r'const\s+uint8_t\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\};', text, re.S)}
+    char_tables = {m.group(1): m.group(2) for m in re.finditer(r'const\s+gfx_char\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\n\s*\};', text, re.S)}
+    fonts = re.findall(r'const\s+gfx_font\s+(\w+)\s*=\s*\{\s*\(uint8_t\s*\*\)\s*(\w+)\s*,\s*\(gfx_char\s*\*\)\s*(\w+)\s*,'
+                       r'\s*(\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*\}', text)
+
+    out_path = Path(in_path).with_name(Path(in_path).stem + '_packed.h')
+    include_dir = os.path.relpath(Path(__file__).resolve().parent, out_path.resolve().parent)
+    sections = []
+    font_bitmaps = set()
+
+    for font_name, bitmap_name, chars_name, first, last, line_height, src_width in fonts:
+        font_bitmaps.add(bitmap_name)
+        table = parse_bytes(arrays[bitmap_name])
+        src_width = int(src_width)
+        char_lines = [line.strip() for line in char_tables[chars_name].splitlines() if line.strip().startswith('{')]
+        streams = []
+
+        # Every character's glyph is its own bitmap: its columns of the table, as many pages as it is tall
+        for line in char_lines:
+            bitmap_x, width, height = (int(value) for value in re.findall(r'-?\d+', line.split('//')[0])[:3])
+            stream = bytearray()
+
+            for page in range((height + PAGE_HEIGHT - 1) // PAGE_HEIGHT):
+                stream += table[page*src_width + bitmap_x:page*src_width + bitmap_x + width]
+
+            streams.append(stream)
+
+        used, data, offsets = pack_streams(streams, fmt)
+        report(font_name, len(table), used, len(data))
+
+        chars = '\n'.join('\t' + line for line in char_lines)
+        sections.append(
+f""" const uint8_t {font_name}_packed_data[] =
+ {{
+	// '{font_name}', {len(table)} bytes of bitmap table packed to {len(data)} ({used.upper()})
+{format_bytes(data, chr(9))}
+ }};
+
+ const uint16_t {font_name}_packed_offsets[] =
+ {{
+{format_words(offsets, chr(9))}
+ }};
+
+ const gfx_char {font_name}_packed_chars[] =
+ {{
+{chars}
+ }};
+
+ const gfx_font {font_name}_packed = {{NULL, (gfx_char *){font_name}_packed_chars, {first}, {last}, {line_height}, {src_width}, {font_name}_packed_data, {font_name}_packed_offsets, {FORMATS[used]}}};
+""")
+
+    for array_name, body in arrays.items():
+        size = re.search(r"(\d+)x(\d+)px", body)
+
+        if array_name in font_bitmaps or size is None:
+            continue
+
+        width, height = int(size.group(1)), int(size.group(2))
+        raw = parse_bytes(body)
+        name = re.sub(r'_bitmaps?$', '', array_name) + '_packed'
+        used, data, offsets = pack_streams([raw], fmt)
+        report(array_name, len(raw), used, len(data))
+
+        sections.append(
+f"""const uint8_t {name}_data [] =
+{{
+    // '{array_name}', {width}x{height}px, {len(raw)} bytes packed to {len(data)} ({used.upper()})
+{format_bytes(data)}
+}};
+
+const packed_bitmap {name} = {{{name}_data, sizeof({name}_data), {width}, {height}, {FORMATS[used]}}};
+""")
+
+    if not sections:
+        print(f"No bitmaps or fonts found in '{in_path}'")
+        return
+
+    includes = f'#include "{include_dir}/oled-packed.hpp"\n'
+
+    if fonts:
+        includes = f'#include "{include_dir}/gfx_font.h"\n' + includes
+
+    out_path.write_text(
+f"""/**
+ *  {out_path.name}
+ *  Generated by oled-pack.py from {Path(in_path).name}
+ */
+#include "pico/stdlib.h"
+{includes}
+
+""" + '\n\n'.join(sections))
+
+    print(f"Wrote '{out_path}'\n")
+
+
+parser = argparse.ArgumentParser(description="Pack page format bitmaps and fonts for oled-packed.hpp")
+parser.add_argument('--format', choices=['auto', 'raw', 'rle', 'lz'], default='auto', help="format to use, auto keeps the smallest")
+parser.add_argument('headers', nargs='+', help="C headers holding bitmaps or fonts")
+args = parser.parse_args()
+
+for header in args.headers:
+    pack_header(header, args.format)
@@ -0,0 +1,113 @@
+#include "oled-packed.hpp"
+#include <string.h>
+
+
+/// @brief Decode packed data from its start, or from a token inside it such as a packed font's glyph
+/// @param data start of the packed data
+/// @param format OLED_pack_format of the data
+/// @param start offset of the first token to decode
+oled_unpacker::oled_unpacker(const uint8_t *data, uint8_t format, uint16_t start)
+{
+    this->data = data;
+    this->format = format;
+    next = data + start;
+    bytes = NULL;
+    value = 0;
+    left = 0;
+}
+
+
+/// @brief Start on the next token
+void oled_unpacker::next_token()
+{
+    uint8_t token = *next++;
+
+    switch (format)
+    {
+        case OLED_PACK_RLE:
+            if (token < 0x80)
+            {
+                bytes = next;
+                left = token + 1;
+                next += left;
+            }
+            else
+            {
+                bytes = NULL;
+                value = *next++;
+                left = (token & 0x7F) + 2;
+            }
+            break;
+
+        case OLED_PACK_LZ:
+            if (token < 0x40)
+            {
+                bytes = next;
+                left = token + 1;
+                next += left;
+            }
+            else if (token < 0x80)
+            {
+                bytes = NULL;
+                value = *next++;
+                left = (token & 0x3F) + 2;
+            }
+            else
+            {
+                bytes = data + (next[0] | (next[1] << 8));
+                left = (token & 0x7F) + OLED_PACK_LZ_MIN_MATCH;
+                next += 2;
+            }
+            break;
+
+        case OLED_PACK_RAW:
+        default:
+            // The token was the first byte of the data, there are no more tokens
+            bytes = next - 1;
+            left = 0xFFFF;
+            next = bytes + left;
+            break;
+    }
+}
+
+
+/// @brief Skip decoded bytes, without touching the bytes of literal or copied tokens
+/// @param count bytes to skip
+void oled_unpacker::skip(uint32_t count)
+{
+    while (count > 0)
+    {
+        if (left == 0)
+            next_token();
+
+        uint16_t step = (left < count) ? left : count;
+
+        if (bytes != NULL)
+            bytes += step;
+
+        left -= step;
+        count -= step;
+    }
+}
+
+
+/// @brief Decode into memory, e.g. to make an oled_sprite_image from a packed bitmap
+/// @param dest where to put the decoded bytes
+/// @param count bytes to decode
+void oled_unpacker::unpack(uint8_t *dest, uint32_t count)
+{
+    while (count > 0)
+    {
+        const uint8_t *src;
+        uint8_t run_value;
+        uint16_t step = read((count < 0xFFFF) ? count : 0xFFFF, &src, &run_value);
+
+        if (src != NULL)
+            memcpy(dest, src, step);
+        else
+            memset(dest, run_value, step);
+
+        dest += step;
+        count -= step;
+    }
+}
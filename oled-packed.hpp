@@ -0,0 +1,87 @@
+/**
+ *  oled-packed.hpp
+ *  Compressed page format bitmaps and fonts, made by oled-pack.py, and a decoder that hands out the
+ *  decoded bytes straight from the packed data, so they are drawn into the page buffer without being
+ *  unpacked anywhere first.
+ *
+ *  Packed data is the page format bytes of a bitmap, page after page, coded as tokens:
+ *    OLED_PACK_RLE   0x00-0x7F   the next n + 1 bytes as they are
+ *                    0x80-0xFF   the next byte, repeated (n & 0x7F) + 2 times
+ *    OLED_PACK_LZ    0x00-0x3F   the next n + 1 bytes as they are
+ *                    0x40-0x7F   the next byte, repeated (n & 0x3F) + 2 times
+ *                    0x80-0xFF   (n & 0x7F) + 4 bytes copied from the packed data itself, at the offset in the
+ *                                next two bytes (little endian, from the start of the data). The bytes copied are
+ *                                always those of one earlier literal token, so no window of decoded bytes is kept
+ *    OLED_PACK_RAW   the bytes themselves, for assets that don't get smaller
+ */
+#ifndef _OLED_PACKED_H_
+#define _OLED_PACKED_H_
+
+#include "pico/stdlib.h"
+
+
+#define OLED_PACK_LZ_MIN_MATCH 4        // Shortest LZ copy, shorter ones cost as much as the bytes themselves
+
+
+typedef enum
+{
+    OLED_PACK_RAW,
+    OLED_PACK_RLE,
+    OLED_PACK_LZ
+} OLED_pack_format;
+
+// Compressed bitmap, see draw_packed()
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t size;          // Bytes of packed data
+    uint16_t width;
+    uint16_t height;
+    uint8_t format;         // OLED_pack_format
+} packed_bitmap;
+
+
+/// @brief Reads the decoded bytes of packed data in order, as runs of bytes taken from the packed data
+///        or of one repeated value
+class oled_unpacker
+{
+    private:
+        const uint8_t *data;        // Start of the packed data, LZ offsets count from here
+        const uint8_t *next;        // Next token
+        const uint8_t *bytes;       // Rest of the current token's bytes, NULL for a run of value
+        uint8_t value;
+        uint16_t left;              // Bytes of the current token not read yet
+        uint8_t format;
+
+        void next_token();
+
+    public:
+        oled_unpacker(const uint8_t *data, uint8_t format, uint16_t start=0);
+
+        /// @brief Read up to max decoded bytes that come in one piece
+        /// @param max most bytes to read, at least 1
+        /// @param src set to the bytes read, or to NULL if they are all *value
+        /// @param value set to the repeated byte when *src is NULL
+        /// @return bytes read, 1 to max
+        uint16_t read(uint16_t max, const uint8_t **src, uint8_t *value)
+        {
+            if (left == 0)
+                next_token();
+
+            uint16_t count = (left < max) ? left : max;
+
+            *src = bytes;
+            *value = this->value;
+
+            if (bytes != NULL)
+                bytes += count;
+
+            left -= count;
+            return count;
+        }
+
+        void skip(uint32_t count);
+        void unpack(uint8_t *dest, uint32_t count);
+};
+
+#endif
@@ -0,0 +1,190 @@
+#include "oled-pio-transport.hpp"
+#include "oled-pio.pio.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "pico/stdlib.h"
+#include <stdlib.h>
+
+
+/// @brief Talk to a display over SPI using a PIO state machine
+/// @param pio_instance PIO block to use (pio0 or pio1). A free state machine and 2 instructions are claimed from it.
+/// @param clk_pin GPIO connected to the display's clock (SCK/D0) pin
+/// @param data_pin GPIO connected to the display's data (MOSI/D1) pin
+/// @param dc_pin GPIO connected to the display's D/C pin
+/// @param cs_pin GPIO connected to the display's CS pin
+/// @param clock_hz bit clock frequency
+oled_pio_transport::oled_pio_transport(PIO pio_instance, uint8_t clk_pin, uint8_t data_pin, uint8_t dc_pin, uint8_t cs_pin, uint32_t clock_hz)
+{
+    pio = pio_instance;
+    dc_gpio = dc_pin;
+    cs_gpio = cs_pin;
+
+    // Only claimed if write_data_async() is used
+    front_buffer = NULL;
+    front_buf_length = 0;
+    async_active = 0;
+
+    gpio_init(dc_gpio);
+    gpio_set_dir(dc_gpio, GPIO_OUT);
+    gpio_put(dc_gpio, 0);
+
+    gpio_init(cs_gpio);
+    gpio_set_dir(cs_gpio, GPIO_OUT);
+    gpio_put(cs_gpio, 1);    // deselect display
+
+    program_offset = pio_add_program(pio, &oled_spi_tx_program);
+    sm = pio_claim_unused_sm(pio, true);
+    oled_spi_tx_program_init(pio, sm, program_offset, clk_pin, data_pin, clock_hz);
+
+    // DMA moves all display data into the state machine's FIFO
+    dma_chan = dma_claim_unused_channel(true);
+}
+
+
+/// @brief Finish any background transfer and give back the state machine, its program, the DMA channel and
+///        the front buffer
+oled_pio_transport::~oled_pio_transport()
+{
+    wait();
+
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_unclaim(pio, sm);
+    pio_remove_program(pio, &oled_spi_tx_program, program_offset);
+    dma_channel_unclaim(dma_chan);
+    free(front_buffer);
+}
+
+
+/// @brief Start moving bytes into the state machine's TX FIFO
+/// @param data bytes to send
+/// @param length number of bytes
+void oled_pio_transport::start_dma(const uint8_t *data, uint16_t length)
+{
+    // Byte writes are replicated across the FIFO word, which puts each byte where the MSB first shift expects it
+    dma_channel_config config = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, sm, true));
+
+    dma_channel_configure(dma_chan, &config, &pio->txf[sm], data, length, true);
+}
+
+
+/// @brief Block until every byte in the FIFO has been shifted out and the clock is idle
+void oled_pio_transport::wait_idle()
+{
+    // The stall flag is set once the state machine runs out of data. Clearing it while the state machine
+    // is already stalled just sets it again, so this can't miss the end of a transfer
+    uint32_t stall_mask = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    pio->fdebug = stall_mask;
+
+    while (!(pio->fdebug & stall_mask))
+        tight_loop_contents();
+}
+
+
+/// @brief Send a sequence of commands to the display controller
+/// @param cmds bytes to send
+/// @param length number of bytes in cmds
+void oled_pio_transport::write_cmd(const uint8_t *cmds, uint16_t length)
+{
+    // Don't interrupt a frame that is still being sent
+    wait();
+
+    gpio_put(dc_gpio, 0);   // D/C low => bytes are commands
+    gpio_put(cs_gpio, 0);
+
+    // Command lists are short, so the CPU feeds the FIFO directly. Data goes in the top byte for the MSB first shift
+    for (uint16_t i = 0; i < length; i++)
+        pio_sm_put_blocking(pio, sm, (uint32_t) cmds[i] << 24);
+
+    wait_idle();
+    gpio_put(cs_gpio, 1);
+}
+
+
+/// @brief Send data to be written to display RAM
+/// @param buf buf[0] is not used, data starts at buf[1]
+/// @param length number of data bytes
+void oled_pio_transport::write_data(uint8_t *buf, uint16_t length)
+{
+    // Don't interrupt a frame that is still being sent
+    wait();
+
+    gpio_put(dc_gpio, 1);   // D/C high => bytes are written to RAM
+    gpio_put(cs_gpio, 0);
+
+    start_dma(buf + 1, length);
+    dma_channel_wait_for_finish_blocking(dma_chan);
+
+    wait_idle();
+    gpio_put(cs_gpio, 1);
+}
+
+
+/// @brief Copy rows of display data to the front buffer and send them in the background
+/// @param data first byte of the first row
+/// @param width number of bytes in each row
+/// @param stride distance between the start of each row
+/// @param rows number of rows to send
+/// @param clear zero the source bytes as they are copied
+/// @return true, background transfers are always supported
+bool oled_pio_transport::write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear)
+{
+    // The front buffer can't be reused while the previous frame is still using it
+    wait();
+
+    if (front_buf_length < width * rows)
+    {
+        uint8_t *new_buffer = (uint8_t*) realloc(front_buffer, width * rows);
+
+        if (new_buffer == NULL)
+            panic("oled_pio_transport: no memory for front buffer");
+
+        front_buffer = new_buffer;
+        front_buf_length = width * rows;
+    }
+
+    uint16_t count = oled_take_rows(front_buffer, data, width, stride, rows, clear);
+
+    gpio_put(dc_gpio, 1);   // D/C high => bytes are written to RAM
+    gpio_put(cs_gpio, 0);
+
+    start_dma(front_buffer, count);
+    async_active = 1;
+
+    return true;
+}
+
+
+/// @brief Check whether a background transfer is still being sent
+/// @return true until the last bit has been clocked out
+bool oled_pio_transport::busy()
+{
+    if (!async_active)
+        return false;
+
+    if (dma_channel_is_busy(dma_chan) || !pio_sm_is_tx_fifo_empty(pio, sm))
+        return true;
+
+    // FIFO is empty, check whether the state machine is still shifting out the last byte
+    uint32_t stall_mask = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    pio->fdebug = stall_mask;
+
+    return !(pio->fdebug & stall_mask);
+}
+
+
+/// @brief Block until a background transfer has been sent. Returns immediately if none is in progress.
+void oled_pio_transport::wait()
+{
+    if (!async_active)
+        return;
+
+    dma_channel_wait_for_finish_blocking(dma_chan);
+    wait_idle();
+
+    gpio_put(cs_gpio, 1);
+    async_active = 0;
+}
@@ -0,0 +1,44 @@
+/**
+ *  oled-pio-transport.hpp
+ *  SPI style display transport driven by a PIO state machine
+ */
+#ifndef _OLED_PIO_TRANSPORT_H_
+#define _OLED_PIO_TRANSPORT_H_
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "oled-transport.hpp"
+
+
+/// @brief Write-only SPI connection to the display, clocked by a PIO state machine and fed by DMA.
+///        The clock can be set independently of the hardware SPI/I2C blocks, and no CPU time is spent per byte.
+///        The data/command and chip select pins are driven as GPIOs.
+class oled_pio_transport : public oled_transport
+{
+    private:
+        PIO pio;
+        uint sm;
+        uint program_offset;
+        uint8_t dc_gpio;
+        uint8_t cs_gpio;
+        int dma_chan;
+
+        // Frame being sent in the background
+        uint8_t *front_buffer;
+        uint16_t front_buf_length;
+        uint8_t async_active;
+
+        void start_dma(const uint8_t *data, uint16_t length);
+        void wait_idle();
+
+    public:
+        oled_pio_transport(PIO pio_instance, uint8_t clk_pin, uint8_t data_pin, uint8_t dc_pin, uint8_t cs_pin, uint32_t clock_hz);
+        ~oled_pio_transport();
+        void write_cmd(const uint8_t *cmds, uint16_t length);
+        void write_data(uint8_t *buf, uint16_t length);
+        bool write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear=false);
+        bool busy();
+        void wait();
+};
+
+#endif
@@ -0,0 +1,302 @@
+/**
+ *  oled-raster.hpp
+ *  Span kernels for page format buffers. A span is a run of bytes in one page (or several whole pages),
+ *  and each byte gets the same mask applied. The bulk of the span is done a 32-bit word at a time;
+ *  pixel data starts after the header byte so spans are rarely word aligned, the head and tail
+ *  bytes are done one at a time. The rows of a rectangle are too short for that to pay off and are
+ *  done a byte at a time by oled_rows_op().
+ */
+#ifndef _OLED_RASTER_H_
+#define _OLED_RASTER_H_
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "oled-canvas.hpp"
+
+
+// Word access to byte buffers, allowed to alias the bytes around it
+typedef uint32_t __attribute__((__may_alias__)) oled_word_t;
+
+#define OLED_WORD_BYTES sizeof(oled_word_t)
+
+
+/// @brief Apply byte = (byte & and_mask) ^ xor_mask to a run of bytes
+/// @param dest first byte
+/// @param count number of bytes
+/// @param and_mask bits to keep
+/// @param xor_mask bits to toggle after masking
+static inline void oled_span_apply(uint8_t *dest, uint32_t count, uint8_t and_mask, uint8_t xor_mask)
+{
+    // Nothing to keep, plain stores. memset already works a word at a time
+    if (and_mask == 0)
+    {
+        memset(dest, xor_mask, count);
+        return;
+    }
+
+    // Head bytes up to the first word boundary
+    while (count && ((uintptr_t) dest & (OLED_WORD_BYTES - 1)))
+    {
+        *dest = (*dest & and_mask) ^ xor_mask;
+        dest++;
+        count--;
+    }
+
+    oled_word_t *word = (oled_word_t *) dest;
+    oled_word_t and_word = and_mask * 0x01010101u;
+    oled_word_t xor_word = xor_mask * 0x01010101u;
+
+    for (; count >= OLED_WORD_BYTES; count -= OLED_WORD_BYTES)
+    {
+        *word = (*word & and_word) ^ xor_word;
+        word++;
+    }
+
+    // Tail bytes
+    dest = (uint8_t *) word;
+
+    while (count--)
+    {
+        *dest = (*dest & and_mask) ^ xor_mask;
+        dest++;
+    }
+}
+
+
+/// @brief Set every byte of a run to the same value
+static inline void oled_span_fill(uint8_t *dest, uint32_t count, uint8_t value)
+{
+    oled_span_apply(dest, count, 0, value);
+}
+
+
+/// @brief Split a raster op into the drawn pixels it clears and the drawn pixels it then toggles
+/// @param op raster op
+/// @param clear set to 0xFF if drawn pixels are cleared, 0 if not
+/// @param toggle set to 0xFF if drawn pixels are toggled after clearing, 0 if not
+static inline void oled_op_bits(OLED_raster_op op, uint8_t *clear, uint8_t *toggle)
+{
+    switch (op)
+    {
+        case OLED_OP_CLEAR:
+            *clear = 0xFF;
+            *toggle = 0;
+            break;
+
+        case OLED_OP_INVERT:
+            *clear = 0;
+            *toggle = 0xFF;
+            break;
+
+        case OLED_OP_SET:
+        default:
+            *clear = 0xFF;
+            *toggle = 0xFF;
+            break;
+    }
+}
+
+
+/// @brief Draw the masked pixels of one byte with a raster op split by oled_op_bits()
+/// @param dest byte to draw on
+/// @param mask pixels to draw
+/// @param clear clear bits of the op
+/// @param toggle toggle bits of the op
+static inline void oled_byte_op(uint8_t *dest, uint8_t mask, uint8_t clear, uint8_t toggle)
+{
+    *dest = (*dest & ~(mask & clear)) ^ (mask & toggle);
+}
+
+
+/// @brief Set, clear or invert the masked pixels in a run of page bytes
+/// @param dest first byte
+/// @param count number of bytes
+/// @param op what to do to the masked pixels
+/// @param mask pixels (rows of the page) to change
+static inline void oled_span_op(uint8_t *dest, uint32_t count, OLED_raster_op op, uint8_t mask)
+{
+    uint8_t clear, toggle;
+
+    oled_op_bits(op, &clear, &toggle);
+    oled_span_apply(dest, count, ~(mask & clear), mask & toggle);
+}
+
+
+/// @brief Set, clear or invert the masked pixels of a block of page rows with a fixed raster op, see oled_rows_op()
+template <OLED_raster_op Op>
+static inline void oled_rows_op_fixed(uint8_t *dest, uint8_t count, uint16_t stride, uint8_t rows, uint8_t first_mask, uint8_t last_mask)
+{
+    for (uint8_t row = 0; row < rows; row++)
+    {
+        // Worked out per row rather than passed as a constant 0xFF for the middle rows, which compilers turn into
+        // a memset() too short to pay off
+        uint8_t mask = 0xFF;
+
+        if (row == 0)
+            mask &= first_mask;
+
+        if (row == rows - 1)
+            mask &= last_mask;
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (Op == OLED_OP_SET)
+                dest[i] |= mask;
+            else if (Op == OLED_OP_CLEAR)
+                dest[i] &= ~mask;
+            else
+                dest[i] ^= mask;
+        }
+
+        dest += stride;
+    }
+}
+
+
+/// @brief Set, clear or invert the masked pixels of the same columns in consecutive pages, e.g. a rectangle.
+///        Rows are short, so the op is picked once and each byte is a plain OR, AND-NOT or XOR, without the head
+///        and tail bookkeeping of the word loop in oled_span_apply()
+/// @param dest first byte of the first row
+/// @param count number of bytes in each row
+/// @param stride distance between the start of each row
+/// @param rows number of rows
+/// @param op what to do to the masked pixels
+/// @param first_mask pixels to change in the first row
+/// @param last_mask pixels to change in the last row, the middle rows are changed completely
+static inline void oled_rows_op(uint8_t *dest, uint8_t count, uint16_t stride, uint8_t rows, OLED_raster_op op, uint8_t first_mask, uint8_t last_mask)
+{
+    switch (op)
+    {
+        case OLED_OP_CLEAR:
+            oled_rows_op_fixed<OLED_OP_CLEAR>(dest, count, stride, rows, first_mask, last_mask);
+            break;
+
+        case OLED_OP_INVERT:
+            oled_rows_op_fixed<OLED_OP_INVERT>(dest, count, stride, rows, first_mask, last_mask);
+            break;
+
+        case OLED_OP_SET:
+        default:
+            oled_rows_op_fixed<OLED_OP_SET>(dest, count, stride, rows, first_mask, last_mask);
+            break;
+    }
+}
+
+
+/// @brief Draw source bytes onto a run of page bytes with a fixed raster op, see oled_blit_span()
+template <OLED_raster_op Op>
+static inline void oled_blit_span_op(uint8_t *dest, const uint8_t *src, uint8_t count, uint8_t keep_mask, uint8_t shift_down, uint8_t shift_up)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t bits = (uint8_t) ((src[i] & keep_mask) << shift_down) >> shift_up;
+
+        if (Op == OLED_OP_SET)
+            dest[i] |= bits;
+        else if (Op == OLED_OP_CLEAR)
+            dest[i] &= ~bits;
+        else
+            dest[i] ^= bits;
+    }
+}
+
+
+/// @brief Draw a run of source columns onto one page. The op is picked once per run, so each column is a
+///        plain OR, AND-NOT or XOR
+/// @param dest first byte of the page to draw on
+/// @param src first source byte, one per column
+/// @param count number of columns
+/// @param keep_mask source bits to draw, before shifting
+/// @param shift_down bits to move the source towards the bottom of the page (MSB)
+/// @param shift_up bits to move the source towards the top of the page (LSB)
+/// @param op what to do to the pixels lit in the source
+static inline void oled_blit_span(uint8_t *dest, const uint8_t *src, uint8_t count, uint8_t keep_mask, uint8_t shift_down, uint8_t shift_up, OLED_raster_op op)
+{
+    switch (op)
+    {
+        case OLED_OP_CLEAR:
+            oled_blit_span_op<OLED_OP_CLEAR>(dest, src, count, keep_mask, shift_down, shift_up);
+            break;
+
+        case OLED_OP_INVERT:
+            oled_blit_span_op<OLED_OP_INVERT>(dest, src, count, keep_mask, shift_down, shift_up);
+            break;
+
+        case OLED_OP_SET:
+        default:
+            oled_blit_span_op<OLED_OP_SET>(dest, src, count, keep_mask, shift_down, shift_up);
+            break;
+    }
+}
+
+
+/// @brief Draw source columns taken from two source pages onto one page with a fixed raster op, see oled_blit_span16()
+template <OLED_raster_op Op>
+static inline void oled_blit_span16_op(uint8_t *dest, const uint8_t *src_lo, const uint8_t *src_hi, uint8_t count, uint8_t shift, uint8_t mask)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t bits = (uint8_t) ((src_lo[i] | (src_hi[i] << 8)) >> shift) & mask;
+
+        if (Op == OLED_OP_SET)
+            dest[i] |= bits;
+        else if (Op == OLED_OP_CLEAR)
+            dest[i] &= ~bits;
+        else
+            dest[i] ^= bits;
+    }
+}
+
+
+/// @brief Draw a run of source columns that straddle two source pages onto one page. Each column of the two pages
+///        is read as one 16-bit word, shifted once and masked once
+/// @param dest first byte of the page to draw on
+/// @param src_lo first source byte of the upper source page
+/// @param src_hi first source byte of the lower source page
+/// @param count number of columns
+/// @param shift source rows above the top row of the page, 0-7
+/// @param mask rows of the page to draw
+/// @param op what to do to the pixels lit in the source
+static inline void oled_blit_span16(uint8_t *dest, const uint8_t *src_lo, const uint8_t *src_hi, uint8_t count, uint8_t shift, uint8_t mask, OLED_raster_op op)
+{
+    switch (op)
+    {
+        case OLED_OP_CLEAR:
+            oled_blit_span16_op<OLED_OP_CLEAR>(dest, src_lo, src_hi, count, shift, mask);
+            break;
+
+        case OLED_OP_INVERT:
+            oled_blit_span16_op<OLED_OP_INVERT>(dest, src_lo, src_hi, count, shift, mask);
+            break;
+
+        case OLED_OP_SET:
+        default:
+            oled_blit_span16_op<OLED_OP_SET>(dest, src_lo, src_hi, count, shift, mask);
+            break;
+    }
+}
+
+
+/// @brief Draw a run of masked source columns onto one page: dest = (dest & ~mask) | (image & mask). Like
+///        oled_blit_span16(), each column of two source pages is read as one 16-bit word and shifted once
+/// @param dest first byte of the page to draw on
+/// @param image_lo first image byte of the upper source page
+/// @param image_hi first image byte of the lower source page
+/// @param mask_lo first mask byte of the upper source page
+/// @param mask_hi first mask byte of the lower source page
+/// @param count number of columns
+/// @param shift source rows above the top row of the page, 0-7
+/// @param rows rows of the page to draw
+static inline void oled_mask_span16(uint8_t *dest, const uint8_t *image_lo, const uint8_t *image_hi, const uint8_t *mask_lo, const uint8_t *mask_hi,
+    uint8_t count, uint8_t shift, uint8_t rows)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t mask = (uint8_t) ((mask_lo[i] | (mask_hi[i] << 8)) >> shift) & rows;
+        uint8_t bits = (uint8_t) ((image_lo[i] | (image_hi[i] << 8)) >> shift);
+
+        dest[i] = (dest[i] & ~mask) | (bits & mask);
+    }
+}
+
+#endif
@@ -0,0 +1,212 @@
+#include "oled-render-service.hpp"
+#include "pico-oled.hpp"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/// @brief Create a render service for a display. Nothing runs until start() is called.
+/// @param target_display display to send frames to. It should be initialized with oled_init() first.
+oled_render_service::oled_render_service(pico_oled *target_display)
+{
+    display = target_display;
+    own_buffer = NULL;
+
+    buffers[0] = NULL;
+    buffers[1] = NULL;
+    buffers[2] = NULL;
+
+    published_seq = 0;
+    sent_seq = 0;
+    sent_count = 0;
+    dropped_count = 0;
+    stopping.store(false);
+    running = false;
+}
+
+
+/// @brief Allocate the extra frame buffers and launch the service on core 1. Can be called again after stop().
+void oled_render_service::start()
+{
+    if (running)
+        return;
+
+    own_buffer = display->screen_buffer;
+
+    for (uint8_t slot = 0; slot < 3; slot++)
+    {
+        // The display's own buffer is the first one drawn into
+        if (slot == frames.back_slot())
+        {
+            buffers[slot] = display->screen_buffer;
+            continue;
+        }
+
+        buffers[slot] = (uint8_t*) malloc(display->screen_buf_length);
+
+        if (buffers[slot] == NULL)
+            panic("oled_render_service: no memory for frame buffers");
+
+        memcpy(buffers[slot], display->screen_buffer, display->screen_buf_length);
+    }
+
+    // Core 1 picks up which service to run from the FIFO
+    stopping.store(false);
+    running = true;
+    multicore_launch_core1(core1_entry);
+    multicore_fifo_push_blocking((uintptr_t) this);
+}
+
+
+/// @brief Wait for core 1 to send the last published frame, then reset core 1 and free the extra frame buffers.
+///        Drawing carries on in the display's own buffer, and render() can be used again once this returns.
+void oled_render_service::stop()
+{
+    if (!running)
+        return;
+
+    // Core 1 only checks for the stop once there are no new frames, and says when it's done through the FIFO
+    stopping.store(true);
+    __sev();
+    multicore_fifo_pop_blocking();
+    multicore_reset_core1();
+    running = false;
+
+    // The frame being drawn may be in one of the extra buffers
+    if (display->screen_buffer != own_buffer)
+        memcpy(own_buffer, display->screen_buffer, display->screen_buf_length);
+
+    display->screen_buffer = own_buffer;
+
+    for (uint8_t slot = 0; slot < 3; slot++)
+    {
+        if (buffers[slot] != own_buffer)
+            free(buffers[slot]);
+
+        buffers[slot] = NULL;
+    }
+}
+
+
+/// @brief Hand the frame drawn so far to core 1 and carry on drawing in a free buffer. Use this instead of render().
+///        Never waits for core 1. If core 1 is still busy with an older frame, the newest published frame replaces
+///        any frame it hasn't started sending yet.
+void oled_render_service::publish()
+{
+    if (!running)
+        return;
+
+    // Draw the pages of a recorded frame that changed since the last one
+    display->finish_display_list();
+
+    // Nothing was drawn, so there is nothing to send
+    if (display->dirty_x1 > display->dirty_x2 || display->dirty_page1 > display->dirty_page2)
+        return;
+
+    uint8_t slot = frames.back_slot();
+
+    slot_x1[slot] = display->dirty_x1;
+    slot_x2[slot] = display->dirty_x2;
+    slot_page1[slot] = display->dirty_page1;
+    slot_page2[slot] = display->dirty_page2;
+    display->clear_dirty();
+
+    uint8_t next = frames.publish(++published_seq);
+
+    // Carry the frame over so drawing continues from it, the same as after render()
+    memcpy(buffers[next], buffers[slot], display->screen_buf_length);
+    display->screen_buffer = buffers[next];
+
+    // Wake core 1 if it's waiting for a frame
+    __sev();
+}
+
+
+/// @brief Core 1 entry point. Receives the service to run from core 0, and tells core 0 when it has stopped
+void oled_render_service::core1_entry()
+{
+    oled_render_service *service = (oled_render_service *) (uintptr_t) multicore_fifo_pop_blocking();
+    service->core1_loop();
+    multicore_fifo_push_blocking(0);
+}
+
+
+/// @brief Send each new frame as it's published. Runs on core 1 until stop() is called and every frame is sent
+void oled_render_service::core1_loop()
+{
+    uint8_t width = display->oled_width;
+    uint8_t pages = display->oled_height / OLED_PAGE_HEIGHT;
+
+    // Fallback for transports that can't copy the frame themselves. The published frame must not be written to,
+    // since core 0 may be copying it, so rows are sent from here instead of borrowing a header byte from the frame
+    uint8_t *row_buffer = NULL;
+
+    while (true)
+    {
+        uint32_t seq;
+        int8_t slot = frames.acquire(&seq);
+
+        if (slot < 0)
+        {
+            if (stopping.load())
+                break;
+
+            __wfe();
+            continue;
+        }
+
+        uint8_t x1 = slot_x1[slot];
+        uint8_t x2 = slot_x2[slot];
+        uint8_t page1 = slot_page1[slot];
+        uint8_t page2 = slot_page2[slot];
+
+        // The changed regions of dropped frames are lost, so send everything
+        if (seq != sent_seq + 1)
+        {
+            dropped_count += seq - sent_seq - 1;
+            x1 = 0;
+            x2 = width - 1;
+            page1 = 0;
+            page2 = pages - 1;
+        }
+
+        uint32_t start_us = time_us_32();
+        uint16_t bytes = (x2 - x1 + 1)*(page2 - page1 + 1);
+
+        display->set_window(x1, page1, x2, page2);
+
+        uint8_t *frame = buffers[slot];
+
+        if (display->transport->write_data_async(&frame[1 + x1 + page1*width], x2 - x1 + 1, width, page2 - page1 + 1))
+        {
+            // Counted like render_async(), up to the start of the transfer
+            display->record_sent_frame(start_us, bytes, 1);
+            display->transport->wait();
+        }
+        else
+        {
+            if (row_buffer == NULL)
+            {
+                row_buffer = (uint8_t*) malloc(width + 1);
+
+                if (row_buffer == NULL)
+                    panic("oled_render_service: no memory for row buffer");
+            }
+
+            for (uint8_t page = page1; page <= page2; page++)
+            {
+                memcpy(&row_buffer[1], &frame[1 + x1 + page*width], x2 - x1 + 1);
+                display->transport->write_data(row_buffer, x2 - x1 + 1);
+            }
+
+            display->record_sent_frame(start_us, bytes, page2 - page1 + 1);
+        }
+
+        sent_seq = seq;
+        sent_count++;
+    }
+
+    free(row_buffer);
+}
@@ -0,0 +1,133 @@
+/**
+ *  oled-render-service.hpp
+ *  Sends frames to a display from the RP2040's second core
+ */
+#ifndef _OLED_RENDER_SERVICE_H_
+#define _OLED_RENDER_SERVICE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include "pico-oled.hpp"
+
+
+/// @brief Lock-free hand-off of frames between one producer and one consumer using three slots.
+///        The producer always has a slot to draw into and the consumer always gets the newest finished frame,
+///        older unsent frames are dropped. Only atomic loads and stores are used, so it works on cores without
+///        read-modify-write instructions (Cortex-M0+) and neither side ever waits for the other.
+class oled_triple_buffer
+{
+    private:
+        std::atomic<uint8_t> latest;    // Most recently published slot
+        std::atomic<uint8_t> reading;   // Slot the consumer is using
+        uint32_t slot_seq[3];           // Frame number held by each slot, written before the slot is published
+        uint8_t back;                   // Slot the producer is drawing into, only used by the producer
+        uint32_t consumed_seq;          // Frame number last returned by acquire(), only used by the consumer
+
+    public:
+        oled_triple_buffer()
+        {
+            // Slot 0 holds frame 0, which counts as already consumed
+            slot_seq[0] = 0;
+            slot_seq[1] = 0;
+            slot_seq[2] = 0;
+            latest.store(0);
+            reading.store(0);
+            back = 1;
+            consumed_seq = 0;
+        }
+
+        /// @brief Slot the producer should draw into
+        uint8_t back_slot() { return back; }
+
+        /// @brief Publish the back slot as the newest frame and move to a free slot. Producer only.
+        /// @param frame_seq frame number of the published frame, must differ from the previous one
+        /// @return the slot to draw into next
+        uint8_t publish(uint32_t frame_seq)
+        {
+            slot_seq[back] = frame_seq;
+            latest.store(back);
+
+            // Move to the slot that is neither the newest frame nor being read.
+            // If the consumer is part way through claiming the old latest slot it will see latest change and retry
+            uint8_t in_use = reading.load();
+
+            for (uint8_t slot = 0; slot < 3; slot++)
+            {
+                if (slot != back && slot != in_use)
+                {
+                    back = slot;
+                    break;
+                }
+            }
+
+            return back;
+        }
+
+        /// @brief Claim the newest frame if it hasn't been returned before. Consumer only.
+        ///        The slot stays claimed until the next call.
+        /// @param frame_seq set to the frame number of the returned slot
+        /// @return slot holding the newest frame, or -1 if there is nothing new
+        int8_t acquire(uint32_t *frame_seq)
+        {
+            uint8_t slot;
+
+            // Claim the latest slot, and check it didn't change before the claim was visible to the producer
+            do
+            {
+                slot = latest.load();
+                reading.store(slot);
+            }
+            while (latest.load() != slot);
+
+            if (slot_seq[slot] == consumed_seq)
+                return -1;
+
+            consumed_seq = slot_seq[slot];
+            *frame_seq = consumed_seq;
+            return slot;
+        }
+};
+
+
+/// @brief Runs on core 1 and sends frames published by core 0 to the display.
+///        While the service runs it owns the display's transport, so core 0 must not call render(),
+///        render_async() or any function that sends commands until stop() returns. Uses the display's screen buffer
+///        plus two more.
+class oled_render_service
+{
+    private:
+        pico_oled *display;
+        uint8_t *own_buffer;
+        uint8_t *buffers[3];
+        oled_triple_buffer frames;
+
+        // Changed region of each slot relative to the frame published before it, written by the producer
+        uint8_t slot_x1[3], slot_x2[3], slot_page1[3], slot_page2[3];
+
+        uint32_t published_seq;
+        uint32_t sent_seq;              // Frame number core 1 sent last, only used by core 1 while it runs
+        volatile uint32_t sent_count;
+        volatile uint32_t dropped_count;
+        std::atomic<bool> stopping;
+        bool running;
+
+        static void core1_entry();
+        void core1_loop();
+
+    public:
+        oled_render_service(pico_oled *target_display);
+        void start();
+        void stop();
+        void publish();
+
+        /// @brief Number of frames published by core 0
+        uint32_t frames_published() { return published_seq; }
+
+        /// @brief Number of frames sent to the display by core 1
+        uint32_t frames_sent() { return sent_count; }
+
+        /// @brief Number of frames replaced by a newer frame before core 1 could send them
+        uint32_t frames_dropped() { return dropped_count; }
+};
+
+#endif
@@ -0,0 +1,221 @@
+#include "oled-sprite.hpp"
+#include <stdlib.h>
+
+
+#define SPRITE_NONE 0xFF        // End of the draw order
+
+
+/// @brief Make the shifted copies of a bitmap
+/// @param src_bitmap page format bitmap, width bytes per page. Must stay valid, it is used as the unshifted copy
+/// @param width width in pixels
+/// @param height height in pixels
+/// @param memory bytes_needed(width, height) bytes for the shifted copies, or NULL to allocate them
+oled_sprite_image::oled_sprite_image(const uint8_t *src_bitmap, uint8_t width, uint8_t height, uint8_t *memory)
+{
+    this->width = width;
+    this->height = height;
+
+    if (memory == NULL)
+    {
+        memory = (uint8_t*) malloc(bytes_needed(width, height));
+
+        if (memory == NULL)
+            panic("oled_sprite_image: no memory for shifted copies");
+    }
+
+    uint8_t src_pages = (height + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT;
+
+    planes[0] = src_bitmap;
+
+    for (uint8_t shift = 1; shift < OLED_PAGE_HEIGHT; shift++)
+    {
+        uint8_t pages = (height + shift + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT;
+
+        // Each page takes the bottom of the source page above it and the top of the one at its own position
+        for (uint8_t page = 0; page < pages; page++)
+        {
+            for (uint8_t column = 0; column < width; column++)
+            {
+                uint8_t bits = 0;
+
+                if (page < src_pages)
+                    bits |= src_bitmap[column + page*width] << shift;
+
+                if (page > 0)
+                    bits |= src_bitmap[column + (page - 1)*width] >> (OLED_PAGE_HEIGHT - shift);
+
+                memory[column + page*width] = bits;
+            }
+        }
+
+        planes[shift] = memory;
+        memory += pages * width;
+    }
+}
+
+
+/// @brief Keep sprites in a caller provided array
+/// @param memory array of capacity sprites
+/// @param capacity most sprites the list can hold, up to 254
+oled_sprite_list::oled_sprite_list(oled_sprite *memory, uint8_t capacity)
+{
+    sprites = memory;
+    this->capacity = (capacity < SPRITE_NONE) ? capacity : SPRITE_NONE - 1;
+
+    clear();
+}
+
+
+/// @brief Remove every sprite
+void oled_sprite_list::clear()
+{
+    for (uint8_t slot = 0; slot < capacity; slot++)
+        sprites[slot].image = NULL;
+
+    first = SPRITE_NONE;
+}
+
+
+/// @brief Insert a slot into the draw order after every sprite with the same or a lower depth
+void oled_sprite_list::link(uint8_t slot)
+{
+    uint8_t *link = &first;
+
+    while (*link != SPRITE_NONE && sprites[*link].depth <= sprites[slot].depth)
+        link = &sprites[*link].next;
+
+    sprites[slot].next = *link;
+    *link = slot;
+}
+
+
+/// @brief Take a slot out of the draw order
+void oled_sprite_list::unlink(uint8_t slot)
+{
+    uint8_t *link = &first;
+
+    while (*link != SPRITE_NONE && *link != slot)
+        link = &sprites[*link].next;
+
+    if (*link == slot)
+        *link = sprites[slot].next;
+}
+
+
+/// @brief Add a visible sprite, drawn in OLED_OP_SET mode
+/// @param image what the sprite looks like
+/// @param x screen x coordinate of the top-left corner
+/// @param y screen y coordinate of the top-left corner
+/// @param depth draw order, lower depths are drawn first
+/// @return the sprite, or NULL if the list is full
+oled_sprite *oled_sprite_list::add(const oled_sprite_image *image, int16_t x, int16_t y, int8_t depth)
+{
+    for (uint8_t slot = 0; slot < capacity; slot++)
+    {
+        if (sprites[slot].image != NULL)
+            continue;
+
+        oled_sprite *sprite = &sprites[slot];
+        sprite->image = image;
+        sprite->x = x;
+        sprite->y = y;
+        sprite->depth = depth;
+        sprite->visible = 1;
+        sprite->op = OLED_OP_SET;
+
+        link(slot);
+        return sprite;
+    }
+
+    return NULL;
+}
+
+
+/// @brief Remove a sprite from the list. Its slot is reused by the next add()
+void oled_sprite_list::remove(oled_sprite *sprite)
+{
+    unlink(sprite - sprites);
+    sprite->image = NULL;
+}
+
+
+/// @brief Change the draw order of a sprite. It is drawn after the other sprites with the same depth
+void oled_sprite_list::set_depth(oled_sprite *sprite, int8_t depth)
+{
+    unlink(sprite - sprites);
+    sprite->depth = depth;
+    link(sprite - sprites);
+}
+
+
+/// @brief Draw every visible sprite, from low to high depth, each in its own draw mode
+/// @param canvas canvas to draw on
+void oled_sprite_list::draw(oled_canvas *canvas)
+{
+    OLED_raster_op saved_op = canvas->get_draw_mode();
+
+    for (uint8_t slot = first; slot != SPRITE_NONE; slot = sprites[slot].next)
+    {
+        const oled_sprite *sprite = &sprites[slot];
+
+        if (!sprite->visible)
+            continue;
+
+        canvas->set_draw_mode(sprite->op);
+        canvas->draw_sprite(sprite->image, sprite->x, sprite->y);
+    }
+
+    canvas->set_draw_mode(saved_op);
+}
+
+
+/// @brief Check whether the bounding boxes of two sprites overlap
+bool oled_sprite_list::overlaps(const oled_sprite *a, const oled_sprite *b)
+{
+    return a->x < b->x + b->image->get_width() && b->x < a->x + a->image->get_width() &&
+           a->y < b->y + b->image->get_height() && b->y < a->y + a->image->get_height();
+}
+
+
+/// @brief Find the visible sprites whose bounding box overlaps that of a sprite, in draw order:
+///        for (hit = find_overlap(s); hit; hit = find_overlap(s, hit))
+/// @param sprite sprite to check, need not be in the list or visible
+/// @param after sprite the last call returned, NULL to start from the first
+/// @return the next overlapping sprite, or NULL if there are no more
+oled_sprite *oled_sprite_list::find_overlap(const oled_sprite *sprite, const oled_sprite *after)
+{
+    uint8_t slot = (after != NULL) ? after->next : first;
+
+    for (; slot != SPRITE_NONE; slot = sprites[slot].next)
+    {
+        oled_sprite *other = &sprites[slot];
+
+        if (other != sprite && other->visible && overlaps(sprite, other))
+            return other;
+    }
+
+    return NULL;
+}
+
+
+/// @brief Find the topmost (last drawn) visible sprite whose bounding box holds a point
+/// @param x screen x coordinate
+/// @param y screen y coordinate
+/// @return the sprite, or NULL if there is none
+oled_sprite *oled_sprite_list::sprite_at(int16_t x, int16_t y)
+{
+    oled_sprite *found = NULL;
+
+    for (uint8_t slot = first; slot != SPRITE_NONE; slot = sprites[slot].next)
+    {
+        oled_sprite *sprite = &sprites[slot];
+
+        if (sprite->visible && x >= sprite->x && x < sprite->x + sprite->image->get_width() &&
+            y >= sprite->y && y < sprite->y + sprite->image->get_height())
+        {
+            found = sprite;
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,81 @@
+/**
+ *  oled-sprite.hpp
+ *  Bitmaps kept in all eight vertical positions within a page, so drawing one at any y position is a
+ *  masked OR (or AND-NOT, XOR) of whole bytes with no shifting, and lists of sprites drawn in depth
+ *  order with bounding box collision queries.
+ */
+#ifndef _OLED_SPRITE_H_
+#define _OLED_SPRITE_H_
+
+#include "pico/stdlib.h"
+#include "oled-canvas.hpp"
+
+
+/// @brief A page format bitmap and its copies shifted down by 1-7 rows. Shift s of a bitmap h rows tall
+///        takes (h + s + 7) / 8 pages; shift 0 is the bitmap itself and takes no memory.
+class oled_sprite_image
+{
+    private:
+        const uint8_t *planes[OLED_PAGE_HEIGHT];
+        uint8_t width, height;
+
+    public:
+        oled_sprite_image(const uint8_t *src_bitmap, uint8_t width, uint8_t height, uint8_t *memory=NULL);
+
+        /// @brief Bytes of memory needed for the shifted copies of a bitmap of the given size
+        static uint32_t bytes_needed(uint8_t width, uint8_t height)
+        {
+            uint32_t pages = 0;
+
+            for (uint8_t shift = 1; shift < OLED_PAGE_HEIGHT; shift++)
+                pages += (height + shift + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT;
+
+            return pages * width;
+        }
+
+        uint8_t get_width() const { return width; }
+        uint8_t get_height() const { return height; }
+
+        /// @brief The bitmap shifted down by shift rows, in pages of width bytes
+        const uint8_t *get_plane(uint8_t shift) const { return planes[shift]; }
+};
+
+
+/// @brief One sprite of an oled_sprite_list. x, y, visible and op can be changed directly
+typedef struct
+{
+    const oled_sprite_image *image;     // NULL for a free slot
+    int16_t x, y;                       // Screen position of the top-left corner
+    int8_t depth;                       // Sprites are drawn from low to high depth, change with set_depth()
+    uint8_t visible;                    // Hidden sprites are not drawn and don't collide
+    OLED_raster_op op;                  // Draw mode the sprite is drawn in
+    uint8_t next;                       // Next slot in draw order, kept by the list
+} oled_sprite;
+
+
+/// @brief Sprites drawn together each frame, in depth order. Sprites with the same depth are drawn in the order
+///        they were added. Slots never move, so sprite pointers stay valid until the sprite is removed.
+class oled_sprite_list
+{
+    private:
+        oled_sprite *sprites;
+        uint8_t capacity;
+        uint8_t first;      // First slot in draw order
+
+        void link(uint8_t slot);
+        void unlink(uint8_t slot);
+
+    public:
+        oled_sprite_list(oled_sprite *memory, uint8_t capacity);
+        oled_sprite *add(const oled_sprite_image *image, int16_t x, int16_t y, int8_t depth=0);
+        void remove(oled_sprite *sprite);
+        void clear();
+        void set_depth(oled_sprite *sprite, int8_t depth);
+        void draw(oled_canvas *canvas);
+
+        static bool overlaps(const oled_sprite *a, const oled_sprite *b);
+        oled_sprite *find_overlap(const oled_sprite *sprite, const oled_sprite *after=NULL);
+        oled_sprite *sprite_at(int16_t x, int16_t y);
+};
+
+#endif
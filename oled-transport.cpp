@@ -0,0 +1,359 @@
+#include "oled-transport.hpp"
+#include "pico-oled.hpp"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "pico/stdlib.h"
+#include <stdlib.h>
+
+
+#define OLED_CMD_LIST_MAX 32    // Longest command list sent in one I2C transaction
+
+
+/// @brief Make sure a front buffer can hold the requested number of elements, growing it if needed
+/// @param buffer front buffer pointer to update
+/// @param capacity current capacity of the buffer, updated if the buffer grows
+/// @param required number of elements needed
+/// @param element_size size of each element in bytes
+static void reserve_front_buffer(void **buffer, uint16_t *capacity, uint16_t required, size_t element_size)
+{
+    if (*capacity >= required)
+        return;
+
+    void *new_buffer = realloc(*buffer, required * element_size);
+
+    if (new_buffer == NULL)
+        panic("oled_transport: no memory for front buffer");
+
+    *buffer = new_buffer;
+    *capacity = required;
+}
+
+
+oled_i2c_transport *oled_i2c_transport::bus_owner[NUM_I2CS] = {NULL};
+
+
+/// @brief Talk to a display over I2C
+/// @param i2c_instance I2C block the display is connected to. It must already be initialized.
+/// @param i2c_address 7-bit address of the display
+oled_i2c_transport::oled_i2c_transport(i2c_inst_t *i2c_instance, uint8_t i2c_address)
+{
+    i2c = i2c_instance;
+    i2c_addr = i2c_address;
+
+    // DMA resources are only claimed if write_data_async() is used
+    front_buffer = NULL;
+    front_buf_length = 0;
+    dma_chan = -1;
+    async_active = 0;
+    async_failed = 0;
+}
+
+
+/// @brief Finish any background transfer and give back the DMA channel and front buffer
+oled_i2c_transport::~oled_i2c_transport()
+{
+    wait();
+
+    if (dma_chan >= 0)
+        dma_channel_unclaim(dma_chan);
+
+    free(front_buffer);
+}
+
+
+/// @brief Wait for any background transfer on this I2C block to finish, whichever display it belongs to
+void oled_i2c_transport::claim_bus()
+{
+    oled_i2c_transport *owner = bus_owner[i2c_hw_index(i2c)];
+
+    if (owner != NULL)
+        owner->wait();
+}
+
+
+/// @brief Send a sequence of commands to the display controller in a single transaction
+/// @param cmds bytes to send
+/// @param length number of bytes in cmds
+void oled_i2c_transport::write_cmd(const uint8_t *cmds, uint16_t length)
+{
+    // Don't interrupt a frame that is still being sent
+    claim_bus();
+
+    // Co = 0, D/C = 0 => every following byte in this transaction is a command
+    uint8_t buf[OLED_CMD_LIST_MAX + 1];
+    buf[0] = 0x00;
+
+    // Lists longer than the buffer are split into several transactions
+    while (length > 0)
+    {
+        uint16_t chunk = (length > OLED_CMD_LIST_MAX) ? OLED_CMD_LIST_MAX : length;
+
+        for (uint16_t i = 0; i < chunk; i++)
+            buf[1 + i] = cmds[i];
+
+        i2c_write_blocking(i2c, (i2c_addr & OLED_WRITE_MODE), buf, chunk + 1, false);
+
+        cmds += chunk;
+        length -= chunk;
+    }
+}
+
+
+/// @brief Send data to be written to display RAM
+/// @param buf buf[0] is overwritten with the control byte, data starts at buf[1]
+/// @param length number of data bytes
+void oled_i2c_transport::write_data(uint8_t *buf, uint16_t length)
+{
+    // Don't interrupt a frame that is still being sent
+    claim_bus();
+
+    // Control byte, Co = 0, D/C = 1 => the driver expects data to be written to RAM
+    buf[0] = 0x40;
+    i2c_write_blocking(i2c, (i2c_addr & OLED_WRITE_MODE), buf, length + 1, false);
+}
+
+
+/// @brief Copy rows of display data to the front buffer and send them by DMA as one transaction
+/// @param data first byte of the first row
+/// @param width number of bytes in each row
+/// @param stride distance between the start of each row
+/// @param rows number of rows to send
+/// @param clear zero the source bytes as they are copied
+/// @return true, I2C always supports background transfers
+bool oled_i2c_transport::write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear)
+{
+    // The front buffer can't be reused while the previous frame is still using it,
+    // and the bus may be busy with another display's frame
+    claim_bus();
+
+    // Claim DMA resources on first use
+    reserve_front_buffer((void **) &front_buffer, &front_buf_length, width * rows + 1, sizeof(uint16_t));
+
+    if (dma_chan < 0)
+        dma_chan = dma_claim_unused_channel(true);
+
+    front_buffer[0] = 0x40;     // Control byte, Co = 0, D/C = 1
+    uint16_t count = 1 + oled_take_rows(front_buffer + 1, data, width, stride, rows, clear);
+
+    // Generate a stop condition after the last byte
+    front_buffer[count - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    // Address the display the same way i2c_write_blocking() does
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    hw->enable = 0;
+    hw->tar = (i2c_addr & OLED_WRITE_MODE);
+    hw->enable = 1;
+    (void) hw->clr_stop_det;   // Reading clears the flag so the end of this frame can be detected
+    hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS;
+
+    // 16 bit transfers so the stop flag reaches the data/command register
+    dma_channel_config config = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, i2c_get_dreq(i2c, true));
+
+    dma_channel_configure(dma_chan, &config, &hw->data_cmd, front_buffer, count, true);
+    async_active = 1;
+    async_failed = 0;
+    bus_owner[i2c_hw_index(i2c)] = this;
+
+    return true;
+}
+
+
+/// @brief Check whether a background transfer is still being sent
+/// @return true until the DMA transfer has completed and the stop condition has been sent, or the transfer was aborted
+bool oled_i2c_transport::busy()
+{
+    if (!async_active)
+        return false;
+
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+
+    // After a NACK the TX FIFO is flushed and stops taking data, so the DMA channel never finishes
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+        return false;
+
+    if (dma_channel_is_busy(dma_chan))
+        return true;
+
+    // All data is in the FIFO, wait for the controller to finish shifting it out
+    return !(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS);
+}
+
+
+/// @brief Block until a background transfer has been sent or aborted. Returns immediately if none is in progress.
+void oled_i2c_transport::wait()
+{
+    if (!async_active)
+        return;
+
+    while (busy())
+        tight_loop_contents();
+
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+
+    // Drop the rest of an aborted frame. Reading clears the abort, which lets the TX FIFO take data again
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+    {
+        dma_channel_abort(dma_chan);
+        (void) hw->clr_tx_abrt;
+        async_failed = 1;
+    }
+
+    // Hand the bus back to the blocking I2C functions
+    hw->dma_cr = 0;
+    (void) hw->clr_stop_det;
+    async_active = 0;
+    bus_owner[i2c_hw_index(i2c)] = NULL;
+}
+
+
+/// @brief Check whether the last background transfer was aborted, e.g. because nothing acknowledged the address
+/// @return true if it was aborted, false if it was sent or is still being sent
+bool oled_i2c_transport::transfer_failed()
+{
+    if (busy())
+        return false;
+
+    wait();
+    return async_failed;
+}
+
+
+
+/// @brief Talk to a display over 4-wire SPI
+/// @param spi_instance SPI block the display is connected to. It must already be initialized, along with its SCK/TX pins.
+/// @param dc_pin GPIO connected to the display's D/C pin
+/// @param cs_pin GPIO connected to the display's CS pin
+oled_spi_transport::oled_spi_transport(spi_inst_t *spi_instance, uint8_t dc_pin, uint8_t cs_pin)
+{
+    spi = spi_instance;
+    dc_gpio = dc_pin;
+    cs_gpio = cs_pin;
+
+    // DMA resources are only claimed if write_data_async() is used
+    front_buffer = NULL;
+    front_buf_length = 0;
+    dma_chan = -1;
+    async_active = 0;
+
+    gpio_init(dc_gpio);
+    gpio_set_dir(dc_gpio, GPIO_OUT);
+    gpio_put(dc_gpio, 0);
+
+    gpio_init(cs_gpio);
+    gpio_set_dir(cs_gpio, GPIO_OUT);
+    gpio_put(cs_gpio, 1);    // deselect display
+}
+
+
+/// @brief Finish any background transfer and give back the DMA channel and front buffer
+oled_spi_transport::~oled_spi_transport()
+{
+    wait();
+
+    if (dma_chan >= 0)
+        dma_channel_unclaim(dma_chan);
+
+    free(front_buffer);
+}
+
+
+/// @brief Send a sequence of commands to the display controller
+/// @param cmds bytes to send
+/// @param length number of bytes in cmds
+void oled_spi_transport::write_cmd(const uint8_t *cmds, uint16_t length)
+{
+    // Don't interrupt a frame that is still being sent
+    wait();
+
+    gpio_put(dc_gpio, 0);   // D/C low => bytes are commands
+    gpio_put(cs_gpio, 0);
+    spi_write_blocking(spi, cmds, length);
+    gpio_put(cs_gpio, 1);
+}
+
+
+/// @brief Send data to be written to display RAM
+/// @param buf buf[0] is not used, data starts at buf[1]
+/// @param length number of data bytes
+void oled_spi_transport::write_data(uint8_t *buf, uint16_t length)
+{
+    // Don't interrupt a frame that is still being sent
+    wait();
+
+    gpio_put(dc_gpio, 1);   // D/C high => bytes are written to RAM
+    gpio_put(cs_gpio, 0);
+    spi_write_blocking(spi, buf + 1, length);
+    gpio_put(cs_gpio, 1);
+}
+
+
+/// @brief Copy rows of display data to the front buffer and send them by DMA
+/// @param data first byte of the first row
+/// @param width number of bytes in each row
+/// @param stride distance between the start of each row
+/// @param rows number of rows to send
+/// @param clear zero the source bytes as they are copied
+/// @return true, SPI always supports background transfers
+bool oled_spi_transport::write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear)
+{
+    // The front buffer can't be reused while the previous frame is still using it
+    wait();
+
+    // Claim DMA resources on first use
+    reserve_front_buffer((void **) &front_buffer, &front_buf_length, width * rows, sizeof(uint8_t));
+
+    if (dma_chan < 0)
+        dma_chan = dma_claim_unused_channel(true);
+
+    uint16_t count = oled_take_rows(front_buffer, data, width, stride, rows, clear);
+
+    gpio_put(dc_gpio, 1);   // D/C high => bytes are written to RAM
+    gpio_put(cs_gpio, 0);
+
+    dma_channel_config config = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, spi_get_dreq(spi, true));
+
+    dma_channel_configure(dma_chan, &config, &spi_get_hw(spi)->dr, front_buffer, count, true);
+    async_active = 1;
+
+    return true;
+}
+
+
+/// @brief Check whether a background transfer is still being sent
+/// @return true until the DMA transfer has completed and the last byte has left the shift register
+bool oled_spi_transport::busy()
+{
+    if (!async_active)
+        return false;
+
+    return dma_channel_is_busy(dma_chan) || spi_is_busy(spi);
+}
+
+
+/// @brief Block until a background transfer has been sent. Returns immediately if none is in progress.
+void oled_spi_transport::wait()
+{
+    if (!async_active)
+        return;
+
+    while (busy())
+        tight_loop_contents();
+
+    gpio_put(cs_gpio, 1);
+
+    // Nothing was reading the RX FIFO during the transfer, drain it and clear the overrun flag
+    while (spi_is_readable(spi))
+        (void) spi_get_hw(spi)->dr;
+
+    spi_get_hw(spi)->icr = SPI_SSPICR_RORIC_BITS;
+    async_active = 0;
+}
@@ -0,0 +1,180 @@
+/**
+ *  oled-transport.hpp
+ *  Bus interfaces used by pico_oled to talk to the display controller
+ */
+#ifndef _OLED_TRANSPORT_H_
+#define _OLED_TRANSPORT_H_
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include <string.h>
+
+
+/// @brief Interface between pico_oled and the bus the display is connected to.
+///        Implementations only move bytes, all controller logic stays in pico_oled.
+class oled_transport
+{
+    public:
+        /// @brief Transports can be deleted through this interface, e.g. by the pico_oled that created one
+        virtual ~oled_transport() {}
+
+        /// @brief Send a sequence of command bytes (and their arguments) to the controller
+        /// @param cmds bytes to send
+        /// @param length number of bytes in cmds
+        virtual void write_cmd(const uint8_t *cmds, uint16_t length) = 0;
+
+        /// @brief Send data to be written to display RAM
+        /// @param buf buf[0] is a header byte the transport may overwrite (e.g. with a control byte), data starts at buf[1]
+        /// @param length number of data bytes, not counting the header byte
+        virtual void write_data(uint8_t *buf, uint16_t length) = 0;
+
+        /// @brief Start sending rows of display RAM data without waiting for them to finish.
+        ///        The rows are copied before this returns, so the source may be drawn over straight away.
+        /// @param data first byte of the first row
+        /// @param width number of bytes in each row
+        /// @param stride distance between the start of each row
+        /// @param rows number of rows to send
+        /// @param clear zero the source bytes as they are copied
+        /// @return false if this transport can't send in the background. Nothing is sent or cleared in that case.
+        virtual bool write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear=false) { return false; }
+
+        /// @brief Check whether data started by write_data_async() is still being sent
+        virtual bool busy() { return false; }
+
+        /// @brief Block until data started by write_data_async() has been sent
+        virtual void wait() {}
+
+        /// @brief Check whether the last data started by write_data_async() was dropped, e.g. because the display
+        ///        didn't acknowledge it. Only known once busy() returns false.
+        virtual bool transfer_failed() { return false; }
+};
+
+
+/// @brief Copy rows of display data to an I2C front buffer of data/command words, optionally zeroing each source
+///        byte as it is read. The words can't be filled with memcpy(), so the clear rides along in the same loop.
+/// @param dest front buffer, one word per byte
+/// @param data first byte of the first row
+/// @param width number of bytes in each row
+/// @param stride distance between the start of each row
+/// @param rows number of rows to copy
+/// @param clear zero the source bytes that were copied
+/// @return number of words written to dest
+static inline uint16_t oled_take_rows(uint16_t *dest, uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear)
+{
+    uint16_t *start = dest;
+
+    for (uint16_t row = 0; row < rows; row++)
+    {
+        uint8_t *src = data + row*stride;
+
+        if (clear)
+        {
+            for (uint16_t column = 0; column < width; column++)
+            {
+                dest[column] = src[column];
+                src[column] = 0;
+            }
+        }
+        else
+        {
+            for (uint16_t column = 0; column < width; column++)
+                dest[column] = src[column];
+        }
+
+        dest += width;
+    }
+
+    return dest - start;
+}
+
+
+/// @brief Copy rows of display data to a byte front buffer, optionally zeroing each row of the source straight
+///        after it is copied. memcpy() and memset() move whole words, which a byte loop doing both can't.
+/// @param dest front buffer
+/// @param data first byte of the first row
+/// @param width number of bytes in each row
+/// @param stride distance between the start of each row
+/// @param rows number of rows to copy
+/// @param clear zero the source rows that were copied
+/// @return number of bytes written to dest
+static inline uint16_t oled_take_rows(uint8_t *dest, uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear)
+{
+    // Full width rows are contiguous, so they are taken as one block
+    if (width == stride)
+    {
+        width *= rows;
+        stride *= rows;
+        rows = 1;
+    }
+
+    for (uint16_t row = 0; row < rows; row++)
+    {
+        uint8_t *src = data + row*stride;
+
+        memcpy(dest + row*width, src, width);
+
+        if (clear)
+            memset(src, 0, width);
+    }
+
+    return width * rows;
+}
+
+
+/// @brief I2C connection to the display. Background transfers use DMA.
+class oled_i2c_transport : public oled_transport
+{
+    private:
+        i2c_inst_t *i2c;
+        uint8_t i2c_addr;
+
+        // Frame being sent in the background, as I2C data/command words so DMA can feed the TX FIFO directly
+        uint16_t *front_buffer;
+        uint16_t front_buf_length;
+        int dma_chan;
+        uint8_t async_active;
+        uint8_t async_failed;
+
+        // Transport with a background transfer in progress on each I2C block, so displays sharing a bus take turns
+        static oled_i2c_transport *bus_owner[NUM_I2CS];
+        void claim_bus();
+
+    public:
+        oled_i2c_transport(i2c_inst_t *i2c_instance, uint8_t i2c_address);
+        ~oled_i2c_transport();
+        void write_cmd(const uint8_t *cmds, uint16_t length);
+        void write_data(uint8_t *buf, uint16_t length);
+        bool write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear=false);
+        bool busy();
+        void wait();
+        bool transfer_failed();
+};
+
+
+/// @brief 4-wire SPI connection to the display. The data/command and chip select pins are driven as GPIOs,
+///        the SPI instance and its clock/data pins must be set up by the application. Background transfers use DMA.
+class oled_spi_transport : public oled_transport
+{
+    private:
+        spi_inst_t *spi;
+        uint8_t dc_gpio;
+        uint8_t cs_gpio;
+
+        // Frame being sent in the background
+        uint8_t *front_buffer;
+        uint16_t front_buf_length;
+        int dma_chan;
+        uint8_t async_active;
+
+    public:
+        oled_spi_transport(spi_inst_t *spi_instance, uint8_t dc_pin, uint8_t cs_pin);
+        ~oled_spi_transport();
+        void write_cmd(const uint8_t *cmds, uint16_t length);
+        void write_data(uint8_t *buf, uint16_t length);
+        bool write_data_async(uint8_t *data, uint16_t width, uint16_t stride, uint16_t rows, bool clear=false);
+        bool busy();
+        void wait();
+};
+
+#endif
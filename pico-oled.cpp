@@ -1,41 +1,96 @@
 #include "pico-oled.hpp"
+#include "oled-transport.hpp"
 #include "hardware/i2c.h"
 #include "pico/stdlib.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "pico/float.h"
 #include "gfx_font.h"
+#include "gfx-profile.hpp"
 
 
-//#define GFX_DEBUG
+//#define OLED_TELEMETRY    // Count bus traffic and render times, see get_telemetry()
 
-#define PRINT_NUM_BUFFER 30     // Length of temporary buffers for printing numbers
+// Cost of display updates in byte times, used to decide how to split up the changes found by OLED_UPDATE_SHADOW.
+// Each window costs a command transaction to set the column/page address, and each row of data its own
+// start/address/control bytes, so unchanged bytes are sent when that is cheaper than starting a new window
+#define OLED_WINDOW_COST 10     // Command transaction setting the column and page address
+#define OLED_ROW_COST 3         // Start, address and control byte of each data row
 
+#ifdef OLED_TELEMETRY
+    #define TELEMETRY_COUNT(cmd, data, transfers) count_transfer(cmd, data, transfers)
+#else
+    #define TELEMETRY_COUNT(cmd, data, transfers)
+#endif
 
-pico_oled::pico_oled(OLED_type controller_ic, uint8_t i2c_address, uint8_t screen_width, uint8_t screen_height, uint8_t reset_gpio)
+
+/// @brief Set telemetry counters to their cleared state
+static void clear_telemetry(oled_telemetry *counters)
 {
-    // Init private variables
-    i2c_addr = i2c_address;
-    oled_width = screen_width;
-    oled_height = screen_height;
+    counters->bytes_sent = 0;
+    counters->transactions = 0;
+    counters->cmd_bytes = 0;
+    counters->data_bytes = 0;
+    counters->renders = 0;
+    counters->render_time_min_us = UINT32_MAX;
+    counters->render_time_avg_us = 0;
+    counters->render_time_max_us = 0;
+    counters->render_time_total_us = 0;
+}
+
+
+/// @brief Allocate a buffer for the entire screen + a header byte for the transport (e.g. the I2C control byte)
+static uint8_t *alloc_screen_buffer(uint8_t screen_width, uint8_t screen_height)
+{
+    uint8_t *buffer = (uint8_t*) malloc((screen_height / OLED_PAGE_HEIGHT) * screen_width + 1);
+
+    if (buffer == NULL)
+        panic("pico_oled: no memory for screen buffer");
+
+    return buffer;
+}
+
+
+/// @brief Create a display that is connected through the given transport
+/// @param controller_ic display controller type
+/// @param bus transport used to talk to the display, e.g. an oled_i2c_transport or oled_spi_transport
+/// @param screen_width width of the display in pixels
+/// @param screen_height height of the display in pixels
+/// @param reset_gpio GPIO connected to the display's reset pin, or an invalid pin number (>29) if not used
+pico_oled::pico_oled(OLED_type controller_ic, oled_transport *bus, uint8_t screen_width, uint8_t screen_height, uint8_t reset_gpio)
+    : pico_oled(controller_ic, bus, screen_width, screen_height, alloc_screen_buffer(screen_width, screen_height), reset_gpio)
+{
+    owned_buffer = screen_buffer;
+}
 
-    // Allocate a buffer for the entire screen + control byte
-    screen_buf_length = (oled_height / OLED_PAGE_HEIGHT) * oled_width + 1;
-    screen_buffer = (uint8_t*) malloc(screen_buf_length);
 
-    // Control byte, Co = 0, D/C = 1 => the driver expects data to be written to RAM
-    screen_buffer[0] = 0x40;  
+/// @brief Create a display that draws into a buffer supplied by the caller, see pico_oled_static
+/// @param buffer (screen_height / 8) * screen_width + 1 bytes, which must outlive the display
+pico_oled::pico_oled(OLED_type controller_ic, oled_transport *bus, uint8_t screen_width, uint8_t screen_height, uint8_t *buffer, uint8_t reset_gpio)
+    : oled_canvas(buffer, screen_width, screen_height)
+{
+    // Init private variables
+    transport = bus;
+    owned_transport = NULL;
+    owned_buffer = NULL;
 
-    // Indicate that font has not been set yet
-    font_set = 0;
+    // Drawing calls decide what gets sent by default
+    update_mode = OLED_UPDATE_DIRTY;
+    shadow_buffer = NULL;
+    page_checksums = NULL;
 
-    // Set cursor default position to something reasonable
-    cursor_x = 0;
-    cursor_y = 10;
+    // Buffer contents are unknown, so the whole screen needs to be sent on the first render
+    invalidate();
 
-    // Set the draw pixel function to the default
-    draw_pixel_fn = &pico_oled::draw_pixel;
-    pixel_counter = 0;
+    // Each core's counters start cleared, with no clear pending
+    for (uint core = 0; core < NUM_CORES; core++)
+    {
+        clear_telemetry(&telemetry[core].counters);
+        telemetry[core].update_seq.store(0);
+        telemetry[core].reset_seq.store(0);
+        telemetry[core].cleared_seq.store(0);
+    }
 
     // Store the controller ID
     oled_controller = controller_ic;
@@ -53,16 +108,65 @@ pico_oled::pico_oled(OLED_type controller_ic, uint8_t i2c_address, uint8_t scree
 }
 
 
+/// @brief Create a display connected to the given I2C instance. The display owns the I2C transport it creates
+///        and deletes it when the display is destroyed.
+/// @param controller_ic display controller type
+/// @param i2c I2C instance the display is connected to (i2c0 or i2c1)
+/// @param i2c_address 7-bit I2C address of the display
+/// @param screen_width width of the display in pixels
+/// @param screen_height height of the display in pixels
+/// @param reset_gpio GPIO connected to the display's reset pin, or an invalid pin number (>29) if not used
+pico_oled::pico_oled(OLED_type controller_ic, i2c_inst_t *i2c, uint8_t i2c_address, uint8_t screen_width, uint8_t screen_height, uint8_t reset_gpio)
+    : pico_oled(controller_ic, new oled_i2c_transport(i2c, i2c_address), screen_width, screen_height, reset_gpio)
+{
+    owned_transport = transport;
+}
+
+
+/// @brief Create a display connected to the default I2C instance
+/// @param controller_ic display controller type
+/// @param i2c_address 7-bit I2C address of the display
+/// @param screen_width width of the display in pixels
+/// @param screen_height height of the display in pixels
+/// @param reset_gpio GPIO connected to the display's reset pin, or an invalid pin number (>29) if not used
+pico_oled::pico_oled(OLED_type controller_ic, uint8_t i2c_address, uint8_t screen_width, uint8_t screen_height, uint8_t reset_gpio)
+    : pico_oled(controller_ic, i2c_default, i2c_address, screen_width, screen_height, reset_gpio)
+{
+}
+
+
+/// @brief Free what the display allocated itself: its screen buffer, the buffer or checksums of
+///        OLED_UPDATE_SHADOW/OLED_UPDATE_CHECKSUM and its I2C transport. A transport or buffer passed to the
+///        constructor stays with the caller.
+pico_oled::~pico_oled()
+{
+    // The transport may still be sending from its front buffer, which it frees itself
+    delete owned_transport;
+
+    free(owned_buffer);
+    free(shadow_buffer);
+    free(page_checksums);
+}
+
+
 /// @brief Send a command to the display controller
 /// @param cmd byte to send
 void pico_oled::oled_send_cmd(uint8_t cmd)
 {
-    // I2C write process expects a control byte followed by data
-    // this "data" can be a command or data to follow up a command
+    transport->write_cmd(&cmd, 1);
+
+    TELEMETRY_COUNT(1, 0, 1);
+}
+
+
+/// @brief Send a sequence of commands (and their arguments) to the display controller in a single transaction
+/// @param cmds bytes to send
+/// @param length number of bytes in cmds
+void pico_oled::oled_send_cmd_list(const uint8_t *cmds, uint8_t length)
+{
+    transport->write_cmd(cmds, length);
 
-    // Co = 1, D/C = 0 => the driver expects a command
-    uint8_t buf[2] = {0x80, cmd};
-    i2c_write_blocking(i2c_default, (i2c_addr & OLED_WRITE_MODE), buf, 2, false);   
+    TELEMETRY_COUNT(length, 0, 1);
 }
 
 
@@ -93,56 +197,61 @@ void pico_oled::oled_init()
 /// @brief Set configuration registers for ssd1306 OLED controllers
 void pico_oled::oled_ssd1306_init()
 {
-    oled_send_cmd(OLED_SET_DISP | 0x00); // set display off
+    const uint8_t init_cmds[] = 
+    {
+        OLED_SET_DISP | 0x00, // set display off
+
+        /* memory mapping */
+        OLED_SET_MEM_ADDR, // set memory address mode
+        0x00, // horizontal addressing mode
 
-    /* memory mapping */
-    oled_send_cmd(OLED_SET_MEM_ADDR); // set memory address mode
-    oled_send_cmd(0x00); // horizontal addressing mode
+        /* resolution and layout */
+        OLED_SET_DISP_START_LINE, // set display start line to 0
 
-    /* resolution and layout */
-    oled_send_cmd(OLED_SET_DISP_START_LINE); // set display start line to 0
+        OLED_SET_SEG_REMAP | 0x01, // set segment re-map
+        // column address 127 is mapped to SEG0
 
-    oled_send_cmd(OLED_SET_SEG_REMAP | 0x01); // set segment re-map
-    // column address 127 is mapped to SEG0
+        OLED_SET_MUX_RATIO, // set multiplex ratio
+        (uint8_t) (oled_height - 1), // set OLED vertical resolution
 
-    oled_send_cmd(OLED_SET_MUX_RATIO); // set multiplex ratio
-    oled_send_cmd(oled_height - 1); // set OLED vertical resolution
+        OLED_SET_COM_OUT_DIR | 0x08, // set COM (common) output scan direction
+        // scan from bottom up, COM[N-1] to COM0
 
-    oled_send_cmd(OLED_SET_COM_OUT_DIR | 0x08); // set COM (common) output scan direction
-    // scan from bottom up, COM[N-1] to COM0
+        OLED_SET_DISP_OFFSET, // set display offset
+        0x00, // no offset
 
-    oled_send_cmd(OLED_SET_DISP_OFFSET); // set display offset
-    oled_send_cmd(0x00); // no offset
+        OLED_SET_COM_PIN_CFG, // set COM (common) pins hardware configuration
+        0x12, // 0x12 for alternative COM pin configuration
 
-    oled_send_cmd(OLED_SET_COM_PIN_CFG); // set COM (common) pins hardware configuration
-    oled_send_cmd(0x12); // 0x12 for alternative COM pin configuration
+        /* timing and driving scheme */
+        OLED_SET_DISP_CLK_DIV, // set display clock divide ratio 
+        0x80, // div ratio of 1, standard freq
 
-    /* timing and driving scheme */
-    oled_send_cmd(OLED_SET_DISP_CLK_DIV); // set display clock divide ratio 
-    oled_send_cmd(0x80); // div ratio of 1, standard freq
+        OLED_SET_PRECHARGE, // set pre-charge period
+        0xF1, // Vcc internally generated on our board
 
-    oled_send_cmd(OLED_SET_PRECHARGE); // set pre-charge period
-    oled_send_cmd(0xF1); // Vcc internally generated on our board
+        OLED_SET_VCOM_DESEL, // set VCOMH deselect level
+        0x30, // 0.83xVcc  
 
-    oled_send_cmd(OLED_SET_VCOM_DESEL); // set VCOMH deselect level
-    oled_send_cmd(0x30); // 0.83xVcc  
+        /* display */
+        OLED_SET_CONTRAST, // set brightness
+        0x0F, // 0 to 255
 
-    /* display */
-    set_brightness(0x0F); // 0 to 255
+        OLED_SET_ENTIRE_ON, // set entire display on to follow RAM content
 
-    oled_send_cmd(OLED_SET_ENTIRE_ON); // set entire display on to follow RAM content
+        OLED_SET_NORM_INV, // set normal (not inverted) display
 
-    oled_send_cmd(OLED_SET_NORM_INV); // set normal (not inverted) display
+        OLED_SET_CHARGE_PUMP, // set charge pump
+        0x14, // Vcc internally generated on our board
 
-    oled_send_cmd(OLED_SET_CHARGE_PUMP); // set charge pump
-    oled_send_cmd(0x14); // Vcc internally generated on our board
+        OLED_SET_SCROLL | 0x00, // deactivate horizontal scrolling if set
+        // this is necessary as memory writes will corrupt if scrolling was enabled
+    };
 
-    oled_send_cmd(OLED_SET_SCROLL | 0x00); // deactivate horizontal scrolling if set
-    // this is necessary as memory writes will corrupt if scrolling was enabled
+    oled_send_cmd_list(init_cmds, sizeof(init_cmds));
 
     // Clear the display
-    fill(0);
-    render();    
+    clear_display();
 
     oled_send_cmd(OLED_SET_DISP | 0x01); // turn display on
 }
@@ -151,921 +260,1005 @@ void pico_oled::oled_ssd1306_init()
 /// @brief Set configuration registers for ssd1309 OLED controllers
 void pico_oled::oled_ssd1309_init()
 {
-    oled_send_cmd(OLED_SET_DISP | 0x00); // set display off
+    const uint8_t init_cmds[] = 
+    {
+        OLED_SET_DISP | 0x00, // set display off
+
+        /* memory mapping */
+        OLED_SET_MEM_ADDR, // set memory address mode
+        0x00, // horizontal addressing mode 
 
-    /* memory mapping */
-    oled_send_cmd(OLED_SET_MEM_ADDR); // set memory address mode
-    oled_send_cmd(0x00); // horizontal addressing mode 
+        /* resolution and layout */
+        OLED_SET_DISP_START_LINE, // set display start line to 0
 
-    /* resolution and layout */
-    oled_send_cmd(OLED_SET_DISP_START_LINE); // set display start line to 0
+        OLED_SET_SEG_REMAP | 0x01, // set segment re-map ssd1306
+        // column address 127 is mapped to SEG0
 
-    oled_send_cmd(OLED_SET_SEG_REMAP | 0x01); // set segment re-map ssd1306
-    // column address 127 is mapped to SEG0
+        OLED_SET_COM_OUT_DIR | 0x08, // set COM (common) output scan direction
+        // scan from bottom up, COM[N-1] to COM0
 
-    oled_send_cmd(OLED_SET_COM_OUT_DIR | 0x08); // set COM (common) output scan direction
-    // scan from bottom up, COM[N-1] to COM0
+        OLED_SET_MUX_RATIO, // set multiplex ratio
+        (uint8_t) (oled_height - 1), // set OLED vertical resolution
 
-    oled_send_cmd(OLED_SET_MUX_RATIO); // set multiplex ratio
-    oled_send_cmd(oled_height - 1); // set OLED vertical resolution
+        OLED_SET_DISP_OFFSET, // set display offset
+        0x00, // no offset
 
-    oled_send_cmd(OLED_SET_DISP_OFFSET); // set display offset
-    oled_send_cmd(0x00); // no offset
+        OLED_SET_COM_PIN_CFG, // set COM (common) pins hardware configuration
+        0x12, // 0x12 for alternative COM pin configuration
 
-    oled_send_cmd(OLED_SET_COM_PIN_CFG); // set COM (common) pins hardware configuration
-    oled_send_cmd(0x12); // 0x12 for alternative COM pin configuration
+        /* timing and driving scheme */
+        OLED_SET_DISP_CLK_DIV, // set display clock divide ratio 
+        0xa0, // div ratio of 1, osc freq 0xA
+        // 0x70, // div ratio of 1, default freq
 
-    /* timing and driving scheme */
-    oled_send_cmd(OLED_SET_DISP_CLK_DIV); // set display clock divide ratio 
-    oled_send_cmd(0xa0); // div ratio of 1, osc freq 0xA
-    // oled_send_cmd(0x70); // div ratio of 1, default freq
+        OLED_SET_PRECHARGE, // set pre-charge period
+        //0xF1, // ssd1309
+        0xd3, // ssd1309
 
-    oled_send_cmd(OLED_SET_PRECHARGE); // set pre-charge period
-    //oled_send_cmd(0xF1); // ssd1309
-    oled_send_cmd(0xd3); // ssd1309
+        OLED_SET_VCOM_DESEL, // set VCOMH deselect level
+        0x30,  // 0.83xVcc 
 
-    oled_send_cmd(OLED_SET_VCOM_DESEL); // set VCOMH deselect level
-    oled_send_cmd(0x30);  // 0.83xVcc 
+        /* display */
+        OLED_SET_CONTRAST, // set brightness
+        0x0F, // 0 to 255
 
-    /* display */
-    set_brightness(0x0F); // 0 to 255
+        OLED_SET_ENTIRE_ON, // set entire display on to follow RAM content
 
-    oled_send_cmd(OLED_SET_ENTIRE_ON); // set entire display on to follow RAM content
+        OLED_SET_NORM_INV, // set normal (not inverted) display
 
-    oled_send_cmd(OLED_SET_NORM_INV); // set normal (not inverted) display
+        OLED_SET_CHARGE_PUMP, // set charge pump
+        0x10,  // Disabled, external charge pump for ssd1309
 
-    oled_send_cmd(OLED_SET_CHARGE_PUMP); // set charge pump
-    oled_send_cmd(0x10);  // Disabled, external charge pump for ssd1309
+        OLED_SET_SCROLL | 0x00, // deactivate horizontal scrolling if set
+        // this is necessary as memory writes will corrupt if scrolling was enabled
+    };
 
-    oled_send_cmd(OLED_SET_SCROLL | 0x00); // deactivate horizontal scrolling if set
-    // this is necessary as memory writes will corrupt if scrolling was enabled
+    oled_send_cmd_list(init_cmds, sizeof(init_cmds));
 
     // Clear the display
-    fill(0);
-    render();    
+    clear_display();
 
     oled_send_cmd(OLED_SET_DISP | 0x01); // turn display on    
 }
 
 
+/// @brief Blank the screen buffer and display RAM
+void pico_oled::clear_display()
+{
+    fill(0);
+
+    if (holds_screen())
+    {
+        render();
+        return;
+    }
+
+    // Send the blank strip to every page of the display
+    uint8_t pages = oled_height / OLED_PAGE_HEIGHT;
+    uint8_t first_page = buffer_page1;
+    uint8_t last_page = buffer_page2;
+    uint8_t strip_pages = last_page - first_page + 1;
+
+    for (uint8_t page = 0; page < pages; page += strip_pages)
+    {
+        set_buffer_pages(page, (page + strip_pages <= pages) ? page + strip_pages - 1 : pages - 1);
+        send_strip(buffer_page1, buffer_page2);
+    }
+
+    set_buffer_pages(first_page, last_page);
+    clear_dirty();
+}
+
+
 /// @brief Set the contrast (brightness) of the OLED. 
 /// @warning high brightness levels can cause burn-in and reduce the lifespan of the display
 /// @param brightness 0 to 255, where 0 is the lowest brightness possible.
 void pico_oled::set_brightness(uint8_t brightness)
 {
-    oled_send_cmd(OLED_SET_CONTRAST); 
-    oled_send_cmd(brightness);  
+    uint8_t cmds[] = {OLED_SET_CONTRAST, brightness};
+    oled_send_cmd_list(cmds, sizeof(cmds));
 }
 
 
-/// @brief Fill entire display with the specified byte
-/// @param fill value to set each column of 8 pixels to
-void pico_oled::fill(uint8_t fill)
+/// @brief Mark the entire screen as changed so the next render() sends the whole buffer.
+///        Use this if the display RAM may no longer match the screen buffer (e.g. after a display reset)
+void pico_oled::invalidate()
 {
-    // Skip first byte since it's a control byte
-    for (int i=1; i < screen_buf_length; i++)
-    {
-        screen_buffer[i] = fill;
-    }
+    dirty_x1 = 0;
+    dirty_x2 = oled_width - 1;
+    dirty_page1 = 0;
+    dirty_page2 = oled_height / OLED_PAGE_HEIGHT - 1;
+
+    // Display RAM can't be compared against either
+    reference_valid = 0;
 }
 
 
-/// @brief Write the entire screen buffer to the OLED 
-void pico_oled::render()
+/// @brief Choose how render() decides which parts of the screen buffer to send
+/// @param mode OLED_UPDATE_DIRTY (default) tracks the area touched by drawing calls. 
+///             OLED_UPDATE_SHADOW keeps a copy of display RAM (one extra screen buffer of RAM) and sends only what differs,
+///             using a cost model to decide when it is cheaper to resend unchanged bytes than to start a new window.
+///             OLED_UPDATE_CHECKSUM keeps a checksum of each page (4 bytes per page) and sends only pages that differ.
+void pico_oled::set_update_mode(OLED_update_mode mode)
 {
-    // ////// debug stack check
-    // uint8_t prev_x = cursor_x;
-    // uint8_t prev_y = cursor_y;
+    uint8_t pages = oled_height / OLED_PAGE_HEIGHT;
 
-    // set_cursor(0, oled_height - font.line_height);
-    // print_num("%8X", (uint32_t) &prev_y);
+    if (mode == OLED_UPDATE_SHADOW && shadow_buffer == NULL)
+    {
+        shadow_buffer = (uint8_t*) malloc(pages * oled_width);
 
-    // set_cursor(prev_x, prev_y);
+        if (shadow_buffer == NULL)
+            panic("pico_oled: no memory for shadow buffer");
+    }
 
+    if (mode == OLED_UPDATE_CHECKSUM && page_checksums == NULL)
+    {
+        page_checksums = (uint32_t*) malloc(pages * sizeof(uint32_t));
 
-    // Set the start/end coordinates for drawing the entire screen
-    oled_send_cmd(OLED_SET_COL_ADDR);
-    oled_send_cmd(0);                       // Start column
-    oled_send_cmd(oled_width - 1);    // End column
+        if (page_checksums == NULL)
+            panic("pico_oled: no memory for page checksums");
+    }
 
-    oled_send_cmd(OLED_SET_PAGE_ADDR);
-    oled_send_cmd(0);                                           // Start page
-    oled_send_cmd(oled_height / OLED_PAGE_HEIGHT - 1);    // End page
+    update_mode = mode;
 
-    i2c_write_blocking(i2c_default, (i2c_addr & OLED_WRITE_MODE), screen_buffer, screen_buf_length, false);
+    // Nothing is known about display RAM in the new mode yet
+    reference_valid = 0;
 }
 
 
-/// @brief Tell the display whether to turn on all pixels or follow RAM contents
-/// @param disp_on nonzero to turn on all screen pixels, zero to display RAM contents
-void pico_oled::all_on(uint8_t disp_on)
+/// @brief FNV-1a hash of one page of the screen buffer
+/// @param row first byte of the page
+/// @param width number of bytes in the page
+/// @return checksum of the page
+static uint32_t page_checksum(const uint8_t *row, uint8_t width)
 {
-    if (disp_on)
-        oled_send_cmd(0xA5);
-    else
-        oled_send_cmd(0xA4);
+    uint32_t hash = 2166136261u;
+
+    for (uint8_t column = 0; column < width; column++)
+    {
+        hash ^= row[column];
+        hash *= 16777619u;
+    }
+
+    return hash;
 }
 
 
-/// @brief Copy a block from the source src_bitmap to the screen buffer
-/// @param src_bitmap bitmap data
-/// @param src_width width of the entire source bitmap
-/// @param src_x source x coordinate to copy from
-/// @param src_y source y coordinate to copy from
-/// @param blit_width width of region to copy
-/// @param blit_height height of region to copy
-/// @param screen_x screen x coordinate to draw at
-/// @param screen_y screen y coordinate to draw at
-void pico_oled::blit_screen(const uint8_t *src_bitmap, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height, uint8_t screen_x, uint8_t screen_y)
+/// @brief Record that a region of the screen buffer is now in display RAM
+/// @param x1 first column
+/// @param page1 first page
+/// @param x2 last column
+/// @param page2 last page
+void pico_oled::update_reference(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2)
 {
-    uint8_t dest_start_page = screen_y / OLED_PAGE_HEIGHT;
-    uint8_t dest_page_offset = screen_y - dest_start_page * OLED_PAGE_HEIGHT;
-    uint8_t dest_end_page = (screen_y + blit_height - 1) / OLED_PAGE_HEIGHT;
-    uint8_t dest_end_col = screen_x + blit_width - 1;
-    uint8_t src_start_page = src_y / OLED_PAGE_HEIGHT;
-    uint8_t src_page_offset = src_y - src_start_page * OLED_PAGE_HEIGHT;
-    //uint8_t src_end_page = (src_y + blit_height - 1) / OLED_PAGE_HEIGHT; 
-    int8_t offset_delta;
-
-#ifdef GFX_DEBUG
-    printf("\n\nBeginning blit of bitmap of %dx%d, from source pos %d,%d to screen position %d,%d\n", blit_width, blit_height, src_x, src_y, screen_x, screen_y);
-#endif
-    // Make sure drawing happens within screen bounds
-    if (dest_end_page > (oled_height / OLED_PAGE_HEIGHT))  
+    for (uint8_t page = page1; page <= page2; page++)
     {
-        dest_end_page = (oled_height / OLED_PAGE_HEIGHT);
-    }
+        const uint8_t *row = &screen_buffer[1 + page*oled_width];
 
-    if (dest_end_col > oled_width - 1)
-    {
-        dest_end_col = oled_width - 1;
+        if (update_mode == OLED_UPDATE_SHADOW)
+        {
+            for (uint8_t column = x1; column <= x2; column++)
+                shadow_buffer[column + page*oled_width] = row[column];
+        }
+        else if (update_mode == OLED_UPDATE_CHECKSUM)
+        {
+            page_checksums[page] = page_checksum(row, oled_width);
+        }
     }
+}
 
-    // Make sure source data is within source bitmap bounds
 
+/// @brief Send a region of the screen buffer and record that it is now in display RAM
+/// @param x1 first column
+/// @param page1 first page
+/// @param x2 last column
+/// @param page2 last page
+void pico_oled::send_and_update_reference(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2)
+{
+    send_window(screen_buffer, x1, page1, x2, page2);
+    update_reference(x1, page1, x2, page2);
+}
 
-    offset_delta = dest_page_offset - src_page_offset;
 
-    uint8_t screen_line = screen_y;
-    uint8_t src_line = src_y;
-    uint8_t end_line = src_y + blit_height - 1;
-    uint8_t src_page, screen_page, lines_available, lines_drawable, u_mask, l_mask;
-    uint8_t exit_flag = 0;
-    uint8_t last_src_page = 255;    // Init to invalid number so it's different to src_page by default
-    uint8_t last_screen_page = 255;
-    int8_t mask_amt;
+/// @brief Find the smallest window holding every difference between the screen buffer and display RAM
+/// @param x1 set to the first changed column
+/// @param page1 set to the first changed page
+/// @param x2 set to the last changed column
+/// @param page2 set to the last changed page
+/// @return false if nothing changed
+bool pico_oled::find_changed_window(uint8_t *x1, uint8_t *page1, uint8_t *x2, uint8_t *page2)
+{
+    uint8_t pages = oled_height / OLED_PAGE_HEIGHT;
 
-#ifdef GFX_DEBUG
-    printf("end_line: %d, offset: %d\n", end_line, offset_delta);
-#endif    
+    *x1 = 0xFF;
+    *x2 = 0;
+    *page1 = 0xFF;
+    *page2 = 0;
 
-    while (!exit_flag)
+    if (!reference_valid)
     {
-        // Calc. how much data can be sourced from bmp page
-        src_page = src_line / OLED_PAGE_HEIGHT;
-        lines_available =  OLED_PAGE_HEIGHT - (src_line - src_page * OLED_PAGE_HEIGHT);
-
-        // Calc. how much of that data can be drawn starting at the screen line
-        screen_page = screen_line / OLED_PAGE_HEIGHT;
-        lines_drawable = OLED_PAGE_HEIGHT - (screen_line - screen_page * OLED_PAGE_HEIGHT);  
+        *x1 = 0;
+        *x2 = oled_width - 1;
+        *page1 = 0;
+        *page2 = pages - 1;
+        reference_valid = 1;
+        return true;
+    }
 
-        // No masking by default
-        u_mask = 0;
-        l_mask = 0;
+    for (uint8_t page = 0; page < pages; page++)
+    {
+        const uint8_t *row = &screen_buffer[1 + page*oled_width];
 
-        // Limit available lines at the end of the image
-        if (src_line + lines_available > end_line)
+        if (update_mode == OLED_UPDATE_SHADOW)
         {
-            lines_available = end_line - src_line + 1;
-            u_mask = OLED_PAGE_HEIGHT - lines_available; // Mask off unwanted upper bits
-            
-        }
+            const uint8_t *shadow_row = &shadow_buffer[page*oled_width];
 
-        // Limit lines at the start of the image
-        if (src_line == src_y)
-        {
-            l_mask = src_page_offset; // Mask off unwanted lower bits
+            for (uint8_t column = 0; column < oled_width; column++)
+            {
+                if (row[column] != shadow_row[column])
+                {
+                    if (column < *x1) *x1 = column;
+                    if (column > *x2) *x2 = column;
+                    if (page < *page1) *page1 = page;
+                    *page2 = page;
+                }
+            }
         }
-        
-        // Use available lines or drawable lines, whichever is smaller
-        if (lines_drawable > lines_available)
+        else if (page_checksum(row, oled_width) != page_checksums[page])
         {
-            lines_drawable = lines_available;
+            *x1 = 0;
+            *x2 = oled_width - 1;
+            if (page < *page1) *page1 = page;
+            *page2 = page;
         }
+    }
 
-        // If there's no offset, draw a whole page  //// is this necessary?
-        if  (lines_drawable == 0)
-            lines_drawable = OLED_PAGE_HEIGHT;
-
-#ifdef GFX_DEBUG
-        // // DEBUG stuff
-        // render();
-        // sleep_ms(100);
-        printf("screen pg:%d line:%d, src pg:%d line:%d, drawable:%d, available:%d, u_mask:%d, l_mask:%d\n", screen_page, screen_line, src_page, src_line, lines_drawable, lines_available, u_mask, l_mask);
-        // //printf("last_src_page: %d, src_page %d\n", last_src_page, src_page);
-        // sleep_ms(1000);
-        // u_mask = 0;
-        // l_mask = 0;
-#endif        
-        
-        for (uint8_t column = screen_x; column <= dest_end_col; column++)
-        {
-            uint8_t source_data = src_bitmap[(column + src_x - screen_x) + (src_page)*src_width];   
+    return *x1 <= *x2;
+}
 
-            //source_data &= 0xFF >> u_mask;   // Mask off upper bits
-            //source_data &= 0xFF << l_mask;   // Mask off lower bits            
 
-            // >> = shift to higher screen position
-            // << = shift to lower screen position
+/// @brief Send only the bytes that differ from display RAM, grouping them into windows with the cost model
+/// @return false if nothing had changed, so nothing was sent
+bool pico_oled::render_shadow_diff()
+{
+    uint8_t pages = oled_height / OLED_PAGE_HEIGHT;
+    bool sent = false;
 
-            // Draw to a screen page
-            if (offset_delta >= 0)
-            {
-                // Shift source data by offset_delta so it ends up in the right position
-                // Shift is different when drawing from the same page a second time
-                if (last_src_page == src_page)   
-                {
-                    // Mask off bottom - offset when necessary
-                    mask_amt = u_mask - (OLED_PAGE_HEIGHT - offset_delta);
-                    if (mask_amt > 0)
-                        source_data &= 0xFF >> mask_amt;  
+    // Display RAM contents are unknown, so everything has to be sent once
+    if (!reference_valid)
+    {
+        send_and_update_reference(0, 0, oled_width - 1, pages - 1);
+        reference_valid = 1;
+        return true;
+    }
 
-                    // bottom pixels being shifted up
-                    screen_buffer[1 + column + screen_page*oled_width] |= source_data >> (OLED_PAGE_HEIGHT - offset_delta);
-                }
-                else
-                {
-                    // Mask off top and bottom
-                    source_data &= 0xFF << l_mask; 
-                    source_data &= 0xFF >> u_mask;
+    // Window waiting to be sent, kept open in case the next page's changes can share it. Empty when win_x1 > win_x2
+    uint8_t win_x1 = 0xFF, win_x2 = 0, win_page1 = 0, win_page2 = 0;
+
+    for (uint8_t page = 0; page < pages; page++)
+    {
+        const uint8_t *row = &screen_buffer[1 + page*oled_width];
+        const uint8_t *shadow_row = &shadow_buffer[page*oled_width];
+        int16_t run_x1 = -1;
+        int16_t run_x2 = -1;
+
+        // Go one column past the end to close the last run
+        for (int16_t column = 0; column <= oled_width; column++)
+        {
+            uint8_t changed = (column < oled_width) && (row[column] != shadow_row[column]);
 
-                    // top pixels being shifted down
-                    screen_buffer[1 + column + screen_page*oled_width] |= source_data << offset_delta;
+            if (changed)
+            {
+                // Extend the current run over the unchanged gap if resending it is cheaper than a new window
+                if (run_x1 >= 0 && (column - run_x2 - 1) <= OLED_WINDOW_COST + OLED_ROW_COST)
+                {
+                    run_x2 = column;
+                    continue;
                 }
             }
-            else
+
+            if (run_x1 >= 0 && (changed || column == oled_width))
             {
-                // Shift source data by offset_delta so it ends up in the right position
-                // Shift is different when drawing to the same page a second time
-                if (last_screen_page == screen_page)
+                // Run is finished, see whether it is cheaper to add it to the open window from the page above
+                uint8_t run_width = run_x2 - run_x1 + 1;
+
+                if (win_x1 <= win_x2 && win_page2 == page - 1)
                 {
-                    // Mask off bottom - offset when necessary
-                    mask_amt = u_mask - (OLED_PAGE_HEIGHT + offset_delta);
-                    //if (u_mask > (-1*offset_delta))
-                    if (mask_amt > 0 && lines_drawable > u_mask)
+                    uint8_t merged_x1 = (run_x1 < win_x1) ? run_x1 : win_x1;
+                    uint8_t merged_x2 = (run_x2 > win_x2) ? run_x2 : win_x2;
+                    uint8_t win_rows = win_page2 - win_page1 + 1;
+                    uint16_t separate_cost = (win_x2 - win_x1 + 1 + OLED_ROW_COST) * win_rows + OLED_WINDOW_COST + run_width + OLED_ROW_COST;
+                    uint16_t merged_cost = (merged_x2 - merged_x1 + 1 + OLED_ROW_COST) * (win_rows + 1);
+
+                    if (merged_cost <= separate_cost)
                     {
-                        source_data &= 0xFF >> mask_amt;  
+                        win_x1 = merged_x1;
+                        win_x2 = merged_x2;
+                        win_page2 = page;
+                        run_x1 = -1;
                     }
-                    
-                    // top pixels being shifted down
-                    screen_buffer[1 + column + screen_page*oled_width] |= source_data << (OLED_PAGE_HEIGHT + offset_delta); // page height - offset
                 }
-                else
-                {
-                    // Mask off top and bottom
-                    source_data &= 0xFF << l_mask; 
 
-                    if (u_mask > (-1*offset_delta))
+                if (run_x1 >= 0)
+                {
+                    // Couldn't merge, so send the open window and start a new one with this run
+                    if (win_x1 <= win_x2)
                     {
-                        //printf("u_mask: %d, offset: %d, sum: %d\n",u_mask, offset_delta, u_mask + offset_delta);
-                        source_data &= 0xFF >> (u_mask + offset_delta);
+                        send_and_update_reference(win_x1, win_page1, win_x2, win_page2);
+                        sent = true;
                     }
 
-                    // bottom pixels being shifted up
-                    screen_buffer[1 + column + screen_page*oled_width] |= source_data >> (-1 * offset_delta);
+                    win_x1 = run_x1;
+                    win_x2 = run_x2;
+                    win_page1 = page;
+                    win_page2 = page;
                 }
+
+                run_x1 = -1;
+            }
+
+            if (changed)
+            {
+                run_x1 = column;
+                run_x2 = column;
             }
-            
         }
+    }
+
+    if (win_x1 <= win_x2)
+    {
+        send_and_update_reference(win_x1, win_page1, win_x2, win_page2);
+        sent = true;
+    }
+
+    return sent;
+}
 
-        // Increment screen and source line counts by how much data was drawn
-        screen_line += lines_drawable;
-        src_line += lines_drawable;
 
-        // Update last pages
-        last_src_page = src_page;
-        last_screen_page = screen_page;
+/// @brief Send only the pages whose checksum differs from the last render
+/// @return false if no page had changed, so nothing was sent
+bool pico_oled::render_page_checksums()
+{
+    uint8_t pages = oled_height / OLED_PAGE_HEIGHT;
+    int16_t first_changed = -1;
+    bool sent = false;
+
+    // Go one page past the end to close the last range
+    for (uint8_t page = 0; page <= pages; page++)
+    {
+        uint8_t changed = 0;
 
-        // End if all necessary lines were drawn
-        //if (screen_line >= screen_y + blit_height - 1)
-        if (src_line > end_line)
+        if (page < pages)
         {
-            exit_flag = 1;
-#ifdef GFX_DEBUG            
-            printf("END! screen_line: %d, src_line: %d\n", screen_line, src_line);
-#endif
+            uint32_t checksum = page_checksum(&screen_buffer[1 + page*oled_width], oled_width);
+            changed = !reference_valid || checksum != page_checksums[page];
+            page_checksums[page] = checksum;
         }
 
+        // Consecutive changed pages are contiguous in the buffer, so they are sent as one window
+        if (changed && first_changed < 0)
+        {
+            first_changed = page;
+        }
+        else if (!changed && first_changed >= 0)
+        {
+            send_window(screen_buffer, 0, first_changed, oled_width - 1, page - 1);
+            first_changed = -1;
+            sent = true;
+        }
     }
+
+    reference_valid = 1;
+    return sent;
 }
 
 
-/// @brief Set the font to use for subsequent print calls
-/// @param new_font font to use
-void pico_oled::set_font(gfx_font new_font)
+/// @brief Set the region of display RAM that following data is written to
+/// @param x1 first column
+/// @param page1 first page
+/// @param x2 last column
+/// @param page2 last page
+void pico_oled::set_window(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2)
 {
-    font = new_font;
-    font_set = 1;
+    // The controller wraps within this window, so the data can be sent row by row
+    uint8_t window_cmds[] = 
+    {
+        OLED_SET_COL_ADDR,
+        x1,         // Start column
+        x2,         // End column
+
+        OLED_SET_PAGE_ADDR,
+        page1,      // Start page
+        page2       // End page
+    };
+    oled_send_cmd_list(window_cmds, sizeof(window_cmds));
 }
 
 
-/// @brief Draw a single character at the specified position. Font must be previously set.
-/// @param char_c character to draw
-/// @param x_pos screen x position
-/// @param y_pos screen y position
-void pico_oled::draw_char(uint8_t char_c, uint8_t x_pos, uint8_t y_pos)
+/// @brief Send a region of a screen sized buffer to the OLED
+/// @param buffer buffer laid out like screen_buffer, including the header byte
+/// @param x1 first column
+/// @param page1 first page
+/// @param x2 last column
+/// @param page2 last page
+/// @param clear zero each row of the window once the transport has taken it
+void pico_oled::send_window(uint8_t *buffer, uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2, bool clear)
 {
-    // Abort if the char is not within the drawable range
-    // if (char_c > font.last || char_c < font.first)
-    //     return;
+    set_window(x1, page1, x2, page2);
 
-#ifdef GFX_DEBUG            
-    printf("Character: %c, src_x: %d\n", char_c, font.character[char_c].bitmap_x);
-#endif
-    
-    char_c -= font.first;     // First character is element 0 of table
-    
-    blit_screen(font.bitmap, font.src_width, font.character[char_c].bitmap_x, 0, font.character[char_c].width, font.character[char_c].height, x_pos + font.character[char_c].x_offset, y_pos + font.character[char_c].y_offset);
-}
+    uint8_t window_width = x2 - x1 + 1;
 
+    if (window_width == oled_width)
+    {
+        // Full width rows are contiguous in the buffer, so send all the pages at once.
+        // The byte before the first page is lent to the transport as its header byte
+        uint8_t *start = &buffer[page1*oled_width];
+        uint8_t saved = *start;
 
-/// @brief Print a basic string. Only basic character drawing is supported, control characters have no effect
-/// @param print_str string to print
-void pico_oled::print(const char *print_str)
-{
-    uint8_t start_x = cursor_x;
+        transport->write_data(start, (page2 - page1 + 1)*oled_width);
+        *start = saved;
 
-    // Abort if no font has been set yet
-    if (!font_set)
-        return;
+        if (clear)
+            memset(start + 1, 0, (page2 - page1 + 1)*oled_width);
 
-    while (*print_str != '\0')
+        TELEMETRY_COUNT(0, (page2 - page1 + 1)*oled_width, 1);
+    }
+    else
     {
-        // Draw character if it's valid
-        if (*print_str <= font.last && *print_str >= font.first)
+        for (uint8_t page = page1; page <= page2; page++)
         {
-            // If character would be drawn over the edge of the screen
-            if (font.character[*print_str - font.first].width + cursor_x >= oled_width)
-            {      
-                // Reposition cursor at the left edge of the screen, one line down
-                cursor_x = 0;
-                cursor_y += font.line_height;
-            }
-            
-            draw_char(*print_str, cursor_x, cursor_y);
+            // Lend the byte before this row to the transport, then put it back
+            uint8_t *start = &buffer[x1 + page*oled_width];
+            uint8_t saved = *start;
 
-            cursor_x += font.character[*print_str - font.first].x_advance;
-        }
-        else if (*print_str == '\n')
-        {
-            // Reposition cursor one line down, at the x coordinate where printing started
-            cursor_x = start_x;
-            cursor_y += font.line_height;            
-        }
-        else if (*print_str == '\r')
-        {
-            // Reposition cursor back to the left edge of the screen
-            cursor_x = 0;
-        }
+            transport->write_data(start, window_width);
+            *start = saved;
 
-        print_str++;
+            if (clear)
+                memset(start + 1, 0, window_width);
+
+            TELEMETRY_COUNT(0, window_width, 1);
+        }
     }
 }
 
 
-/// @brief Print numbers by outsourcing formatting to sprintf()
-/// @param format_str printf style format string
-/// @param print_data number to print
-void pico_oled::print_num(const char *format_str, int32_t print_data)
+/// @brief Send full width rows held in the screen buffer, for buffers holding only some of the pages
+/// @param page1 first page to send
+/// @param page2 last page to send
+void pico_oled::send_strip(uint8_t page1, uint8_t page2)
 {
-    // Allocate a buffer big enough to hold the printed data
-    char output_buf[PRINT_NUM_BUFFER];
-    sprintf(output_buf, format_str, print_data);
-    print(output_buf);
-}
+    uint16_t length = (page2 - page1 + 1)*oled_width;
 
+    set_window(0, page1, oled_width - 1, page2);
 
-/// @brief Print numbers by outsourcing formatting to sprintf()
-/// @param format_str printf style format string
-/// @param print_data number to print
-void pico_oled::print_num(const char *format_str, uint32_t print_data)
-{
-    // Allocate a buffer big enough to hold the printed data
-    char output_buf[PRINT_NUM_BUFFER];
-    sprintf(output_buf, format_str, print_data);
-    print(output_buf);
-}
+    // The byte before the first page is lent to the transport as its header byte
+    uint8_t *start = page_row(page1) - 1;
+    uint8_t saved = *start;
 
+    transport->write_data(start, length);
+    *start = saved;
 
-/// @brief Print numbers by outsourcing formatting to sprintf()
-/// @param format_str printf style format string
-/// @param print_data number to print
-void pico_oled::print_num(const char *format_str, float print_data)
-{
-    // Allocate a buffer big enough to hold the printed data
-    char output_buf[PRINT_NUM_BUFFER];
-    sprintf(output_buf, format_str, print_data);
-    print(output_buf);
+    TELEMETRY_COUNT(0, length, 1);
 }
 
 
-/// @brief Print numbers by outsourcing formatting to sprintf()
-/// @param format_str printf style format string
-/// @param print_data number to print
-void pico_oled::print_num(const char *format_str, uint8_t print_data)
+/// @brief Write the changed region of the screen buffer to the OLED 
+void pico_oled::render()
 {
-    print_num(format_str, (uint32_t) print_data);
-}
+    GFX_PROFILE_SCOPE(GFX_PROF_RENDER);
 
+    // A strip buffer is only sent by pico_oled_paged::render_pages()
+    if (!holds_screen())
+        return;
 
-/// @brief Print numbers by outsourcing formatting to sprintf()
-/// @param format_str printf style format string
-/// @param print_data number to print
-void pico_oled::print_num(const char *format_str, int8_t print_data)
-{
-    print_num(format_str, (int32_t) print_data);
-}
+    // Draw the pages of a recorded frame that changed since the last one
+    finish_display_list();
 
+    // ////// debug stack check
+    // uint8_t prev_x = cursor_x;
+    // uint8_t prev_y = cursor_y;
 
-/// @brief Print numbers by outsourcing formatting to sprintf()
-/// @param format_str printf style format string
-/// @param print_data number to print
-void pico_oled::print_num(const char *format_str, uint16_t print_data)
-{
-    print_num(format_str, (uint32_t) print_data);
-}
+    // set_cursor(0, oled_height - font.line_height);
+    // print_num("%8X", (uint32_t) &prev_y);
 
+    // set_cursor(prev_x, prev_y);
 
-/// @brief Print numbers by outsourcing formatting to sprintf()
-/// @param format_str printf style format string
-/// @param print_data number to print
-void pico_oled::print_num(const char *format_str, int16_t print_data)
-{
-    print_num(format_str, (int32_t) print_data);
-}
+#ifdef OLED_TELEMETRY
+    uint32_t start_us = time_us_32();
+#endif
 
+    bool sent = true;
 
-/// @brief Draw a single pixel in the screen buffer
-/// @param x screen x position
-/// @param y screen y position
-void pico_oled::draw_pixel(uint8_t x, uint8_t y)
-{
-    // Abort if coordinates are out of bounds
-    if (x >= oled_width || y >= oled_height)
-        return;
+    switch (update_mode)
+    {
+        case OLED_UPDATE_SHADOW:
+            sent = render_shadow_diff();
+            break;
 
-    uint8_t screen_page = y / OLED_PAGE_HEIGHT;
+        case OLED_UPDATE_CHECKSUM:
+            sent = render_page_checksums();
+            break;
 
-    // Write to the column where the target pixel is
-    screen_buffer[1 + x + screen_page*oled_width] |= 1 << (y - screen_page*OLED_PAGE_HEIGHT);
-}
+        case OLED_UPDATE_DIRTY:
+        default:
+            // Nothing to do if nothing was drawn since the last render
+            if (dirty_x1 > dirty_x2 || dirty_page1 > dirty_page2)
+                return;
 
+            send_window(screen_buffer, dirty_x1, dirty_page1, dirty_x2, dirty_page2);
+    }
 
-/// @brief Draw a single pixel every other time this function is called
-/// @param x screen x position
-/// @param y screen y position
-void pico_oled::draw_pixel_alternating(uint8_t x, uint8_t y)
-{
-    if (pixel_counter++ > 0)
-    {
-        pixel_counter = 0;
-        draw_pixel(x, y);
-    }   
+    // Display now matches the buffer
+    clear_dirty();
+
+    // Finding that nothing changed isn't counted as a render
+    if (!sent)
+        return;
+
+#ifdef OLED_TELEMETRY
+    record_render(start_us);
+#endif
 }
 
 
-/// @brief Draw a line with the Bresenham algorithm
-/// @param x1 screen x position of line start
-/// @param y1 screen y position of line start
-/// @param x2 screen x position of line end
-/// @param y2 screen y position of line end
-void pico_oled::draw_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+/// @brief Start changing the calling core's telemetry counters. Clears them first if the other core asked for it
+/// @return counters of the calling core, to pass to end_telemetry() when done
+oled_core_telemetry *pico_oled::begin_telemetry()
 {
-    // Only try to use fast line functions for the default solid line draw_pixel()
-    if (draw_pixel_fn == &pico_oled::draw_pixel)
-    {
-        // Draw straight lines with the fast function instead
-        if (y1 == y2)
-        {
-            draw_fast_hline(x1, x2, y1);
-            return;
-        }
+    oled_core_telemetry *core = &telemetry[get_core_num()];
 
-        if (x1 == x2)
-        {
-            draw_fast_vline(y1, y2, x1);
-            return;
-        }
-    }
+    core->update_seq.store(core->update_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
 
-    int16_t dx, dy, p;
-    int16_t tmp;
-    int16_t steep = abs(y2 - y1) > abs(x2 - x1);
+    uint32_t reset_seq = core->reset_seq.load();
 
-    if (steep)
+    if (reset_seq != core->cleared_seq.load(std::memory_order_relaxed))
     {
-        // Swap x/y roles
-        tmp = x1;   // Save x1
-        x1 = y1;    // y1 -> x1
-        y1 = tmp;   // x1 -> y1
+        clear_telemetry(&core->counters);
+        core->cleared_seq.store(reset_seq);
+    }
 
-        tmp = x2;   // Save x2
-        x2 = y2;    // y2 -> x2
-        y2 = tmp;   // x2 -> y2
+    return core;
+}
+
+
+/// @brief Let the other core read counters changed since begin_telemetry()
+/// @param core counters returned by begin_telemetry()
+void pico_oled::end_telemetry(oled_core_telemetry *core)
+{
+    core->update_seq.store(core->update_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
 
-    }
 
-    // Switch coordinates around so that x1 < x2
-    if (x1 > x2)
+/// @brief Copy a core's telemetry counters, retrying if that core changes them part way through
+/// @param core number of the core that owns the counters
+/// @param counters set to the counters, cleared if a clear is still waiting for the owning core
+void pico_oled::read_telemetry(uint core, oled_telemetry *counters)
+{
+    oled_core_telemetry *source = &telemetry[core];
+    uint32_t seq;
+
+    do
     {
-        tmp = x1;   // Save x1
-        x1 = x2;    // x2 -> x1
-        x2 = tmp;   // x1 -> x2
+        seq = source->update_seq.load(std::memory_order_acquire);
+        *counters = source->counters;
+
+        if (source->reset_seq.load() != source->cleared_seq.load())
+            clear_telemetry(counters);
 
-        tmp = y1;   // Save y1
-        y1 = y2;    // y2 -> y1
-        y2 = tmp;   // y1 -> y2
+        std::atomic_thread_fence(std::memory_order_acquire);
     }
+    while ((seq & 1) || source->update_seq.load(std::memory_order_relaxed) != seq);
+}
 
 
-    dx = x2 - x1;
-    dy = abs(y2 - y1);
+/// @brief Add bytes handed to the transport to the calling core's counters
+/// @param cmd_bytes command bytes sent
+/// @param data_bytes display data bytes sent
+/// @param transfers separate command/data writes used
+void pico_oled::count_transfer(uint32_t cmd_bytes, uint32_t data_bytes, uint32_t transfers)
+{
+    oled_core_telemetry *core = begin_telemetry();
 
-    int16_t y_step;
+    core->counters.cmd_bytes += cmd_bytes;
+    core->counters.data_bytes += data_bytes;
+    core->counters.bytes_sent += cmd_bytes + data_bytes;
+    core->counters.transactions += transfers;
 
-    if (y1 < y2)
-        y_step = 1;
-    else
-        y_step = -1;
+    end_telemetry(core);
+}
 
-    //p = 2*dy - dx;
-    p = dx / 2;
 
-    for (; x1 <= x2; x1++)
-    {
-        // If slope is less than one, coordinates are swapped
-        if (steep)
-            (*this.*draw_pixel_fn)(y1, x1);
+/// @brief Add a render to the calling core's telemetry counters
+/// @param start_us time_us_32() when the render started
+void pico_oled::record_render(uint32_t start_us)
+{
+    uint32_t elapsed_us = time_us_32() - start_us;
+    oled_core_telemetry *core = begin_telemetry();
+    oled_telemetry *counters = &core->counters;
 
-        else
-            (*this.*draw_pixel_fn)(x1, y1);
+    counters->renders++;
+    counters->render_time_total_us += elapsed_us;
 
-        p -= dy;
+    if (elapsed_us < counters->render_time_min_us)
+        counters->render_time_min_us = elapsed_us;
 
-        if (p < 0)
-        {
-            y1 += y_step;
-            p += dx;
-        }
+    if (elapsed_us > counters->render_time_max_us)
+        counters->render_time_max_us = elapsed_us;
 
-    }
+    end_telemetry(core);
 }
 
 
-/// @brief Draw a dotted line with the Bresenham algorithm
-/// @param x1 screen x position of line start
-/// @param y1 screen y position of line start
-/// @param x2 screen x position of line end
-/// @param y2 screen y position of line end
-void pico_oled::draw_line_dotted(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+/// @brief Add a frame sent on the display's transport by something other than the render functions,
+///        e.g. oled_render_service, to the bus usage counters of the calling core. The window commands were already counted.
+/// @param start_us time_us_32() when sending the frame started
+/// @param bytes display data bytes sent
+/// @param transfers data transactions used
+void pico_oled::record_sent_frame(uint32_t start_us, uint32_t bytes, uint32_t transfers)
 {
-    pixel_counter = 0;    // Reset pixel counter so that calling this function results in the same kind of line draw each time
-    draw_pixel_fn = &pico_oled::draw_pixel_alternating;  // Change the draw pixel function so it only draws every other pixel
+    TELEMETRY_COUNT(0, bytes, transfers);
 
-    draw_line(x1, y1, x2, y2);
-
-    draw_pixel_fn = &pico_oled::draw_pixel;    // Restore the default draw_pixel function
+#ifdef OLED_TELEMETRY
+    record_render(start_us);
+#endif
 }
 
 
-/// @brief Simplified line drawing for horizontal lines
-/// @param x1 screen x position of line start
-/// @param x2 screen x position of line end
-/// @param y screen y coordinate of the line
-void pico_oled::draw_fast_hline(uint8_t x1, uint8_t x2, uint8_t y)
+/// @brief Get a snapshot of the bus usage counters of both cores added together. All counters stay at zero unless
+///        built with OLED_TELEMETRY defined.
+/// @return counters since the last reset_telemetry()
+oled_telemetry pico_oled::get_telemetry()
 {
+    oled_telemetry snapshot;
+    clear_telemetry(&snapshot);
 
-    // Flip x coordinates to keep x1 < x2
-    if (x1 > x2)
+    for (uint core = 0; core < NUM_CORES; core++)
     {
-        uint8_t tmp = x1;
-        x1 = x2;
-        x2 = tmp;
+        oled_telemetry counters;
+        read_telemetry(core, &counters);
+
+        snapshot.bytes_sent += counters.bytes_sent;
+        snapshot.transactions += counters.transactions;
+        snapshot.cmd_bytes += counters.cmd_bytes;
+        snapshot.data_bytes += counters.data_bytes;
+        snapshot.renders += counters.renders;
+        snapshot.render_time_total_us += counters.render_time_total_us;
+
+        if (counters.render_time_min_us < snapshot.render_time_min_us)
+            snapshot.render_time_min_us = counters.render_time_min_us;
+
+        if (counters.render_time_max_us > snapshot.render_time_max_us)
+            snapshot.render_time_max_us = counters.render_time_max_us;
     }
 
-    // fix coordinates or abort if coordinates are out of bounds
-    if (x1 >= oled_width  || y >= oled_height)
-        return;    
+    if (snapshot.renders > 0)
+        snapshot.render_time_avg_us = snapshot.render_time_total_us / snapshot.renders;
+    else
+        snapshot.render_time_min_us = 0;
 
-    if (x2 >= oled_width)
-        x2 = oled_width - 1;
+    return snapshot;
+}
 
-    uint8_t screen_page = y / OLED_PAGE_HEIGHT;
-    uint8_t mask = 1 << (y - screen_page*OLED_PAGE_HEIGHT);
 
-    for (; x1 <= x2; x1++)
-    {
-        // Write to the column where the target pixel is
-        screen_buffer[1 + x1 + screen_page*oled_width] |= mask;    
-    }
+/// @brief Clear the bus usage counters. Each core clears its own counters the next time it counts something,
+///        until then get_telemetry() leaves them out.
+void pico_oled::reset_telemetry()
+{
+    for (uint core = 0; core < NUM_CORES; core++)
+        telemetry[core].reset_seq.store(telemetry[core].reset_seq.load() + 1);
 }
 
 
-/// @brief Simplified line drawing for vertical lines
-/// @param y1 screen y coordinate of the line start
-/// @param y2 screen y coordinate of the line end
-/// @param x screen x coordinate of the line
-void pico_oled::draw_fast_vline(uint8_t y1, uint8_t y2, uint8_t x)
+/// @brief Start sending the changed region of the screen buffer to the OLED without waiting for it to finish.
+///        The frame is copied to the transport's front buffer and sent in the background, so drawing into the 
+///        screen buffer can continue straight away. Waits for the previous frame if it is still being sent.
+///        Falls back to render() if the transport can't send in the background.
+void pico_oled::render_async()
 {
-    // Flip y coordinates to keep y1 < y2
-    if (y1 > y2)
-    {
-        uint8_t tmp = y1;
-        y1 = y2;
-        y2 = tmp;
-    }
+    GFX_PROFILE_SCOPE(GFX_PROF_RENDER_ASYNC);
 
-    // fix coordinates or abort if coordinates are out of bounds
-    if (y1 >= oled_height  || x >= oled_width)
-        return;    
+    if (!holds_screen())
+        return;
 
-    if (y2 >= oled_width)
-        y2 = oled_width - 1;
+    finish_display_list();
 
-    uint8_t first_page = y1 / OLED_PAGE_HEIGHT;    
-    uint8_t last_page = y2 / OLED_PAGE_HEIGHT;
-    uint8_t top_offset = y1 - first_page*OLED_PAGE_HEIGHT;
-    uint8_t bottom_offset = y2 - last_page*OLED_PAGE_HEIGHT + 1;
+    uint8_t reference_was_valid = reference_valid;
+
+#ifdef OLED_TELEMETRY
+    uint32_t start_us = time_us_32();
+#endif
 
-    for (uint8_t page = first_page; page <= last_page; page++)
+    // Compare against display RAM and send everything that changed as one window
+    if (update_mode != OLED_UPDATE_DIRTY)
     {
-        uint8_t mask = 0xFF;
+        clear_dirty();
 
-        if (page == first_page)
-        {
-            mask &= 0xFF << top_offset; // Pull zeros into LSBs
-        }
+        if (find_changed_window(&dirty_x1, &dirty_page1, &dirty_x2, &dirty_page2) == false)
+            return;
+    }
 
-        if (page == last_page)
-        {
-            mask &= 0xFF >> (OLED_PAGE_HEIGHT - bottom_offset);
-        }
+    // Nothing to do if nothing was drawn since the last render
+    if (dirty_x1 > dirty_x2 || dirty_page1 > dirty_page2)
+        return;
 
-        // Draw current page
-        screen_buffer[1 + x + page*oled_width] |= mask; 
-    }
+    set_window(dirty_x1, dirty_page1, dirty_x2, dirty_page2);
 
-}
+    // The controller wraps within the window, so all rows can go out as one transfer
+    if (!transport->write_data_async(&screen_buffer[1 + dirty_x1 + dirty_page1*oled_width], dirty_x2 - dirty_x1 + 1, oled_width, dirty_page2 - dirty_page1 + 1))
+    {
+        reference_valid = reference_was_valid;
+        render();
+        return;
+    }
 
+    if (update_mode != OLED_UPDATE_DIRTY)
+        update_reference(dirty_x1, dirty_page1, dirty_x2, dirty_page2);
 
-/// @brief Draw a vertical bar graph
-/// @param fullness how full the bar is, where 0 = empty and 100 = full
-/// @param x1 screen x coordinate of the top-left corner of the bar
-/// @param y1 screen y coordinate of the top-left corner of the bar
-/// @param x2 screen x coordinate of the bottom-right corner of the bar
-/// @param y2 screen y coordinate of the bottom-right corner of the bar
-void pico_oled::draw_vbar(uint8_t fullness, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
-{
-    uint8_t height = y2 - y1;
-    uint8_t filled_px = (fullness * (height - 2)) / 100;
+    TELEMETRY_COUNT(0, (dirty_x2 - dirty_x1 + 1)*(dirty_page2 - dirty_page1 + 1), 1);
 
-    // Draw the outline
-    draw_box(x1, y1, x2, y2); 
+#ifdef OLED_TELEMETRY
+    record_render(start_us);
+#endif
 
-    // Draw lines to fill the internal area
-    for (uint8_t y_line = y2 - 1; y_line >= (y2 - 1) - filled_px; y_line--)
-        draw_fast_hline(x1 + 1, x2 - 1, y_line);
+    // The frame is now owned by the front buffer
+    clear_dirty();
 }
 
 
-/// @brief Draw a horizontal bar graph
-/// @param fullness how full the bar is, where 0 = empty and 100 = full
-/// @param start_right Greater than 0 for bar to start on the right instead of the left side
-/// @param x1 screen x coordinate of the top-left corner of the bar
-/// @param y1 screen y coordinate of the top-left corner of the bar
-/// @param x2 screen x coordinate of the bottom-right corner of the bar
-/// @param y2 screen y coordinate of the bottom-right corner of the bar
-void pico_oled::draw_hbar(uint8_t fullness, uint8_t start_right, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+/// @brief Start sending the changed region of the screen buffer like render_async(), and leave the buffer cleared
+///        like fill(0). Rows are cleared as they are copied to the transport's front buffer, and only the area
+///        that was sent or drawn is cleared. It costs about the same as render_async() followed by fill(0).
+void pico_oled::render_async_and_clear()
 {
-    uint8_t width = x2 - x1;
-    uint8_t filled_px = (fullness * (width - 2)) / 100;
+    GFX_PROFILE_SCOPE(GFX_PROF_RENDER_ASYNC_AND_CLEAR);
 
-    // Draw the outline
-    draw_box(x1, y1, x2, y2);
+    if (!holds_screen())
+        return;
 
-    // Draw lines to fill the internal area
-    if (start_right)
+    // The other update modes compare the buffer with what was sent, so it can't be cleared before it is compared.
+    // A display list clears the pages it draws on by itself
+    if (update_mode != OLED_UPDATE_DIRTY || display_list != NULL)
     {
-        for (uint8_t x_line = x2 - 1; x_line >= (x2 - 1) - filled_px; x_line--)
-            draw_fast_vline(y1 + 1, y2 - 1, x_line);
-    }
-    else
-    {
-        for (uint8_t x_line = x1 + 1; x_line <= (x1 + 1) + filled_px; x_line++)
-            draw_fast_vline(y1 + 1, y2 - 1, x_line);
+        render_async();
+
+        if (display_list == NULL)
+            fill(0);
+
+        return;
     }
-}
 
+    uint8_t x1 = dirty_x1;
+    uint8_t page1 = dirty_page1;
+    uint8_t x2 = dirty_x2;
+    uint8_t page2 = dirty_page2;
 
-/// @brief Draw a vertical bar graph using bitmap images
-/// @param fullness how full the bar is, where 0 = empty and 100 = full
-/// @param empty_bitmap bitmap of the bar (empty frame) when it is 0% full
-/// @param full_bitmap bitmap of the bar (with or without frame) when it is 100% full.
-/// @param x screen x coordinate of the top-left corner of the bar image
-/// @param y screen y coordinate of the top-left corner of the bar image
-void pico_oled::draw_bmp_vbar(uint8_t fullness, const bitmap empty_bitmap, const bitmap full_bitmap, uint8_t x, uint8_t y)
-{
-    uint8_t filled_px = (fullness * empty_bitmap.height) / 100;   // This assumes the active area is the whole bar bmp, including frame
+    if (x1 <= x2 && page1 <= page2)
+    {
+#ifdef OLED_TELEMETRY
+        uint32_t start_us = time_us_32();
+#endif
 
-    // Draw the empty frame 
-    blit_screen(empty_bitmap.bitmap, empty_bitmap.width, 0, 0, empty_bitmap.width, empty_bitmap.height, x, y);
+        set_window(x1, page1, x2, page2);
 
-    // Draw as much of the full bitmap that would be proportional to fullness (from the bottom)
-    blit_screen(full_bitmap.bitmap, full_bitmap.width, 0, full_bitmap.height - filled_px, full_bitmap.width, filled_px, x, y + (full_bitmap.height - filled_px));
+        if (transport->write_data_async(&screen_buffer[1 + x1 + page1*oled_width], x2 - x1 + 1, oled_width, page2 - page1 + 1, true))
+        {
+            TELEMETRY_COUNT(0, (x2 - x1 + 1)*(page2 - page1 + 1), 1);
+        }
+        else
+            send_window(screen_buffer, x1, page1, x2, page2, true);
 
-}
+#ifdef OLED_TELEMETRY
+        record_render(start_us);
+#endif
+    }
 
+    // Display now matches what was sent
+    clear_dirty();
 
-/// @brief Solid fill a rectangular region
-/// @param blank nonzero to clear the rectangle (pixels off)
-/// @param x1 screen x coordinate of the top-left corner of the rectangle
-/// @param y1 screen y coordinate of the top-left corner of the rectangle
-/// @param x2 screen x coordinate of the bottom-right corner of the rectangle
-/// @param y2 screen y coordinate of the bottom-right corner of the rectangle
-void pico_oled::fill_rect(uint8_t blank, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
-{
-    // Switch coordinates around so that y1 < y2
-    if (y1 > y2)
+    // A background other than 0 covers the whole buffer
+    if (last_fill != 0)
     {
-        uint8_t tmp;
-        tmp = x1;   // Save x1
-        x1 = x2;    // x2 -> x1
-        x2 = tmp;   // x1 -> x2
-
-        tmp = y1;   // Save y1
-        y1 = y2;    // y2 -> y1
-        y2 = tmp;   // y1 -> y2
-    }    
-
-    uint8_t start_page = y1 / OLED_PAGE_HEIGHT;
-    uint8_t end_page = y2 / OLED_PAGE_HEIGHT;    
-    uint8_t col_mask, column;
-    int8_t inc;
-
-    // Determine whether to iterate up or down
-    if (x1 <= x2)
-        inc = 1;
-    else
-        inc = -1;
+        fill(0);
+        return;
+    }
 
-    for (uint8_t page = start_page; page <= end_page; page++)
+    // Only the area drawn since the last fill can still be set. Most of it was normally cleared as it was sent,
+    // the rest was drawn before the last render
+    if (ink_x1 <= ink_x2)
     {
-        //for(uint8_t column = x1; column != x2; (x1 <= x2) ? column++ : column--)
-
-        column = x1 + -1*inc;   // Start just ahead of x1 because column gets incremented first
-        do
+        if (ink_x1 < x1 || ink_x2 > x2 || ink_page1 < page1 || ink_page2 > page2)
         {
-            column += inc;
-            col_mask = 0xFF;
-
-            // For the first page, we may not need to fill every pixel
-            if (page == start_page)
-                col_mask &= 0xFF << (y1 - page*OLED_PAGE_HEIGHT);   // Shift zeros into LSBs
-
-            // For the last page, we may not need to fill every pixel
-            if (page == end_page)
-                col_mask &= 0xFF >> (OLED_PAGE_HEIGHT - (1 + y2 - page*OLED_PAGE_HEIGHT));   // Shift zeros into MSBs
-            
-            // Modify the screen contents according to the specified mode
-            if (blank)
-                screen_buffer[1 + column + page*oled_width] &= ~col_mask;
-            else
-                screen_buffer[1 + column + page*oled_width] |= col_mask;
-        }   
-        while (column != x2);
+            for (uint8_t page = ink_page1; page <= ink_page2; page++)
+                memset(&screen_buffer[1 + ink_x1 + page*oled_width], 0, ink_x2 - ink_x1 + 1);
+        }
+
+        // The display still shows it, so the next frame has to clear it unless it is drawn again
+        mark_dirty(ink_x1, ink_page1, ink_x2, ink_page2);
     }
+
+    ink_x1 = 0xFF;
+    ink_x2 = 0;
+    ink_page1 = 0xFF;
+    ink_page2 = 0;
+}
+
+
+/// @brief Check whether a frame started by render_async() is still being sent
+/// @return true until the transport has finished sending the frame
+bool pico_oled::render_busy()
+{
+    return transport->busy();
 }
 
 
-/// @brief Draw a box outline at the given coordinates
-/// @param x1 screen x coordinate of the top-left corner of the box
-/// @param y1 screen y coordinate of the top-left corner of the box
-/// @param x2 screen x coordinate of the bottom-right corner of the box
-/// @param y2 screen y coordinate of the bottom-right corner of the box
-void pico_oled::draw_box(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+/// @brief Block until a frame started by render_async() has been sent. Returns immediately if none is in progress.
+void pico_oled::render_wait()
 {
-    draw_fast_hline(x1, x2, y1);  // Top 
-    draw_fast_hline(x1, x2, y2);  // Bottom
-    draw_fast_vline(y1, y2, x1);  // Left
-    draw_fast_vline(y1, y2, x2);  // Right       
+    transport->wait();
 }
 
 
-// x = r*cos(th)
-// y = r*sin(th)
-// th = atan(y/x)
-// r = sqrt(x^2 + y^2)
+/// @brief Tell the display whether to turn on all pixels or follow RAM contents
+/// @param disp_on nonzero to turn on all screen pixels, zero to display RAM contents
+void pico_oled::all_on(uint8_t disp_on)
+{
+    uint8_t cmd = disp_on ? 0xA5 : 0xA4;
+    oled_send_cmd_list(&cmd, 1);
+}
 
 
-/// @brief Draw a line with polar coordinates
-/// @param origin_x screen x coordinate of the start of the line
-/// @param origin_y screen y coordinate of the start of the line
-/// @param magnitude polar magnitude of the line
-/// @param angle polar angle of the line
-void pico_oled::draw_line_polar(uint8_t origin_x, uint8_t origin_y, uint8_t magnitude, float angle)
+/// @brief Pages in each strip of a pico_oled_paged, limited to the pages on the screen
+static uint8_t strip_page_count(uint8_t screen_height, uint8_t strip_pages)
 {
-    float end_x, end_y;
+    uint8_t pages = screen_height / OLED_PAGE_HEIGHT;
 
-    // Convert degrees to radians
-    angle = (angle / 360.0) * 2.0 * M_PI;
+    if (strip_pages < 1)
+        return 1;
+
+    return (strip_pages < pages) ? strip_pages : pages;
+}
 
-    // Convert polar to rect
-    sincosf(angle, &end_y, &end_x);
-    end_x = end_x * magnitude + origin_x;
-    end_y = end_y * magnitude + origin_y;
 
-    draw_line(origin_x, origin_y, end_x, end_y);
+/// @brief Create a display drawn one strip at a time, with a buffer of only strip_pages * screen_width + 1 bytes
+/// @param controller_ic display controller type
+/// @param bus transport used to talk to the display
+/// @param screen_width width of the display in pixels
+/// @param screen_height height of the display in pixels
+/// @param strip_pages pages (8 pixel rows) held in the buffer. More pages use more RAM but call the draw function fewer times
+/// @param reset_gpio GPIO connected to the display's reset pin, or an invalid pin number (>29) if not used
+pico_oled_paged::pico_oled_paged(OLED_type controller_ic, oled_transport *bus, uint8_t screen_width, uint8_t screen_height, uint8_t strip_pages, uint8_t reset_gpio)
+    : pico_oled(controller_ic, bus, screen_width, screen_height,
+        alloc_screen_buffer(screen_width, strip_page_count(screen_height, strip_pages) * OLED_PAGE_HEIGHT), reset_gpio)
+{
+    owned_buffer = screen_buffer;
+    this->strip_pages = strip_page_count(screen_height, strip_pages);
+    set_buffer_pages(0, this->strip_pages - 1);
 }
 
 
-/// @brief Determine the screen space required to draw a string
-/// @param input_str string to calculate size of
-/// @param width pointer to variable to store the calculated width
-/// @param height pointer to variable to store the calculated height
-void pico_oled::get_str_dimensions(const char *input_str, uint8_t *width, uint8_t *height)
+/// @brief Draw and send a whole frame, one strip at a time. The draw function is called once per strip with
+///        drawing clipped to the strip, so it must draw the same frame every time it is called.
+///        The cursor is put back where it was before each call so text is laid out the same way in each strip.
+///        In OLED_UPDATE_CHECKSUM mode only pages that changed since the last frame are sent,
+///        otherwise every strip is sent.
+/// @param draw function drawing the frame on the canvas it is given
+/// @param context passed to the draw function
+void pico_oled_paged::render_pages(oled_draw_fn draw, void *context)
 {
-    uint8_t max_width = 0;
-    uint8_t line_width = 0;
-    char* current_char = (char *)input_str; 
+    GFX_PROFILE_SCOPE(GFX_PROF_RENDER_PAGES);
+
+#ifdef OLED_TELEMETRY
+    uint32_t start_us = time_us_32();
+#endif
 
-    *height = font.line_height;
+    uint8_t pages = oled_height / OLED_PAGE_HEIGHT;
+    int16_t start_x = cursor_x;
+    int16_t start_y = cursor_y;
+    bool sent = false;
 
-    while (*current_char != '\0')
+    for (uint8_t page1 = 0; page1 < pages; page1 += strip_pages)
     {
-        if (*current_char != '\n')
-        {
+        uint8_t page2 = (page1 + strip_pages <= pages) ? page1 + strip_pages - 1 : pages - 1;
+
+        set_buffer_pages(page1, page2);
+        fill(0);
+        cursor_x = start_x;
+        cursor_y = start_y;
 
-            line_width += font.character[*current_char - font.first].x_advance; 
+        draw(this, context);
+
+        if (update_mode != OLED_UPDATE_CHECKSUM)
+        {
+            send_strip(page1, page2);
+            sent = true;
+            continue;
         }
-        else
+
+        for (uint8_t page = page1; page <= page2; page++)
         {
-            // Character is newline, height is increased one line's worth
-            *height += font.line_height;
+            uint32_t checksum = page_checksum(page_row(page), oled_width);
 
-            // Save current line's width if it's longest
-            if (line_width > max_width)
-                max_width = line_width;
+            if (!reference_valid || checksum != page_checksums[page])
+            {
+                send_strip(page, page);
+                sent = true;
+            }
 
-            line_width = 0;
+            page_checksums[page] = checksum;
         }
-        current_char++;
     }
 
-    if (line_width > max_width)
-        *width = line_width;
-    else
-        *width = max_width;
+    // Leave the buffer holding the first strip, as it was constructed
+    set_buffer_pages(0, strip_pages - 1);
+    reference_valid = 1;
+    clear_dirty();
 
+    // A frame with no changed pages isn't counted as a render
+    if (!sent)
+        return;
+
+#ifdef OLED_TELEMETRY
+    record_render(start_us);
+#endif
 }
 
 
-/// @brief Draw a string within a box outline
-/// @param print_str string to print
-/// @param padding number of extra pixels to pad around the text
-/// @param fill_bg nonzero to clear the area under the text box before drawing it
-/// @param x screen x coordinate of the top-left of the text box
-/// @param y screen y coordinate of the top-left of the text box
-void pico_oled::draw_boxed_text(const char *print_str, uint8_t padding, uint8_t fill_bg, uint8_t x, uint8_t y)
+/// @brief A set of displays that are rendered together. Each display's frame is started before waiting for any of them,
+///        so displays on separate buses (or separate transports) are sent in parallel. Displays sharing an I2C bus take turns.
+oled_render_group::oled_render_group()
 {
-    uint8_t text_width, text_height;
-    uint8_t tmp_cursor_x = cursor_x;
-    uint8_t tmp_cursor_y = cursor_y;
-    uint8_t box_x2;
-    uint8_t box_y2;
-    
-    get_str_dimensions(print_str, &text_width, &text_height);
+    display_count = 0;
+}
 
-    box_x2 = 2 + x + text_width + 2*padding;
-    box_y2 = 2 + y + text_height + 2*padding;
 
-    // Clear the area under the textbox if desired
-    if (fill_bg)
-        fill_rect(1, x, y, box_x2, box_y2);
+/// @brief Add a display to the group
+/// @param display display to add
+/// @return false if the group is already full
+bool oled_render_group::add(pico_oled *display)
+{
+    if (display_count >= OLED_RENDER_GROUP_MAX)
+        return false;
 
-    draw_box(x, y, box_x2, box_y2);
+    displays[display_count++] = display;
+    return true;
+}
 
-    set_cursor(x + padding + 2, y + padding + 1);
-    print(print_str);
 
-    // Restore original cursor position
-    set_cursor(tmp_cursor_x, tmp_cursor_y);
+/// @brief Start sending the changed region of every display in the group
+void oled_render_group::render_async()
+{
+    for (uint8_t i = 0; i < display_count; i++)
+        displays[i]->render_async();
 }
 
 
+/// @brief Block until every display in the group has finished sending its frame
+void oled_render_group::render_wait()
+{
+    for (uint8_t i = 0; i < display_count; i++)
+        displays[i]->render_wait();
+}
+
+
+/// @brief Check whether any display in the group is still sending its frame
+/// @return true if at least one display is busy
+bool oled_render_group::render_busy()
+{
+    for (uint8_t i = 0; i < display_count; i++)
+    {
+        if (displays[i]->render_busy())
+            return true;
+    }
+
+    return false;
+}
+
 
 /// @brief An object which handles the configuration and drawing of an analog gauge
-/// @param display Address of pico_oled display instance to use for drawing
-analog_gauge::analog_gauge(pico_oled *display)
+/// @param display Address of the display (or offscreen canvas) to draw on
+analog_gauge::analog_gauge(oled_canvas *display)
 {
     master_display = display;
 
@@ -1092,6 +1285,8 @@ analog_gauge::analog_gauge(pico_oled *display)
 /// @param div_angle polar angle to draw the marker at
 void analog_gauge::draw_maj_div_line(float div_angle)
 {
+    GFX_PROFILE_SCOPE(GFX_PROF_GAUGE_DRAW_MAJ_DIV_LINE);
+
     float x1, y1, x2, y2;
     float x_ratio, y_ratio;
 
@@ -1117,6 +1312,8 @@ void analog_gauge::draw_maj_div_line(float div_angle)
 /// @brief Draw the gauge using the parameters provided within the class
 void analog_gauge::draw()
 {
+    GFX_PROFILE_SCOPE(GFX_PROF_GAUGE_DRAW);
+
     // //dbg
     // master_display->fill(0);
     // master_display->set_cursor(0,0);
@@ -1,5 +1,12 @@
+#ifndef _PICO_OLED_H_
+#define _PICO_OLED_H_
+
 #include "pico/stdlib.h"
 #include "gfx_font.h"
+#include "oled-canvas.hpp"
+#include "oled-transport.hpp"
+#include <array>
+#include <atomic>
 
 
 // SSD1306 commands
@@ -25,7 +32,6 @@
 
 #define OLED_WRITE_MODE _u(0xFE)
 #define OLED_READ_MODE _u(0xFF)
-#define OLED_PAGE_HEIGHT _u(8)
 
 
 typedef enum 
@@ -34,86 +40,198 @@ typedef enum
     OLED_SSD1309
 } OLED_type;
 
+typedef enum
+{
+    OLED_UPDATE_DIRTY,      // Send the region touched by drawing calls since the last render
+    OLED_UPDATE_SHADOW,     // Compare against a copy of display RAM and send only the bytes that differ
+    OLED_UPDATE_CHECKSUM    // Compare per-page checksums against the last render and send only the pages that differ
+} OLED_update_mode;
+
+typedef struct
+{
+    uint32_t bytes_sent;            // Command and data bytes handed to the transport
+    uint32_t transactions;          // Separate command/data writes handed to the transport
+    uint32_t cmd_bytes;
+    uint32_t data_bytes;
+    uint32_t renders;               // render() and render_async() calls that had something to send
+    uint32_t render_time_min_us;    // Time spent in render() or render_async()
+    uint32_t render_time_avg_us;
+    uint32_t render_time_max_us;
+    uint64_t render_time_total_us;
+} oled_telemetry;
+
+// Telemetry counters written by one core. The other core copies them while update_seq stays even and unchanged,
+// and asks for them to be cleared through reset_seq rather than clearing them itself
 typedef struct
 {
-    const uint8_t *bitmap;
-    uint16_t width;
-    uint16_t height;
-} bitmap;
+    oled_telemetry counters;
+    std::atomic<uint32_t> update_seq;   // Odd while the owning core is changing the counters
+    std::atomic<uint32_t> reset_seq;    // Bumped to ask the owning core to clear the counters
+    std::atomic<uint32_t> cleared_seq;  // reset_seq when the owning core last cleared the counters
+} oled_core_telemetry;
 
+// Draws one frame on a canvas, see pico_oled_paged::render_pages()
+typedef void (*oled_draw_fn)(oled_canvas *canvas, void *context);
 
-class pico_oled
+/// @brief A display, drawn on through its canvas and updated with render()
+class pico_oled : public oled_canvas
 {
-    private:
+    protected:
         OLED_type oled_controller;
+        oled_transport *transport;
         uint8_t rst_gpio;
-        uint8_t i2c_addr;
-        uint8_t oled_height, oled_width;
-        uint8_t *screen_buffer;
-        int screen_buf_length;
-        gfx_font font;
-        uint8_t font_set;
-        uint8_t cursor_x;
-        uint8_t cursor_y;
-        void (pico_oled::*draw_pixel_fn)(uint8_t, uint8_t);
+
+        // Memory the display allocated itself, freed by the destructor
+        oled_transport *owned_transport;
+        uint8_t *owned_buffer;
+
+        // Copy of what is in display RAM (OLED_UPDATE_SHADOW) or a checksum of each page as last sent (OLED_UPDATE_CHECKSUM)
+        OLED_update_mode update_mode;
+        uint8_t *shadow_buffer;
+        uint32_t *page_checksums;
+        uint8_t reference_valid;
+
+        // Bus usage counters of each core, only updated when built with OLED_TELEMETRY defined. Frames sent by
+        // oled_render_service are counted by core 1
+        oled_core_telemetry telemetry[NUM_CORES];
+        oled_core_telemetry *begin_telemetry();
+        void end_telemetry(oled_core_telemetry *core);
+        void read_telemetry(uint core, oled_telemetry *counters);
+        void count_transfer(uint32_t cmd_bytes, uint32_t data_bytes, uint32_t transfers);
+        void record_render(uint32_t start_us);
+        void record_sent_frame(uint32_t start_us, uint32_t bytes, uint32_t transfers);
+
+        void set_window(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2);
+        void send_window(uint8_t *buffer, uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2, bool clear=false);
+        void send_and_update_reference(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2);
+        void update_reference(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2);
+        bool find_changed_window(uint8_t *x1, uint8_t *page1, uint8_t *x2, uint8_t *page2);
+        bool render_shadow_diff();
+        bool render_page_checksums();
+        void send_strip(uint8_t page1, uint8_t page2);
+        void clear_display();
+
+        /// @brief true if the screen buffer holds every page of the display (it holds one strip in pico_oled_paged)
+        bool holds_screen() { return buffer_page1 == 0 && buffer_page2 == oled_height / OLED_PAGE_HEIGHT - 1; }
+
+        // Takes over the screen buffer and transport while it runs
+        friend class oled_render_service;
+
+        pico_oled(OLED_type controller_ic, oled_transport *bus, uint8_t screen_width, uint8_t screen_height, uint8_t *buffer, uint8_t reset_gpio);
 
     public:
+        pico_oled(OLED_type controller_ic, oled_transport *bus, uint8_t screen_width, uint8_t screen_height, uint8_t reset_gpio=64);
+        pico_oled(OLED_type controller_ic, i2c_inst_t *i2c, uint8_t i2c_address, uint8_t screen_width, uint8_t screen_height, uint8_t reset_gpio=64);
         pico_oled(OLED_type controller_ic, uint8_t i2c_address, uint8_t screen_width, uint8_t screen_height, uint8_t reset_gpio=64);
+        ~pico_oled();
         void oled_init();
         void oled_ssd1306_init();
         void oled_ssd1309_init();
         void oled_send_cmd(uint8_t cmd);
-        void fill(uint8_t fill);
+        void oled_send_cmd_list(const uint8_t *cmds, uint8_t length);
         void all_on(uint8_t disp_on);   
         void render();
-        void blit_screen(const uint8_t *src_bitmap, uint16_t src_width, uint16_t src_x, uint8_t src_y, uint8_t blit_width, uint8_t blit_height, uint8_t screen_x, uint8_t screen_y);
+        void render_async();
+        void render_async_and_clear();
+        void render_wait();
+        bool render_busy();
+        void invalidate();
+        bool is_dirty(){return dirty_x1 <= dirty_x2;};     // true if anything was drawn since the last render
+        void set_update_mode(OLED_update_mode mode);
+        oled_telemetry get_telemetry();
+        void reset_telemetry();
+        void set_brightness(uint8_t brightness);
+};
+
+
+/// @brief Screen buffer of a pico_oled_static. A base class so it exists before pico_oled's constructor uses it.
+template <int Length>
+struct oled_static_buffer
+{
+    std::array<uint8_t, Length> frame;
+};
+
+
+/// @brief Display with its size and controller fixed at compile time and its screen buffer inside the object,
+///        so nothing is allocated from the heap (except by OLED_UPDATE_SHADOW/OLED_UPDATE_CHECKSUM).
+///        Declare it as a global or static to keep the buffer off the stack.
+///        Works anywhere a pico_oled does. At OLED_FIXED_STRIDE wide (128x32, 128x64) it draws with the kernels
+///        compiled for that width, which find a page with a shift instead of a multiply by oled_width.
+/// @tparam Width width of the display in pixels
+/// @tparam Height height of the display in pixels, a multiple of 8
+/// @tparam Controller display controller type
+template <uint8_t Width, uint8_t Height, OLED_type Controller>
+class pico_oled_static : private oled_static_buffer<Width * (Height / OLED_PAGE_HEIGHT) + 1>, public pico_oled
+{
+    static_assert(Height % OLED_PAGE_HEIGHT == 0, "Display height must be a multiple of 8");
+    static_assert(Width <= 128 && Height <= 64, "SSD1306/SSD1309 displays are at most 128x64");
 
-        void draw_bmp(const uint8_t *src_bitmap, uint8_t src_width, uint8_t src_height, uint8_t screen_x, uint8_t screen_y)
+    public:
+        static constexpr uint8_t width = Width;
+        static constexpr uint8_t height = Height;
+        static constexpr uint8_t pages = Height / OLED_PAGE_HEIGHT;
+
+        /// @param bus transport used to talk to the display
+        /// @param reset_gpio GPIO connected to the display's reset pin, or an invalid pin number (>29) if not used
+        pico_oled_static(oled_transport *bus, uint8_t reset_gpio=64)
+            : pico_oled(Controller, bus, Width, Height, this->frame.data(), reset_gpio)
         {
-            blit_screen(src_bitmap, src_width, 0, 0, src_width, src_height, screen_x, screen_y);
+            fixed_stride = (Width == OLED_FIXED_STRIDE) ? OLED_FIXED_STRIDE : 0;
         }
+};
 
-        void set_cursor(uint8_t cursor_x, uint8_t cursor_y)
+
+/// @brief Display drawn one strip of pages at a time, for when there is no RAM for a whole screen buffer.
+///        The buffer holds strip_pages pages (width bytes each) instead of the whole screen. Draw with
+///        render_pages(), which calls the draw function once per strip with drawing clipped to that strip,
+///        and sends each strip as soon as it has been drawn. render() and render_async() do nothing.
+class pico_oled_paged : public pico_oled
+{
+    private:
+        uint8_t strip_pages;
+
+    public:
+        pico_oled_paged(OLED_type controller_ic, oled_transport *bus, uint8_t screen_width, uint8_t screen_height, uint8_t strip_pages=1, uint8_t reset_gpio=64);
+        void render_pages(oled_draw_fn draw, void *context=NULL);
+
+        /// @brief Draw and send a frame strip by strip, with a function object taking the canvas, e.g. a lambda
+        template <typename F>
+        void render_pages(F draw)
         {
-            this->cursor_x = cursor_x;
-            this->cursor_y = cursor_y;
+            render_pages([](oled_canvas *canvas, void *context) { (*(F *) context)(canvas); }, &draw);
+        }
+};
+
+
+#define OLED_RENDER_GROUP_MAX 4    // Most displays a render group can manage
+
+
+class oled_render_group
+{
+    private:
+        pico_oled *displays[OLED_RENDER_GROUP_MAX];
+        uint8_t display_count;
+
+    public:
+        oled_render_group();
+        bool add(pico_oled *display);
+        void render_async();
+        void render_wait();
+        bool render_busy();
+
+        /// @brief Send the changed region of every display and wait until they have all finished
+        void render()
+        {
+            render_async();
+            render_wait();
         }
-   
-        void set_font(gfx_font new_font);
-        uint8_t get_font_height(){return font.line_height;};    // char height + 1
-        void set_brightness(uint8_t brightness);
-        void get_str_dimensions(const char *input_str, uint8_t *width, uint8_t *height);
-        void draw_char(uint8_t char_c, uint8_t x_pos, uint8_t y_pos);
-        void print(const char *print_str);
-        void print_num(const char *format_str, int32_t print_data);
-        void print_num(const char *format_str, uint32_t print_data);
-        void print_num(const char *format_str, float print_data);
-        void print_num(const char *format_str, uint16_t print_data);
-        void print_num(const char *format_str, int16_t print_data);
-        void print_num(const char *format_str, uint8_t print_data);
-        void print_num(const char *format_str, int8_t print_data);        
-        void draw_pixel(uint8_t x, uint8_t y);
-        void draw_pixel_alternating(uint8_t x, uint8_t y);
-        void draw_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
-        void draw_line_dotted(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
-        void draw_fast_hline(uint8_t x1, uint8_t x2, uint8_t y);
-        void draw_fast_vline(uint8_t y1, uint8_t y2, uint8_t x);  
-        void draw_line_polar(uint8_t origin_x, uint8_t origin_y, uint8_t magnitude, float angle);
-        void draw_vbar(uint8_t fullness, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2); 
-        void draw_hbar(uint8_t fullness, uint8_t start_right, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);   
-        void draw_bmp_vbar(uint8_t fullness, const bitmap empty_bitmap, const bitmap full_bitmap, uint8_t x, uint8_t y);
-        void fill_rect(uint8_t blank, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
-        void draw_box(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
-        void draw_boxed_text(const char *print_str, uint8_t padding, uint8_t fill_bg, uint8_t x, uint8_t y);
-
-        uint8_t pixel_counter;
 };
 
 
 class analog_gauge
 {
     private:
-        pico_oled *master_display;
+        oled_canvas *master_display;
         int16_t _origin_x;
         int16_t _origin_y;
         uint16_t _needle_len;
@@ -127,7 +245,7 @@ class analog_gauge
         float _needle_value;        
 
     public:
-        analog_gauge(pico_oled *display);
+        analog_gauge(oled_canvas *display);
         void set_scale(float scale_min, float scale_max, float scale_start_deg, float scale_end_deg);
         void set_markers(uint8_t scale_divisions, uint8_t needle_len, uint8_t marker_len, uint8_t half_divisions);
         void set_position(int16_t origin_x, int16_t origin_y);
@@ -137,3 +255,4 @@ class analog_gauge
         
 };
 
+#endif